@@ -1,6 +1,6 @@
 #pragma once
 #include <string>
-#include "ThirdParty\XMLParser\XMLParser.hpp"
+#include "ThirdParty/XMLParser/XMLParser.hpp"
 #include <map>
 #include <vector>
 #include "Game/MapGenerator.hpp"
@@ -5,7 +5,16 @@
 #include "Engine/Core/Time.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include <time.h>
+#include <stdio.h>
+#include <algorithm>
 #include "Engine/Core/ProfileLogScope.hpp"
+#include "Game/JobSystem.hpp"
+#include "Game/MapDefinition.hpp"
+#include "Game/Map.hpp"
+#include "Game/MapCache.hpp"
+#include "Game/Prefab.hpp"
+#include "Game/OverworldStreamer.hpp"
+#include "Engine/Core/StringUtils.hpp"
 
 
 bool CustomWinProc(UINT wmMessageCode, WPARAM wParam, LPARAM lParam)
@@ -65,12 +74,124 @@ bool CustomWinProc(UINT wmMessageCode, WPARAM wParam, LPARAM lParam)
 	return true;
 }
 
+//Command results go to the console log so they show up where the command was typed
+static void PrintToConsole(const std::string& text, const Rgba& color = Rgba::WHITE)
+{
+	g_theConsole->ConsolePrint(text, color);
+}
+
 bool ConsoleQuit(std::string args)
 {
 	g_theApp->SetIsQuitting(true);
 	return true;
 }
 
+//benchmarkrules <mapDefinition> [repetitions]: times interpreted against compiled rule evaluation on a freshly generated map
+bool ConsoleBenchmarkRules(std::string args)
+{
+	std::vector<std::string> splitArgs = Split(args, ' ');
+	if (splitArgs.empty() || splitArgs[0].empty())
+		return false;
+
+	MapDefinition* definition = MapDefinition::GetDefinition(splitArgs[0]);
+	if (!definition)
+		return false;
+
+	int numRepetitions = 100;
+	if (splitArgs.size() > 1)
+		numRepetitions = atoi(splitArgs[1].c_str());
+	if (numRepetitions < 1)
+		numRepetitions = 1;
+
+	Map* benchmarkMap = new Map(definition->m_name, RandomStream::HashString(definition->m_name));
+	definition->GenerateMap(benchmarkMap);
+	for (MapGenerator* generator : definition->m_generators)
+	{
+		std::string result = generator->BenchmarkRules(benchmarkMap, numRepetitions);
+		if (!result.empty())
+			PrintToConsole(result);
+	}
+	delete benchmarkMap;
+	return true;
+}
+
+bool ConsoleMapCacheStats(std::string args)
+{
+	UNUSED(args);
+	PrintToConsole(MapCache::GetStatsString());
+	return true;
+}
+
+//bakeprefab <prefabFile.xml>: writes the parsed prefab next to the source file in the binary prefab format
+bool ConsoleBakePrefab(std::string args)
+{
+	if (args.empty())
+		return false;
+
+	std::string binaryFilename = args;
+	size_t extensionStart = binaryFilename.find_last_of('.');
+	if (extensionStart != std::string::npos)
+		binaryFilename.erase(extensionStart);
+	binaryFilename += Prefab::BINARY_FILE_EXTENSION;
+
+	Prefab* prefab = Prefab::LoadFromFile(args);
+	bool wasSaved = prefab->SaveBinaryFile(binaryFilename);
+	delete prefab;
+
+	if (wasSaved)
+		PrintToConsole("Baked prefab to " + binaryFilename);
+	else
+		PrintToConsole("Failed to bake prefab to " + binaryFilename, Rgba::RED);
+	return wasSaved;
+}
+
+bool ConsoleOverworldStats(std::string args)
+{
+	UNUSED(args);
+	if (!g_theApp->m_game || !g_theApp->m_game->m_theWorld || !g_theApp->m_game->m_theWorld->m_currentMap)
+		return false;
+
+	Map* currentMap = g_theApp->m_game->m_theWorld->m_currentMap;
+	if (!currentMap->m_overworldStreamer)
+	{
+		PrintToConsole("Current map is not an overworld.", Rgba::RED);
+		return false;
+	}
+
+	OverworldStreamerStats stats = currentMap->m_overworldStreamer->GetStats();
+	char statsLine[256];
+	snprintf(statsLine, sizeof(statsLine), "Overworld at (%d, %d): %d resident chunks (%u KB, budget %d), %d pending, %d compressed (%u KB, budget %u KB), %d stashed tiles", currentMap->m_overworldOrigin.x, currentMap->m_overworldOrigin.y,
+		stats.m_numResidentChunks, (unsigned int)(stats.m_residentBytes / 1024), currentMap->m_overworldStreamer->m_maxResidentChunks, stats.m_numPendingChunks,
+		stats.m_numCompressedChunks, (unsigned int)(stats.m_compressedBytes / 1024), (unsigned int)(currentMap->m_overworldStreamer->m_maxCompressedBytes / 1024), stats.m_numStashedTiles);
+	PrintToConsole(statsLine);
+	return true;
+}
+
+//exportgentrace [file.json]: writes every generated map's generator timeline as a Chrome trace
+bool ConsoleExportGenerationTrace(std::string args)
+{
+	if (!g_theApp->m_game || !g_theApp->m_game->m_theWorld)
+		return false;
+
+	World* world = g_theApp->m_game->m_theWorld;
+	std::vector<const Map*> maps;
+	for (const Map* map : world->m_maps)
+	{
+		if (map)
+			maps.push_back(map);
+	}
+	if (world->m_currentlyGeneratingMap && std::find(maps.begin(), maps.end(), world->m_currentlyGeneratingMap) == maps.end())
+		maps.push_back(world->m_currentlyGeneratingMap);
+
+	std::string filePath = args.empty() ? "GenerationTrace.json" : args;
+	bool wasWritten = GenerationProfiler::WriteChromeTrace(filePath, maps);
+	if (wasWritten)
+		PrintToConsole("Wrote generation trace to " + filePath);
+	else
+		PrintToConsole("Failed to write generation trace to " + filePath, Rgba::RED);
+	return wasWritten;
+}
+
 App::App()
 	: m_game(nullptr)
 	, m_isQuitting(false)
@@ -83,10 +204,19 @@ App::App()
 
 	g_theConsole = new ConsoleSystem();
 	g_theConsole->RegisterCommand("quit", ConsoleQuit);
+	g_theConsole->RegisterCommand("benchmarkrules", ConsoleBenchmarkRules);
+	g_theConsole->RegisterCommand("mapcachestats", ConsoleMapCacheStats);
+	g_theConsole->RegisterCommand("bakeprefab", ConsoleBakePrefab);
+	g_theConsole->RegisterCommand("overworldstats", ConsoleOverworldStats);
+	g_theConsole->RegisterCommand("exportgentrace", ConsoleExportGenerationTrace);
 
 	g_theConfig = new ConfigSystem();
 	g_theConfig->Initialize("Roguelike.config");
 
+	std::string mapCacheDirectory;
+	g_theConfig->GetConfigString(mapCacheDirectory, "MapCacheDirectory");
+	MapCache::Initialize(mapCacheDirectory);
+
 	g_theInput = new InputSystem();
 	g_theAudio = new AudioSystem();
 
@@ -105,6 +235,8 @@ App::App()
 
 	srand((unsigned int)time(NULL));
 
+	g_theJobSystem = new JobSystem();
+
 	m_game = new Game();
 	m_game->Initialize();
 
@@ -122,6 +254,9 @@ App::~App()
 	delete m_game;
 	m_game = nullptr;
 
+	delete g_theJobSystem;
+	g_theJobSystem = nullptr;
+
 	delete g_theInput;
 	g_theInput = nullptr;
 
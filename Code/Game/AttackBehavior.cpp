@@ -1,6 +1,6 @@
 #include "Game/AttackBehavior.hpp"
 #include "Game/GameCommon.hpp"
-#include "Game/App.hpp"
+#include "Game/Map.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Core/XMLUtils.hpp"
 #include "Engine/Core/EngineConfig.hpp"
@@ -20,17 +20,16 @@ AttackBehavior::~AttackBehavior()
 
 }
 
-void AttackBehavior::Act(Character* actingCharacter)
+void AttackBehavior::Plan(Character* actingCharacter, PlannedAction& out_action)
 {
-	actingCharacter->Attack(actingCharacter->m_target);
-
-	actingCharacter->m_turnsUntilAction = 1;
+	out_action.m_type = PLANNED_ACTION_ATTACK;
+	out_action.m_target = actingCharacter->m_target;
 }
 
 
 float AttackBehavior::CalcUtility(Character* actingCharacter) const
 {
-	if (actingCharacter->m_target && actingCharacter->m_currentMap->CalculateManhattanDistance(*actingCharacter->m_currentTile, *actingCharacter->m_target->m_currentTile) <= 1)
+	if (actingCharacter->GetTarget() && actingCharacter->m_currentMap->CalculateManhattanDistance(*actingCharacter->m_currentTile, *actingCharacter->GetTarget()->m_currentTile) <= 1)
 		return m_utility;
 	return -1.f;
 }
@@ -42,8 +41,11 @@ std::string AttackBehavior::GetName() const
 
 void AttackBehavior::DebugRender(const Character* actingCharacter) const
 {
-	if(actingCharacter->m_target)
-		g_theRenderer->DrawLine2D((Vector2)actingCharacter->m_currentTile->m_tileCoords + Vector2(0.5f, 0.5f), (Vector2)actingCharacter->m_target->m_currentTile->m_tileCoords + Vector2(0.5f, 0.5f), 0.125f, Rgba::WHITE, Rgba::RED);
+	UNUSED(actingCharacter);
+#ifndef ROGUELIKE_HEADLESS
+	if(actingCharacter->GetTarget())
+		g_theRenderer->DrawLine2D((Vector2)actingCharacter->m_currentTile->m_tileCoords + Vector2(0.5f, 0.5f), (Vector2)actingCharacter->GetTarget()->m_currentTile->m_tileCoords + Vector2(0.5f, 0.5f), 0.125f, Rgba::WHITE, Rgba::RED);
+#endif
 }
 
 Behavior* AttackBehavior::Clone()
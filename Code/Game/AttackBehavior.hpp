@@ -11,7 +11,7 @@ public:
 	virtual ~AttackBehavior();
 	AttackBehavior(AttackBehavior* behaviorToCopy);
 
-	virtual void Act(Character* actingCharacter) override;
+	virtual void Plan(Character* actingCharacter, PlannedAction& out_action) override;
 	virtual float CalcUtility(Character* actingCharacter) const override;
 	virtual std::string GetName() const override;
 	virtual void DebugRender(const Character* actingCharacter) const override;
@@ -7,6 +7,7 @@
 #include "Engine/Core/EngineConfig.hpp"
 #include "Game/AttackBehavior.hpp"
 #include "Game/PatrolBehavior.hpp"
+#include "Game/Tile.hpp"
 
 
 Behavior::Behavior()
@@ -19,12 +20,32 @@ Behavior::~Behavior()
 
 }
 
+void Behavior::OnActionResolved(Character* actingCharacter, const PlannedAction& action, bool wasSuccessful)
+{
+	UNUSED(actingCharacter);
+	UNUSED(action);
+	UNUSED(wasSuccessful);
+}
+
+void Behavior::InvalidatePath()
+{
+
+}
+
 float Behavior::CalcUtility(Character* actingCharacter) const
 {
 	UNUSED(actingCharacter);
 	return 0.f;
 }
 
+void Behavior::PlanMoveToTile(Tile* destinationTile, PlannedAction& out_action)
+{
+	out_action.m_type = PLANNED_ACTION_MOVE;
+	out_action.m_destinationTile = destinationTile;
+	if (destinationTile && destinationTile->m_occupyingCharacter)
+		out_action.m_expectedOccupant = destinationTile->m_occupyingCharacter->m_handle;
+}
+
 Behavior* Behavior::Create(XMLNode element)
 {
 	std::string elementName = element.getName();
@@ -1,8 +1,29 @@
 #pragma once
-#include "ThirdParty\XMLParser\XMLParser.hpp"
+#include "ThirdParty/XMLParser/XMLParser.hpp"
+#include "Game/EntityHandle.hpp"
 #include <string>
 
 class Character;
+class Tile;
+
+enum PlannedActionType
+{
+	PLANNED_ACTION_REST,
+	PLANNED_ACTION_MOVE,			//Step onto m_destinationTile, bumping into whoever is there
+	PLANNED_ACTION_ATTACK,			//Attack m_target if it is still adjacent
+	NUM_PLANNED_ACTION_TYPES
+};
+
+//What a character decided to do this turn. Characters and tiles are remembered as they were when the decision was made, so
+//the map can tell whether the decision still holds by the time it is applied.
+struct PlannedAction
+{
+	PlannedActionType m_type = PLANNED_ACTION_REST;
+	Tile* m_destinationTile = nullptr;
+	EntityHandle m_expectedOccupant;
+	EntityHandle m_target;
+	int m_turnsUntilAction = 1;
+};
 
 class Behavior
 {
@@ -10,11 +31,22 @@ public:
 	Behavior();
 	virtual ~Behavior();
 
-	virtual void Act(Character* actingCharacter) = 0;
+	//Plan runs alongside the plans of every other character due on the same tick, possibly on another thread. It may read
+	//anything on the map but may only change the acting character and this behavior, and must draw from the character's
+	//random stream rather than the map's.
+	virtual void Plan(Character* actingCharacter, PlannedAction& out_action) = 0;
+	virtual void OnActionResolved(Character* actingCharacter, const PlannedAction& action, bool wasSuccessful);
 	virtual float CalcUtility(Character* actingCharacter) const;
 
+	//Drops any remembered path and target tiles. Called when the tiles under the character stop meaning what they did when
+	//the path was made, so the behavior plans from scratch next time instead of walking stale tiles.
+	virtual void InvalidatePath();
+
 	virtual void DebugRender(const Character* actingCharacter) const = 0;
 	virtual std::string GetName() const = 0;
 	virtual Behavior* Clone() = 0;
 	static Behavior* Create(XMLNode element);
-};
\ No newline at end of file
+
+protected:
+	static void PlanMoveToTile(Tile* destinationTile, PlannedAction& out_action);
+};
@@ -0,0 +1,119 @@
+#include "Game/BinaryBuffer.hpp"
+#include <fstream>
+#include <stdio.h>
+#include <string.h>
+
+
+void WriteBytes(std::vector<unsigned char>& out_buffer, const void* bytes, size_t numBytes)
+{
+	const unsigned char* byteArray = (const unsigned char*)bytes;
+	out_buffer.insert(out_buffer.end(), byteArray, byteArray + numBytes);
+}
+
+void WriteString(std::vector<unsigned char>& out_buffer, const std::string& stringToWrite)
+{
+	unsigned short length = (unsigned short)stringToWrite.size();
+	WriteBytes(out_buffer, &length, sizeof(length));
+	WriteBytes(out_buffer, stringToWrite.data(), length);
+}
+
+void WriteRgba(std::vector<unsigned char>& out_buffer, const Rgba& color)
+{
+	unsigned char channels[4] = { color.r, color.g, color.b, color.a };
+	WriteBytes(out_buffer, channels, sizeof(channels));
+}
+
+bool ReadFileIntoBuffer(const std::string& filePath, std::vector<unsigned char>& out_buffer)
+{
+	std::ifstream file(filePath.c_str(), std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+		return false;
+
+	std::streamsize fileSize = file.tellg();
+	if (fileSize <= 0)
+		return false;
+
+	out_buffer.resize((size_t)fileSize);
+	file.seekg(0, std::ios::beg);
+	return !!file.read((char*)&out_buffer[0], fileSize);
+}
+
+//Writes to a temporary file first so a reader never sees a half-written file
+bool WriteBufferToFile(const std::string& filePath, const std::vector<unsigned char>& buffer)
+{
+	std::string tempFilePath = filePath + ".tmp";
+	bool wasWritten;
+	{
+		std::ofstream file(tempFilePath.c_str(), std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+			return false;
+
+		if (!buffer.empty())
+			file.write((const char*)&buffer[0], buffer.size());
+		wasWritten = !file.fail();
+	}
+
+	remove(filePath.c_str());
+	if (!wasWritten || rename(tempFilePath.c_str(), filePath.c_str()) != 0)
+	{
+		remove(tempFilePath.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+unsigned long long HashBytes(unsigned long long hash, const void* bytes, size_t numBytes)
+{
+	const unsigned char* byteArray = (const unsigned char*)bytes;
+	for (size_t byteIndex = 0; byteIndex < numBytes; byteIndex++)
+	{
+		hash ^= byteArray[byteIndex];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+
+BinaryBufferReader::BinaryBufferReader(const std::vector<unsigned char>& buffer)
+	: m_buffer(buffer)
+	, m_offset(0)
+	, m_isValid(true)
+{
+}
+
+void BinaryBufferReader::ReadBytes(void* out_bytes, size_t numBytes)
+{
+	if (!m_isValid || m_offset + numBytes > m_buffer.size())
+	{
+		m_isValid = false;
+		memset(out_bytes, 0, numBytes);
+		return;
+	}
+
+	memcpy(out_bytes, &m_buffer[m_offset], numBytes);
+	m_offset += numBytes;
+}
+
+std::string BinaryBufferReader::ReadString()
+{
+	unsigned short length = 0;
+	ReadBytes(&length, sizeof(length));
+	if (!m_isValid || m_offset + length > m_buffer.size())
+	{
+		m_isValid = false;
+		return "";
+	}
+
+	std::string result((const char*)&m_buffer[m_offset], length);
+	m_offset += length;
+	return result;
+}
+
+Rgba BinaryBufferReader::ReadRgba()
+{
+	unsigned char channels[4];
+	ReadBytes(channels, sizeof(channels));
+	return Rgba(channels[0], channels[1], channels[2], channels[3]);
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Engine/Core/Rgba.hpp"
+
+
+void WriteBytes(std::vector<unsigned char>& out_buffer, const void* bytes, size_t numBytes);
+void WriteString(std::vector<unsigned char>& out_buffer, const std::string& stringToWrite);
+void WriteRgba(std::vector<unsigned char>& out_buffer, const Rgba& color);
+bool ReadFileIntoBuffer(const std::string& filePath, std::vector<unsigned char>& out_buffer);
+bool WriteBufferToFile(const std::string& filePath, const std::vector<unsigned char>& buffer);
+
+//64-bit FNV-1a, for content keys and state checksums rather than anything security related
+const unsigned long long HASH_BYTES_START = 14695981039346656037ULL;
+unsigned long long HashBytes(unsigned long long hash, const void* bytes, size_t numBytes);
+
+//Bounds-checked reads over a loaded binary file. Any read past the end marks the whole buffer as bad.
+class BinaryBufferReader
+{
+public:
+	BinaryBufferReader(const std::vector<unsigned char>& buffer);
+
+	void ReadBytes(void* out_bytes, size_t numBytes);
+	std::string ReadString();
+	Rgba ReadRgba();
+	bool IsValid() const { return m_isValid; }
+	size_t GetNumBytesRemaining() const { return m_isValid ? m_buffer.size() - m_offset : 0; }
+
+private:
+	const std::vector<unsigned char>& m_buffer;
+	size_t m_offset;
+	bool m_isValid;
+};
@@ -3,13 +3,17 @@
 #include "Engine/Core/EngineConfig.hpp"
 #include "Game/Map.hpp"
 #include "Game/GameCommon.hpp"
-#include "Game/App.hpp"
+#include "Game/World.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 
 Character::Character()
 	: Entity()
 	, m_turnsUntilAction(1)
+	, m_actionSpeed(NORMAL_ACTION_SPEED)
+	, m_isDormant(false)
 	, m_currentBehavior(nullptr)
+	, m_plannedAction()
+	, m_random()
 	, m_behaviors()
 	, m_currentHP(0)
 	, m_faction()
@@ -26,20 +30,10 @@ Character::~Character()
 
 }
 
-void Character::Update(float deltaSeconds)
+void Character::PlanAction()
 {
-	UNUSED(deltaSeconds);
-	if (m_turnsUntilAction <= 0)
-		Act();
-}
-
-void Character::AdvanceTurn()
-{
-	--m_turnsUntilAction;
-}
+	m_plannedAction = PlannedAction();
 
-void Character::Act()
-{
 	float maxUtility = -1.f;
 	for (size_t behaviorIndex = 0; behaviorIndex < m_behaviors.size(); behaviorIndex++)
 	{
@@ -51,7 +45,29 @@ void Character::Act()
 		}
 	}
 
-	m_currentBehavior->Act(this);
+	m_currentBehavior->Plan(this, m_plannedAction);
+}
+
+void Character::ApplyPlannedAction()
+{
+	bool wasSuccessful = m_currentMap->ResolvePlannedAction(this, m_plannedAction);
+	m_currentBehavior->OnActionResolved(this, m_plannedAction, wasSuccessful);
+	m_turnsUntilAction = m_plannedAction.m_turnsUntilAction;
+}
+
+void Character::InvalidateBehaviorPaths()
+{
+	for (Behavior* behavior : m_behaviors)
+	{
+		behavior->InvalidatePath();
+	}
+}
+
+int Character::CalculateActionTicks() const
+{
+	int actionSpeed = m_actionSpeed > 0 ? m_actionSpeed : 1;
+	int actionTicks = (m_turnsUntilAction * TICKS_PER_TURN * NORMAL_ACTION_SPEED) / actionSpeed;
+	return actionTicks > 0 ? actionTicks : 1;
 }
 
 void Character::Rest()
@@ -79,7 +95,7 @@ void Character::MoveWest()
 	m_currentMap->TryToMoveCharacterToTile(this, m_currentTile->GetWestNeighbor());
 }
 
-void Character::Attack(Character* attackedCharacter)
+void Character::Attack(Character* attackedCharacter, RandomStream& random)
 {
 	if (m_faction == attackedCharacter->m_faction)
 		return;
@@ -89,7 +105,7 @@ void Character::Attack(Character* attackedCharacter)
 
 	//Determine if hit
 	float chanceToHit = BASE_CHANCE_TO_HIT + ((modifiedAttackerStats[STAT_AGILITY] - modifiedDefenderStats[STAT_AGILITY]) * CHANCE_TO_HIT_PER_AGILITY);
-	if (GetRandomFloatZeroToOne() > chanceToHit)
+	if (random.GetRandomFloatZeroToOne() > chanceToHit)
 		return;					//Miss, no damage done
 
 	//Calculate base damage dealt
@@ -97,7 +113,7 @@ void Character::Attack(Character* attackedCharacter)
 
 	//Determine critical
 	float criticalChance = BASE_CRITICAL_CHANCE + ((modifiedAttackerStats[STAT_LUCK] - modifiedDefenderStats[STAT_LUCK]) * CRITICAL_CHANCE_PER_LUCK);
-	if (GetRandomFloatZeroToOne() <= criticalChance)
+	if (random.GetRandomFloatZeroToOne() <= criticalChance)
 		damageToDeal = (int)floor(CRITICAL_MULTIPLIER * damageToDeal);
 
 	Tags damageTypes;
@@ -158,13 +174,29 @@ void Character::UpdateVisibleActors()
 			RaycastResult result = m_currentMap->RaycastForOpaque(Vector2(m_currentTile->m_tileCoords) + Vector2(0.5f, 0.5f), displacementToPotentialTarget.GetNormalized(), displacementToPotentialTarget.CalcLength());
 			if (!result.m_didImpact)
 			{
-				m_visibleCharacters.insert(otherCharacter);
-				otherCharacter->m_visibleCharacters.insert(this);
+				m_visibleCharacters.insert(otherCharacter->m_handle);
+				otherCharacter->m_visibleCharacters.insert(m_handle);
 			}
 		}
 	}
 }
 
+Character* Character::GetTarget() const
+{
+	if (!m_currentMap)
+		return nullptr;
+
+	return m_currentMap->GetCharacter(m_target);
+}
+
+void Character::SetTarget(Character* newTarget)
+{
+	if (newTarget)
+		m_target = newTarget->m_handle;
+	else
+		m_target = EntityHandle();
+}
+
 std::vector<Message> Character::GetTooltipInfo() const
 {
 	std::vector<Message> outputInfo;
@@ -262,11 +294,17 @@ void Character::ApplyDamage(int damageToDeal, const Tags& damageTypes)
 	damageToDeal = (int)floor((float)damageToDeal * damageModifier);
 
 	m_currentHP -= damageToDeal;
+#ifndef ROGUELIKE_HEADLESS
 	m_currentMap->m_damageNumbers.push_back(DamageNumber(std::to_string(damageToDeal), Vector2(m_currentTile->m_tileCoords) + Vector2(0.5f, 0.75f), Rgba::RED, ClampFloat(damageModifier * 0.5f, 0.4f, 1.25f)));
+#endif
+	//Getting hurt wakes a sleeping character however far it is from the player
+	if (m_isDormant && m_currentHP > 0)
+		m_currentMap->WakeCharacter(this);
+
 	if (m_currentHP <= 0)
 	{
-		if (g_theApp->m_game->m_theWorld->m_thePlayer == this)
-			g_theApp->m_game->m_theWorld->m_thePlayer = nullptr;
+		if (m_currentMap->GetPlayer() == this)
+			m_currentMap->m_world->m_thePlayer = nullptr;
 
 		m_currentMap->DestroyCharacter(this);
 	}
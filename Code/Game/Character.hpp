@@ -2,6 +2,7 @@
 #include "Game/Entity.hpp"
 #include "Game/Stats.hpp"
 #include "Game/Behavior.hpp"
+#include "Game/RandomStream.hpp"
 #include <set>
 #include "Engine/Gameplay/Tags.hpp"
 
@@ -53,9 +54,9 @@ public:
 	Character();
 	~Character();
 
-	virtual void Update(float deltaSeconds);
-	virtual void AdvanceTurn();
-	virtual void Act();
+	void PlanAction();
+	void ApplyPlannedAction();
+	int CalculateActionTicks() const;
 
 	virtual std::vector<Message> GetTooltipInfo() const override;
 	float GetGCostBias(std::string tileType) const;
@@ -67,14 +68,21 @@ public:
 	void MoveWest();
 
 	void ApplyDamage(int damageToDeal, const Tags& damageTypesString);
-	void Attack(Character* attackedCharacter);
+	void Attack(Character* attackedCharacter, RandomStream& random);
 
 	void PickupItemsInCurrentTile();
+	void InvalidateBehaviorPaths();
 
 	std::set<Tile*> GetVisibleTiles();
 	void UpdateVisibleActors();
 
+	Character* GetTarget() const;
+	void SetTarget(Character* newTarget);
+
+	//Set by whatever the character last did; the map turns it into the tick of the character's next action
 	int m_turnsUntilAction;
+	int m_actionSpeed;
+	bool m_isDormant;
 
 	Equipment m_equipment;
 
@@ -83,12 +91,16 @@ public:
 	Stats m_stats;
 	std::vector<Behavior*> m_behaviors;
 	Behavior* m_currentBehavior;
+	PlannedAction m_plannedAction;
+
+	//Drawn from only while planning, so characters planning in parallel never share a stream
+	RandomStream m_random;
 	std::map<std::string, float> m_gCostBiases;
 	Tags m_tags;
 	std::vector<std::string> m_damageTypeWeaknesses;
 	std::vector<std::string> m_damageTypeResistances;
 	std::vector<std::string> m_damageTypeImmunities;
 
-	std::set<Character*> m_visibleCharacters;
-	Character* m_target = nullptr;
+	std::set<EntityHandle> m_visibleCharacters;
+	EntityHandle m_target;
 };
@@ -3,6 +3,7 @@
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "LootTable.hpp"
 #include "Engine/Core/StringUtils.hpp"
+#include "Game/GameCommon.hpp"
 
 std::map<std::string, CharacterBuilder*> CharacterBuilder::s_registry;
 
@@ -48,6 +49,10 @@ CharacterBuilder::CharacterBuilder(XMLNode element)
 	m_faction = ParseXMLAttributeString(element, "faction", "ERROR_INVALID_FACTION");
 	ASSERT_OR_DIE(m_faction != "ERROR_INVALID_FACTION", "No faction found for Character element.");
 
+	//100 acts once per player turn, 200 twice, 50 every other turn
+	m_actionSpeed = ParseXMLAttributeInt(element, "speed", NORMAL_ACTION_SPEED);
+	ASSERT_OR_DIE(m_actionSpeed > 0, "Character speed must be positive.");
+
 	for (int lootIndex = 0; lootIndex < element.nChildNode("Loot"); lootIndex++)
 	{
 		XMLNode lootNode = element.getChildNode("Loot", lootIndex);
@@ -99,7 +104,7 @@ CharacterBuilder::CharacterBuilder(XMLNode element)
 	s_registry[m_name] = this;
 }
 
-Character* CharacterBuilder::BuildNewCharacter(std::string characterTypeName)
+Character* CharacterBuilder::BuildNewCharacter(std::string characterTypeName, RandomStream& random)
 {
 	std::map<std::string, CharacterBuilder*>::iterator found = s_registry.find(characterTypeName);
 	if (found == s_registry.end())
@@ -114,9 +119,11 @@ Character* CharacterBuilder::BuildNewCharacter(std::string characterTypeName)
 	newCharacter->m_fillColor = foundBuilder->m_fillColor;
 
 	newCharacter->m_faction = foundBuilder->m_faction;
-	newCharacter->m_stats = Stats::CalculateRandomStatsInRange(foundBuilder->m_minStats, foundBuilder->m_maxStats);
+	newCharacter->m_actionSpeed = foundBuilder->m_actionSpeed;
+	newCharacter->m_stats = Stats::CalculateRandomStatsInRange(foundBuilder->m_minStats, foundBuilder->m_maxStats, random);
 	newCharacter->m_behaviors = CloneBehaviors(foundBuilder->m_behaviors);
 	newCharacter->m_currentHP = newCharacter->m_stats[STAT_MAX_HP];
+	newCharacter->m_random.SetSeed(random.GetRandomUnsignedInt());
 	newCharacter->m_gCostBiases = foundBuilder->m_gCostBiases;
 	newCharacter->m_tags.SetTags(foundBuilder->m_tagsToSet);
 	newCharacter->m_damageTypeWeaknesses = foundBuilder->m_damageTypeWeaknesses;
@@ -125,8 +132,8 @@ Character* CharacterBuilder::BuildNewCharacter(std::string characterTypeName)
 
 	for (size_t lootIndex = 0; lootIndex < foundBuilder->m_loot.size(); lootIndex++)
 	{
-		std::string itemFromTable = LootTable::GetLootTable(foundBuilder->m_loot[lootIndex])->m_possibleItems.GetWeightedRandomItem();
-		Item* newItem = new Item(itemFromTable);
+		std::string itemFromTable = LootTable::GetLootTable(foundBuilder->m_loot[lootIndex])->GetRandomItem(random);
+		Item* newItem = new Item(itemFromTable, random);
 		newCharacter->m_entityInventory.AddItem(newItem);
 		if (newItem->m_definition->m_slot != EQUIP_SLOT_NONE)
 		{
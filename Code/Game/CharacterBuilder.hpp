@@ -10,13 +10,14 @@ class CharacterBuilder
 public:
 	CharacterBuilder(XMLNode element);
 
-	static Character* BuildNewCharacter(std::string characterTypeName);
+	static Character* BuildNewCharacter(std::string characterTypeName, RandomStream& random);
 
 public:
 	std::string m_name;
 	Stats m_minStats;
 	Stats m_maxStats;
 	std::string m_faction;
+	int m_actionSpeed;
 
 	char m_glyph;
 	Rgba m_glyphColor;
@@ -5,6 +5,7 @@
 Entity::Entity()
 	: m_currentMap(nullptr)
 	, m_currentTile(nullptr)
+	, m_handle()
 	, m_entityInventory()
 	, m_fillColor(Rgba(0, 0, 0, 0))
 	, m_glyph(' ')
@@ -19,16 +20,6 @@ Entity::~Entity()
 
 }
 
-void Entity::Update(float deltaSeconds)
-{
-	UNUSED(deltaSeconds);
-}
-
-void Entity::AdvanceTurn()
-{
-
-}
-
 void Entity::Render() const
 {
 
@@ -4,6 +4,7 @@
 #include "Engine/Core/Rgba.hpp"
 #include "Game/Inventory.hpp"
 #include "Game/Message.hpp"
+#include "Game/EntityHandle.hpp"
 
 class Map;
 class Tile;
@@ -14,8 +15,6 @@ public:
 	Entity();
 	virtual ~Entity();
 	
-	virtual void Update(float deltaSeconds);
-	virtual void AdvanceTurn();
 	virtual void Render() const;
 
 	virtual std::vector<Message> GetTooltipInfo() const = 0;
@@ -25,6 +24,7 @@ public:
 	Inventory m_entityInventory;
 	Map* m_currentMap;
 	Tile* m_currentTile;
+	EntityHandle m_handle;
 
 	char m_glyph;
 	Rgba m_glyphColor;
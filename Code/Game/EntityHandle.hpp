@@ -0,0 +1,22 @@
+#pragma once
+
+
+//Refers to an entity slot in a Map. The generation is bumped every time a slot is freed, so handles to destroyed entities resolve to nullptr.
+struct EntityHandle
+{
+	EntityHandle()
+		: m_index(INVALID_INDEX), m_generation(0) {}
+	EntityHandle(unsigned int index, unsigned int generation)
+		: m_index(index), m_generation(generation) {}
+
+	bool IsValid() const { return m_index != INVALID_INDEX; }
+
+	bool operator==(const EntityHandle& other) const { return m_index == other.m_index && m_generation == other.m_generation; }
+	bool operator!=(const EntityHandle& other) const { return !(*this == other); }
+	bool operator<(const EntityHandle& other) const { return m_index < other.m_index || (m_index == other.m_index && m_generation < other.m_generation); }
+
+	static const unsigned int INVALID_INDEX = 0xffffffff;
+
+	unsigned int m_index;
+	unsigned int m_generation;
+};
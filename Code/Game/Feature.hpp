@@ -13,6 +13,10 @@ struct ExitData
 	ExitDirection m_direction;
 	bool m_isTwoWay;
 	Tile* m_destinationTile;
+
+	//Set for adventure exits whose destination tile is picked the first time the exit is used
+	std::string m_destinationMapName;
+	std::string m_featureTypeToPlace;
 };
 
 class Feature : public Entity
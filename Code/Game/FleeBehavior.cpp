@@ -4,7 +4,8 @@
 #include "Game/Character.hpp"
 #include <vector>
 #include "Engine/Math/MathUtils.hpp"
-#include "Game/App.hpp"
+#include "Game/Map.hpp"
+#include "Game/GameCommon.hpp"
 #include "Engine/Core/XMLUtils.hpp"
 #include "Engine/Core/EngineConfig.hpp"
 
@@ -25,11 +26,11 @@ FleeBehavior::~FleeBehavior()
 
 }
 
-void FleeBehavior::Act(Character* actingCharacter)
+void FleeBehavior::Plan(Character* actingCharacter, PlannedAction& out_action)
 {
-	if(actingCharacter->m_target)
+	if(actingCharacter->GetTarget())
 	{
-// 		Vector2 displacementToTarget = actingCharacter->m_target->m_currentTile->m_tileCoords - actingCharacter->m_currentTile->m_tileCoords;
+// 		Vector2 displacementToTarget = actingCharacter->GetTarget()->m_currentTile->m_tileCoords - actingCharacter->m_currentTile->m_tileCoords;
 // 		Vector2 directionAwayFromTarget = displacementToTarget.GetNormalized() * -1.f;
 // 
 // 		std::vector<IntVector2> potentialTiles;
@@ -56,8 +57,11 @@ void FleeBehavior::Act(Character* actingCharacter)
 			int nextTileDist = 0;
 			for (int tileIndex = 0; tileIndex < 10; tileIndex++)
 			{
-				Tile* tempTile = actingCharacter->m_currentMap->GetRandomTraversableTile();
-				int tileDist = actingCharacter->m_currentMap->CalculateManhattanDistance(*tempTile, *actingCharacter->m_target->m_currentTile);
+				Tile* tempTile = actingCharacter->m_currentMap->GetRandomTraversableTile(actingCharacter->m_tags, actingCharacter->m_random);
+				if (!tempTile)
+					break;
+
+				int tileDist = actingCharacter->m_currentMap->CalculateManhattanDistance(*tempTile, *actingCharacter->GetTarget()->m_currentTile);
 
 				if (tileDist > nextTileDist)
 				{
@@ -66,21 +70,30 @@ void FleeBehavior::Act(Character* actingCharacter)
 				}
 			}
 
-			m_fleePath = actingCharacter->m_currentMap->GeneratePath(actingCharacter->m_currentTile->m_tileCoords, nextTile->m_tileCoords, actingCharacter);
+			if (nextTile)
+				m_fleePath = actingCharacter->m_currentMap->GeneratePath(actingCharacter->m_currentTile->m_tileCoords, nextTile->m_tileCoords, actingCharacter);
 		}
 		
 	}
-	Tile* nextTile = *(m_fleePath.end() - 1);
-	bool successfullyMoved = actingCharacter->m_currentMap->TryToMoveCharacterToTile(actingCharacter, nextTile);
-	if (successfullyMoved)
+	if (!m_fleePath.empty())
+		PlanMoveToTile(*(m_fleePath.end() - 1), out_action);
+}
+
+void FleeBehavior::OnActionResolved(Character* actingCharacter, const PlannedAction& action, bool wasSuccessful)
+{
+	UNUSED(actingCharacter);
+	if (wasSuccessful && action.m_type == PLANNED_ACTION_MOVE && !m_fleePath.empty())
 		m_fleePath.pop_back();
+}
 
-	actingCharacter->m_turnsUntilAction = 1;
+void FleeBehavior::InvalidatePath()
+{
+	m_fleePath.clear();
 }
 
 float FleeBehavior::CalcUtility(Character* actingCharacter) const
 {
-	if(actingCharacter->m_target)
+	if(actingCharacter->GetTarget())
 	{
 		float healthPercent = (float)actingCharacter->m_currentHP / (float)actingCharacter->m_stats[STAT_MAX_HP];
 		float utility = RangeMapFloat(healthPercent, 0.f, 1.f, m_cowardice, 0.f);
@@ -96,13 +109,16 @@ std::string FleeBehavior::GetName() const
 
 void FleeBehavior::DebugRender(const Character* actingCharacter) const 
 {
-	if(actingCharacter->m_target)
-		g_theRenderer->DrawLine2D((Vector2)actingCharacter->m_currentTile->m_tileCoords + Vector2(0.5f, 0.5f), (Vector2)actingCharacter->m_target->m_currentTile->m_tileCoords + Vector2(0.5f, 0.5f), 0.125f, Rgba::WHITE, Rgba::RED);
+	UNUSED(actingCharacter);
+#ifndef ROGUELIKE_HEADLESS
+	if(actingCharacter->GetTarget())
+		g_theRenderer->DrawLine2D((Vector2)actingCharacter->m_currentTile->m_tileCoords + Vector2(0.5f, 0.5f), (Vector2)actingCharacter->GetTarget()->m_currentTile->m_tileCoords + Vector2(0.5f, 0.5f), 0.125f, Rgba::WHITE, Rgba::RED);
 
 	for (Tile* tile : m_fleePath)
 	{
 		g_theRenderer->DrawCenteredText2D((Vector2)tile->m_tileCoords + Vector2(0.5f, 0.5f), g_theRenderer->m_defaultFont, "p", Rgba::BLUE, 0.5f);
 	}
+#endif
 }
 
 Behavior* FleeBehavior::Clone()
@@ -12,9 +12,13 @@
 #include "Engine/Core/XMLUtils.hpp"
 #include "Game/App.hpp"
 #include "Game/MapDefinition.hpp"
+#include "Game/GameplayDefinitions.hpp"
 #include "CharacterBuilder.hpp"
 #include "LootTable.hpp"
 #include "Adventure.hpp"
+#include "Game/SessionRecording.hpp"
+#include <algorithm>
+#include <time.h>
 
 
 Game::Game()
@@ -26,20 +30,13 @@ Game::Game()
 
 Game::~Game()
 {
-
+	SaveSessionRecording();
 }
 
 
 void Game::Initialize()
 {
-	LoadGameConstants();
-	LoadLootTables();
-	LoadTileDefinitions();
-	LoadCharacterBuilders();
-	LoadItemDefinitions();
-	LoadFeaturePrototypes();
-	LoadMapDefinitions();
-	LoadAdventures();
+	GameplayDefinitions::LoadAll();
 }
 
 void Game::Update(float deltaSeconds)
@@ -61,6 +58,9 @@ void Game::Update(float deltaSeconds)
 	case STATE_PATHING:
 		UpdatePathing(deltaSeconds);
 		break;
+	case STATE_LOADING:
+		UpdateLoading(deltaSeconds);
+		break;
 	}
 }
 
@@ -83,6 +83,9 @@ void Game::Render() const
 	case STATE_PATHING:
 		RenderPathing();
 		break;
+	case STATE_LOADING:
+		RenderLoading();
+		break;
 	}
 }
 
@@ -96,20 +99,20 @@ void Game::UpdateMainMenu(float deltaSeconds)
 	else if (g_theInput->WasKeyJustPressed('2'))
 	{
 		StartAdventure("Test");
-		m_currentState = STATE_PLAYING;
+		m_currentState = STATE_LOADING;
 	}
 	else if (g_theInput->WasKeyJustPressed('3'))
 	{
 		if (m_theWorld == nullptr)
 		{
-			m_theWorld = new World();
+			m_theWorld = new World(GetWorldSeed());
 			m_theWorld->Initialize();
 		}
 
 		Map* newMap = m_theWorld->GenerateMap("Rooms");
 		m_theWorld->m_currentMap = newMap;
 		m_theWorld->m_maps[0] = newMap;
-		m_theWorld->m_thePlayer = CharacterBuilder::BuildNewCharacter("player");
+		m_theWorld->m_thePlayer = CharacterBuilder::BuildNewCharacter("player", m_theWorld->m_currentMap->m_random);
 		m_theWorld->m_currentMap->PlaceCharacterInMap(m_theWorld->m_thePlayer, m_theWorld->m_currentMap->GetRandomTraversableTile());
 		m_currentState = STATE_PLAYING;
 	}
@@ -117,14 +120,14 @@ void Game::UpdateMainMenu(float deltaSeconds)
 	{
 		if (m_theWorld == nullptr)
 		{
-			m_theWorld = new World();
+			m_theWorld = new World(GetWorldSeed());
 			m_theWorld->Initialize();
 		}
 
 		m_theWorld->StartSteppedGeneration("CATest");
 		m_theWorld->m_currentMap = m_theWorld->m_currentlyGeneratingMap;
 		m_theWorld->m_maps[0] = m_theWorld->m_currentlyGeneratingMap;
-		m_theWorld->m_thePlayer = CharacterBuilder::BuildNewCharacter("player");
+		m_theWorld->m_thePlayer = CharacterBuilder::BuildNewCharacter("player", m_theWorld->m_currentMap->m_random);
 		m_theWorld->m_currentMap->PlaceCharacterInMap(m_theWorld->m_thePlayer, m_theWorld->m_currentMap->GetRandomTraversableTile());
 		m_currentState = STATE_GENERATING;
 	}
@@ -132,14 +135,14 @@ void Game::UpdateMainMenu(float deltaSeconds)
 	{
 		if (m_theWorld == nullptr)
 		{
-			m_theWorld = new World();
+			m_theWorld = new World(GetWorldSeed());
 			m_theWorld->Initialize();
 		}
 
 		m_theWorld->StartSteppedGeneration("PerlinTest");
 		m_theWorld->m_currentMap = m_theWorld->m_currentlyGeneratingMap;
 		m_theWorld->m_maps[0] = m_theWorld->m_currentlyGeneratingMap;
-		m_theWorld->m_thePlayer = CharacterBuilder::BuildNewCharacter("player");
+		m_theWorld->m_thePlayer = CharacterBuilder::BuildNewCharacter("player", m_theWorld->m_currentMap->m_random);
 		m_theWorld->m_currentMap->PlaceCharacterInMap(m_theWorld->m_thePlayer, m_theWorld->m_currentMap->GetRandomTraversableTile());
 		m_currentState = STATE_GENERATING;
 	}
@@ -152,7 +155,10 @@ void Game::UpdateMainMenu(float deltaSeconds)
 void Game::UpdatePlaying(float deltaSeconds)
 {
 	if (g_theInput->WasKeyJustPressed(KEYCODE_ESCAPE))
+	{
+		SaveSessionRecording();
 		m_currentState = STATE_MAINMENU;
+	}
 
 	if (g_theInput->WasKeyJustPressed('C'))
 		m_currentState = STATE_STATSSCREEN;
@@ -210,14 +216,9 @@ void Game::UpdateStatsScreen(float deltaSeconds)
 			Item* clickedItem = GetItemFromMouseClick(m_theWorld->m_cursorPosition);
 			if (clickedItem)
 			{
-				if (m_theWorld->m_thePlayer->m_equipment.IsItemEquipped(clickedItem))
-				{
-					m_theWorld->m_thePlayer->m_equipment.m_equippedItems[clickedItem->m_definition->m_slot] = nullptr;
-				}
-				else
-				{
-					m_theWorld->m_thePlayer->m_equipment.m_equippedItems[clickedItem->m_definition->m_slot] = clickedItem;
-				}
+				const std::vector<Item*>& playerItems = m_theWorld->m_thePlayer->m_entityInventory.m_items;
+				int clickedItemIndex = (int)(std::find(playerItems.begin(), playerItems.end(), clickedItem) - playerItems.begin());
+				m_theWorld->ExecuteInventoryCommand(INVENTORY_COMMAND_TOGGLE_EQUIPPED, clickedItemIndex);
 			}
 		}
 
@@ -253,13 +254,7 @@ void Game::UpdateStatsScreen(float deltaSeconds)
 		{
 			int clickedItemIndex = GetItemIndexFromMouseClick(m_theWorld->m_cursorPosition);
 			if (clickedItemIndex >= 0)
-			{
-				Item* clickedItem = m_theWorld->m_thePlayer->m_entityInventory.m_items[clickedItemIndex];
-				if (m_theWorld->m_thePlayer->m_equipment.IsItemEquipped(clickedItem))
-					m_theWorld->m_thePlayer->m_equipment.m_equippedItems[clickedItem->m_definition->m_slot] = nullptr;
-
-				m_theWorld->m_thePlayer->m_entityInventory.TransferSingleItemToOtherInventory(clickedItemIndex, m_theWorld->m_thePlayer->m_currentTile->m_tileInventory);
-			}
+				m_theWorld->ExecuteInventoryCommand(INVENTORY_COMMAND_DROP, clickedItemIndex);
 		}
 
 		break;
@@ -315,6 +310,17 @@ void Game::UpdatePathing(float deltaSeconds)
 	m_theWorld->Update(deltaSeconds);
 }
 
+void Game::UpdateLoading(float deltaSeconds)
+{
+	UNUSED(deltaSeconds);
+
+	if (m_theWorld->IsStartingMapGenerated())
+	{
+		m_theWorld->FinishGeneratingAdventure();
+		m_currentState = STATE_PLAYING;
+	}
+}
+
 void Game::RenderMainMenu() const
 {
 	g_theRenderer->SetTexture(nullptr);
@@ -365,6 +371,7 @@ void Game::RenderGenerating() const
 		m_theWorld->Render();
 		m_theWorld->m_currentlyGeneratingMap->RenderDebugGenerating();
 		m_theWorld->DrawUI();
+		DrawGenerationTimeline();
 		m_theWorld->DrawCursor();
 	}
 }
@@ -382,117 +389,23 @@ void Game::RenderPathing() const
 	}
 }
 
-void Game::LoadTileDefinitions()
-{
-	std::string tileDefinitionFileName = "Data/Gameplay/Tiles.xml";
-	g_theConfig->GetConfigString(tileDefinitionFileName, "TileDefinitionFileName");
-
-	XMLNode tileDefinitionsHead = XMLNode::parseFile(tileDefinitionFileName.c_str(), "TileDefinitions");
-	for (int tileDefIndex = 0; tileDefIndex < tileDefinitionsHead.nChildNode("TileDefinition"); tileDefIndex++)
-	{
-		XMLNode tileDef = tileDefinitionsHead.getChildNode("TileDefinition", tileDefIndex);
-		new TileDefinition(tileDef);
-	}
-}
-
-void Game::LoadMapDefinitions()
-{
-	std::string mapFileName = "Data/Gameplay/Maps.xml";
-
-	XMLNode mapsHead = XMLNode::parseFile(mapFileName.c_str(), "MapDefinitions");
-	for (int mapsIndex = 0; mapsIndex < mapsHead.nChildNode("MapDefinition"); mapsIndex++)
-	{
-		XMLNode mapDefinition = mapsHead.getChildNode("MapDefinition", mapsIndex);
-		new MapDefinition(mapDefinition);
-	}
-}
-
-void Game::LoadAdventures()
-{
-	std::string adventuresFileName = "Data/Gameplay/Adventures.xml";
-	g_theConfig->GetConfigString(adventuresFileName, "AdventuresFileName");
-
-	XMLNode adventuresHead = XMLNode::parseFile(adventuresFileName.c_str(), "Adventures");
-	for (int adventuresIndex = 0; adventuresIndex < adventuresHead.nChildNode("Adventure"); adventuresIndex++)
-	{
-		XMLNode adventureNode = adventuresHead.getChildNode("Adventure", adventuresIndex);
-		new Adventure(adventureNode);
-	}
-}
-
-void Game::LoadCharacterBuilders()
-{
-	std::string charactersFileName = "Data/Gameplay/Characters.xml";
-	g_theConfig->GetConfigString(charactersFileName, "CharactersFileName");
-
-	XMLNode charactersHead = XMLNode::parseFile(charactersFileName.c_str(), "Characters");
-	for (int characterIndex = 0; characterIndex < charactersHead.nChildNode("Character"); characterIndex++)
-	{
-		XMLNode characterBuilder = charactersHead.getChildNode("Character", characterIndex);
-		new CharacterBuilder(characterBuilder);
-	}
-}
-
-void Game::LoadItemDefinitions()
-{
-	std::string itemsFileName = "Data/Gameplay/Items.xml";
-	g_theConfig->GetConfigString(itemsFileName, "ItemsFileName");
-
-	XMLNode itemsHead = XMLNode::parseFile(itemsFileName.c_str(), "ItemDefinitions");
-	for (int itemIndex = 0; itemIndex < itemsHead.nChildNode("ItemDefinition"); itemIndex++)
-	{
-		XMLNode itemDefinition = itemsHead.getChildNode("ItemDefinition", itemIndex);
-		new ItemDefinition(itemDefinition);
-	}
-}
-
-void Game::LoadFeaturePrototypes()
-{
-	std::string featuresFileName = "Data/Gameplay/Features.xml";
-	g_theConfig->GetConfigString(featuresFileName, "FeaturesFileName");
-
-	XMLNode featuresHead = XMLNode::parseFile(featuresFileName.c_str(), "Features");
-	for (int featureIndex = 0; featureIndex < featuresHead.nChildNode("Feature"); featureIndex++)
-	{
-		XMLNode feature = featuresHead.getChildNode("Feature", featureIndex);
-		new Feature(feature);
-	}
-}
-
-void Game::LoadLootTables()
+void Game::RenderLoading() const
 {
-	std::string lootFileName = "Data/Gameplay/Loot.xml";
-	g_theConfig->GetConfigString(lootFileName, "LootFileName");
-
-	XMLNode lootHead = XMLNode::parseFile(lootFileName.c_str(), "LootTables");
-	for (int lootIndex = 0; lootIndex < lootHead.nChildNode("LootTable"); lootIndex++)
-	{
-		XMLNode loot = lootHead.getChildNode("LootTable", lootIndex);
-		new LootTable(loot);
-	}
-}
-
-void Game::LoadGameConstants()
-{
-	std::string constantsFileName = "Data/Gameplay/GameConstants.xml";
-	g_theConfig->GetConfigString(constantsFileName, "ConstantsFileName");
-
-	XMLNode constantsHead = XMLNode::parseFile(constantsFileName.c_str(), "Constants");
-
-	XMLNode baseChanceToHitNode = constantsHead.getChildNode("BaseChanceToHit");
-	BASE_CHANCE_TO_HIT = ParseXMLAttributeFloat(baseChanceToHitNode, "chance", 0.f);
-
-	XMLNode chanceToHitPerAgilityNode = constantsHead.getChildNode("ChanceToHitPerAgility");
-	CHANCE_TO_HIT_PER_AGILITY = ParseXMLAttributeFloat(chanceToHitPerAgilityNode, "chance", 0.f);
-
-	XMLNode baseCriticalChanceNode = constantsHead.getChildNode("BaseCriticalChance");
-	BASE_CRITICAL_CHANCE = ParseXMLAttributeFloat(baseCriticalChanceNode, "chance", 0.f);
-
-	XMLNode criticalChancePerLuckNode = constantsHead.getChildNode("CriticalChancePerLuck");
-	CRITICAL_CHANCE_PER_LUCK = ParseXMLAttributeFloat(criticalChancePerLuckNode, "chance", 0.f);
+	g_theRenderer->SetTexture(nullptr);
+	g_theRenderer->ClearColor(Rgba::BLACK);
 
-	XMLNode criticalMultiplierNode = constantsHead.getChildNode("CriticalMultiplier");
-	CRITICAL_MULTIPLIER = ParseXMLAttributeFloat(criticalMultiplierNode, "multiplier", 1.f);
+	int numMapsGenerated = m_theWorld->GetNumAdventureMapsGenerated();
+	int numMapsToGenerate = m_theWorld->GetNumAdventureMapsToGenerate();
+	float fractionGenerated = 1.f;
+	if (numMapsToGenerate > 0)
+		fractionGenerated = (float)numMapsGenerated / (float)numMapsToGenerate;
+
+	Vector2 barMins(ORTHO_X_DIMENSION * 0.25f, (ORTHO_Y_DIMENSION * 0.5f) - 0.5f);
+	Vector2 barMaxs(ORTHO_X_DIMENSION * 0.75f, (ORTHO_Y_DIMENSION * 0.5f) + 0.5f);
+	g_theRenderer->DrawCenteredText2D(Vector2(ORTHO_X_DIMENSION * 0.5f, barMaxs.y + 1.5f), g_theRenderer->m_defaultFont, "Generating " + m_theWorld->m_currentAdventure->m_title, Rgba::WHITE, 1.f);
+	g_theRenderer->DrawQuad2D(barMins.x, barMins.y, barMaxs.x, barMaxs.y, Rgba(60, 60, 60, 255));
+	g_theRenderer->DrawQuad2D(barMins.x, barMins.y, barMins.x + ((barMaxs.x - barMins.x) * fractionGenerated), barMaxs.y, Rgba::WHITE);
+	g_theRenderer->DrawCenteredText2D(Vector2(ORTHO_X_DIMENSION * 0.5f, barMins.y - 1.f), g_theRenderer->m_defaultFont, std::to_string(numMapsGenerated) + " / " + std::to_string(numMapsToGenerate) + " maps", Rgba::LIGHT_GREY, 0.75f);
 }
 
 void Game::DrawPlayerStats() const
@@ -675,14 +588,60 @@ void Game::DrawStatsScreen() const
 	DrawPlayerEquipment();	
 }
 
+void Game::DrawGenerationTimeline() const
+{
+	std::vector<std::string> timelineLines = GenerationProfiler::GetTimelineLines(*m_theWorld->m_currentlyGeneratingMap);
+	float lineHeight = 0.45f;
+	float timelineTop = ORTHO_Y_DIMENSION - 2.f;
+
+	g_theRenderer->SetTexture(nullptr);
+	g_theRenderer->DrawQuad2D(0.f, timelineTop - (lineHeight * (timelineLines.size() + 1)), ORTHO_X_DIMENSION * 0.5f, timelineTop + lineHeight, Rgba(0, 0, 0, 160));
+	g_theRenderer->DrawText2D(Vector2(0.5f, timelineTop + lineHeight), g_theRenderer->m_defaultFont, "SPACE: Run next generator. ENTER: Finish.", Rgba::LIGHT_GREY, 0.5f);
+	for (size_t lineIndex = 0; lineIndex < timelineLines.size(); lineIndex++)
+	{
+		g_theRenderer->DrawText2D(Vector2(0.5f, timelineTop - (lineHeight * lineIndex)), g_theRenderer->m_defaultFont, timelineLines[lineIndex], Rgba::WHITE, 0.5f);
+	}
+}
+
+//WORLD_SEED in the config pins the world so a run can be reproduced
+unsigned int Game::GetWorldSeed() const
+{
+	int worldSeed = (int)time(NULL);
+	g_theConfig->GetConfigInt(worldSeed, (std::string)"WORLD_SEED");
+	return (unsigned int)worldSeed;
+}
+
 void Game::StartAdventure(std::string adventureName)
 {
 	if(m_theWorld != nullptr)
 	{
+		SaveSessionRecording();
 		delete m_theWorld;
 		m_theWorld = nullptr;
 	}
 
-	m_theWorld = new World();
-	m_theWorld->GenerateAdventure(adventureName);
+	m_theWorld = new World(GetWorldSeed());
+	m_theWorld->StartGeneratingAdventure(adventureName);
+
+	std::string sessionRecordingFileName;
+	g_theConfig->GetConfigString(sessionRecordingFileName, "SessionRecordingFileName");
+	if (!sessionRecordingFileName.empty())
+	{
+		SessionRecording* sessionRecording = new SessionRecording();
+		sessionRecording->m_worldSeed = m_theWorld->m_worldSeed;
+		sessionRecording->m_adventureName = adventureName;
+		g_theConfig->GetConfigInt(sessionRecording->m_checkpointInterval, "SessionCheckpointInterval");
+		m_theWorld->m_sessionRecording = sessionRecording;
+	}
+}
+
+//Written when the session ends rather than every turn, so recording never touches the disk during play
+void Game::SaveSessionRecording() const
+{
+	if (!m_theWorld || !m_theWorld->m_sessionRecording)
+		return;
+
+	std::string sessionRecordingFileName;
+	g_theConfig->GetConfigString(sessionRecordingFileName, "SessionRecordingFileName");
+	m_theWorld->m_sessionRecording->SaveToFile(sessionRecordingFileName);
 }
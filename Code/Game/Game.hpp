@@ -10,7 +10,8 @@ enum GameState
 	STATE_PLAYING,
 	STATE_STATSSCREEN,
 	STATE_GENERATING,
-	STATE_PATHING
+	STATE_PATHING,
+	STATE_LOADING
 };
 
 enum InventoryManagementState
@@ -27,7 +28,10 @@ private:
 	bool isGamePaused;
 
 	void DrawStatsScreen() const;
+	void DrawGenerationTimeline() const;
 	void StartAdventure(std::string adventureName);
+	void SaveSessionRecording() const;
+	unsigned int GetWorldSeed() const;
 public:
 	World* m_theWorld;
 	GameState m_currentState = STATE_MAINMENU;
@@ -49,21 +53,14 @@ private:
 	void UpdateStatsScreen(float deltaSeconds);
 	void UpdateGenerating(float deltaSeconds);
 	void UpdatePathing(float deltaSeconds);
+	void UpdateLoading(float deltaSeconds);
 
 	void RenderMainMenu() const;
 	void RenderPlaying() const;
 	void RenderStatsScreen() const;
 	void RenderGenerating() const;
 	void RenderPathing() const;
-
-	void LoadTileDefinitions();
-	void LoadCharacterBuilders();
-	void LoadItemDefinitions();
-	void LoadFeaturePrototypes();
-	void LoadLootTables();
-	void LoadMapDefinitions();
-	void LoadAdventures();
-	void LoadGameConstants();
+	void RenderLoading() const;
 
 	void DrawPlayerStats() const;
 	void DrawPlayerInventory() const;
@@ -1,9 +1,11 @@
 #include "Game/GameCommon.hpp"
 
 
+#ifndef ROGUELIKE_HEADLESS
 InputSystem* g_theInput = nullptr;
 AudioSystem* g_theAudio = nullptr;
 App* g_theApp = nullptr;
+#endif
 
 
 float ORTHO_X_DIMENSION = 16.f;
@@ -15,4 +17,11 @@ float BASE_CHANCE_TO_HIT = 0.f;
 float CHANCE_TO_HIT_PER_AGILITY = 0.f;
 float BASE_CRITICAL_CHANCE = 0.f;
 float CRITICAL_CHANCE_PER_LUCK = 0.f;
-float CRITICAL_MULTIPLIER = 1.f;
\ No newline at end of file
+float CRITICAL_MULTIPLIER = 1.f;
+
+int SIMULATION_ACTIVE_RADIUS = 0;
+
+BackgroundSimulationMode BACKGROUND_SIMULATION_MODE = BACKGROUND_SIMULATION_OFF;
+int BACKGROUND_SIMULATION_INTERVAL = 1;
+int BACKGROUND_SIMULATION_MAX_TURNS = 0;
+float BACKGROUND_SIMULATION_BUDGET_MS = 0.f;
\ No newline at end of file
@@ -1,4 +1,6 @@
 #pragma once
+//ROGUELIKE_HEADLESS builds the simulation without a window, renderer, input or audio, see Code/Headless
+#ifndef ROGUELIKE_HEADLESS
 #include "Engine/Renderer/RHI/SimpleRenderer.hpp"
 #include "Engine/Input/InputSystem.hpp"
 #include "Engine/Audio/Audio.hpp"
@@ -9,10 +11,15 @@ class App;
 extern InputSystem* g_theInput;
 extern AudioSystem* g_theAudio;
 extern App* g_theApp;
+#endif
 
 constexpr unsigned int WINDOW_DEFAULT_RESOLUTION_X = 1280;
 constexpr unsigned int WINDOW_DEFAULT_RESOLUTION_Y = 720;
 
+//Map clocks run in ticks so characters can act faster or slower than once per player turn
+constexpr int TICKS_PER_TURN = 100;
+constexpr int NORMAL_ACTION_SPEED = 100;
+
 extern float ORTHO_X_DIMENSION;
 extern float ORTHO_Y_DIMENSION;
 extern float ORTHO_X_OFFSET;
@@ -22,4 +29,22 @@ extern float BASE_CHANCE_TO_HIT;
 extern float CHANCE_TO_HIT_PER_AGILITY;
 extern float BASE_CRITICAL_CHANCE;
 extern float CRITICAL_CHANCE_PER_LUCK;
-extern float CRITICAL_MULTIPLIER;
\ No newline at end of file
+extern float CRITICAL_MULTIPLIER;
+
+//Characters farther than this many tiles from the player, with nothing to chase, sleep until woken. 0 keeps everyone awake.
+extern int SIMULATION_ACTIVE_RADIUS;
+
+//What happens to maps the player has left. Catch-up replays the missed time in one batch when the player returns; worker
+//also advances them on the job system between visits, so less is left to replay.
+enum BackgroundSimulationMode
+{
+	BACKGROUND_SIMULATION_OFF,
+	BACKGROUND_SIMULATION_CATCH_UP,
+	BACKGROUND_SIMULATION_WORKER,
+	NUM_BACKGROUND_SIMULATION_MODES
+};
+
+extern BackgroundSimulationMode BACKGROUND_SIMULATION_MODE;
+extern int BACKGROUND_SIMULATION_INTERVAL;			//Player turns between background updates of each map
+extern int BACKGROUND_SIMULATION_MAX_TURNS;			//Turns a map keeps living after the player leaves before it freezes
+extern float BACKGROUND_SIMULATION_BUDGET_MS;		//Longest one background update of one map may run
\ No newline at end of file
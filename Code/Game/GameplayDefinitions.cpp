@@ -0,0 +1,159 @@
+#include "Game/GameplayDefinitions.hpp"
+#include "Game/GameCommon.hpp"
+#include "Game/TileDefinition.hpp"
+#include "Game/MapDefinition.hpp"
+#include "Game/CharacterBuilder.hpp"
+#include "Game/ItemDefinition.hpp"
+#include "Game/Feature.hpp"
+#include "Game/LootTable.hpp"
+#include "Game/Adventure.hpp"
+#include "Engine/Core/ConfigSystem.hpp"
+#include "Engine/Core/XMLUtils.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+
+
+void GameplayDefinitions::LoadAll()
+{
+	LoadGameConstants();
+	LoadLootTables();
+	LoadTileDefinitions();
+	LoadCharacterBuilders();
+	LoadItemDefinitions();
+	LoadFeaturePrototypes();
+	LoadMapDefinitions();
+	LoadAdventures();
+}
+
+void GameplayDefinitions::LoadTileDefinitions()
+{
+	std::string tileDefinitionFileName = "Data/Gameplay/Tiles.xml";
+	g_theConfig->GetConfigString(tileDefinitionFileName, "TileDefinitionFileName");
+
+	XMLNode tileDefinitionsHead = XMLNode::parseFile(tileDefinitionFileName.c_str(), "TileDefinitions");
+	for (int tileDefIndex = 0; tileDefIndex < tileDefinitionsHead.nChildNode("TileDefinition"); tileDefIndex++)
+	{
+		XMLNode tileDef = tileDefinitionsHead.getChildNode("TileDefinition", tileDefIndex);
+		new TileDefinition(tileDef);
+	}
+
+	TileDefinition::CreateMapBorderDefinition();
+}
+
+void GameplayDefinitions::LoadMapDefinitions()
+{
+	std::string mapFileName = "Data/Gameplay/Maps.xml";
+
+	XMLNode mapsHead = XMLNode::parseFile(mapFileName.c_str(), "MapDefinitions");
+	for (int mapsIndex = 0; mapsIndex < mapsHead.nChildNode("MapDefinition"); mapsIndex++)
+	{
+		XMLNode mapDefinition = mapsHead.getChildNode("MapDefinition", mapsIndex);
+		new MapDefinition(mapDefinition);
+	}
+}
+
+void GameplayDefinitions::LoadAdventures()
+{
+	std::string adventuresFileName = "Data/Gameplay/Adventures.xml";
+	g_theConfig->GetConfigString(adventuresFileName, "AdventuresFileName");
+
+	XMLNode adventuresHead = XMLNode::parseFile(adventuresFileName.c_str(), "Adventures");
+	for (int adventuresIndex = 0; adventuresIndex < adventuresHead.nChildNode("Adventure"); adventuresIndex++)
+	{
+		XMLNode adventureNode = adventuresHead.getChildNode("Adventure", adventuresIndex);
+		new Adventure(adventureNode);
+	}
+}
+
+void GameplayDefinitions::LoadCharacterBuilders()
+{
+	std::string charactersFileName = "Data/Gameplay/Characters.xml";
+	g_theConfig->GetConfigString(charactersFileName, "CharactersFileName");
+
+	XMLNode charactersHead = XMLNode::parseFile(charactersFileName.c_str(), "Characters");
+	for (int characterIndex = 0; characterIndex < charactersHead.nChildNode("Character"); characterIndex++)
+	{
+		XMLNode characterBuilder = charactersHead.getChildNode("Character", characterIndex);
+		new CharacterBuilder(characterBuilder);
+	}
+}
+
+void GameplayDefinitions::LoadItemDefinitions()
+{
+	std::string itemsFileName = "Data/Gameplay/Items.xml";
+	g_theConfig->GetConfigString(itemsFileName, "ItemsFileName");
+
+	XMLNode itemsHead = XMLNode::parseFile(itemsFileName.c_str(), "ItemDefinitions");
+	for (int itemIndex = 0; itemIndex < itemsHead.nChildNode("ItemDefinition"); itemIndex++)
+	{
+		XMLNode itemDefinition = itemsHead.getChildNode("ItemDefinition", itemIndex);
+		new ItemDefinition(itemDefinition);
+	}
+}
+
+void GameplayDefinitions::LoadFeaturePrototypes()
+{
+	std::string featuresFileName = "Data/Gameplay/Features.xml";
+	g_theConfig->GetConfigString(featuresFileName, "FeaturesFileName");
+
+	XMLNode featuresHead = XMLNode::parseFile(featuresFileName.c_str(), "Features");
+	for (int featureIndex = 0; featureIndex < featuresHead.nChildNode("Feature"); featureIndex++)
+	{
+		XMLNode feature = featuresHead.getChildNode("Feature", featureIndex);
+		new Feature(feature);
+	}
+}
+
+void GameplayDefinitions::LoadLootTables()
+{
+	std::string lootFileName = "Data/Gameplay/Loot.xml";
+	g_theConfig->GetConfigString(lootFileName, "LootFileName");
+
+	XMLNode lootHead = XMLNode::parseFile(lootFileName.c_str(), "LootTables");
+	for (int lootIndex = 0; lootIndex < lootHead.nChildNode("LootTable"); lootIndex++)
+	{
+		XMLNode loot = lootHead.getChildNode("LootTable", lootIndex);
+		new LootTable(loot);
+	}
+}
+
+void GameplayDefinitions::LoadGameConstants()
+{
+	std::string constantsFileName = "Data/Gameplay/GameConstants.xml";
+	g_theConfig->GetConfigString(constantsFileName, "ConstantsFileName");
+
+	XMLNode constantsHead = XMLNode::parseFile(constantsFileName.c_str(), "Constants");
+
+	XMLNode baseChanceToHitNode = constantsHead.getChildNode("BaseChanceToHit");
+	BASE_CHANCE_TO_HIT = ParseXMLAttributeFloat(baseChanceToHitNode, "chance", 0.f);
+
+	XMLNode chanceToHitPerAgilityNode = constantsHead.getChildNode("ChanceToHitPerAgility");
+	CHANCE_TO_HIT_PER_AGILITY = ParseXMLAttributeFloat(chanceToHitPerAgilityNode, "chance", 0.f);
+
+	XMLNode baseCriticalChanceNode = constantsHead.getChildNode("BaseCriticalChance");
+	BASE_CRITICAL_CHANCE = ParseXMLAttributeFloat(baseCriticalChanceNode, "chance", 0.f);
+
+	XMLNode criticalChancePerLuckNode = constantsHead.getChildNode("CriticalChancePerLuck");
+	CRITICAL_CHANCE_PER_LUCK = ParseXMLAttributeFloat(criticalChancePerLuckNode, "chance", 0.f);
+
+	XMLNode criticalMultiplierNode = constantsHead.getChildNode("CriticalMultiplier");
+	CRITICAL_MULTIPLIER = ParseXMLAttributeFloat(criticalMultiplierNode, "multiplier", 1.f);
+
+	XMLNode simulationRadiusNode = constantsHead.getChildNode("SimulationRadius");
+	SIMULATION_ACTIVE_RADIUS = ParseXMLAttributeInt(simulationRadiusNode, "active", 0);
+
+	XMLNode backgroundSimulationNode = constantsHead.getChildNode("BackgroundSimulation");
+	std::string backgroundModeString = ParseXMLAttributeString(backgroundSimulationNode, "mode", "off");
+	if (backgroundModeString == "off")
+		BACKGROUND_SIMULATION_MODE = BACKGROUND_SIMULATION_OFF;
+	else if (backgroundModeString == "catchUp")
+		BACKGROUND_SIMULATION_MODE = BACKGROUND_SIMULATION_CATCH_UP;
+	else if (backgroundModeString == "worker")
+		BACKGROUND_SIMULATION_MODE = BACKGROUND_SIMULATION_WORKER;
+	else
+		ERROR_AND_DIE("Invalid background simulation mode.");
+
+	BACKGROUND_SIMULATION_INTERVAL = ParseXMLAttributeInt(backgroundSimulationNode, "interval", 1);
+	ASSERT_OR_DIE(BACKGROUND_SIMULATION_INTERVAL > 0, "Background simulation interval must be at least one turn.");
+	BACKGROUND_SIMULATION_MAX_TURNS = ParseXMLAttributeInt(backgroundSimulationNode, "maxTurns", 0);
+	BACKGROUND_SIMULATION_BUDGET_MS = ParseXMLAttributeFloat(backgroundSimulationNode, "budgetMs", 0.f);
+}
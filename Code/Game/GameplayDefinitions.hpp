@@ -0,0 +1,20 @@
+#pragma once
+
+
+//Loads every gameplay definition registry from Data/Gameplay. Shared by the game, the map benchmark and the headless
+//runner, none of which need anything else from Game to build maps and characters.
+class GameplayDefinitions
+{
+public:
+	static void LoadAll();
+
+private:
+	static void LoadTileDefinitions();
+	static void LoadCharacterBuilders();
+	static void LoadItemDefinitions();
+	static void LoadFeaturePrototypes();
+	static void LoadLootTables();
+	static void LoadMapDefinitions();
+	static void LoadAdventures();
+	static void LoadGameConstants();
+};
@@ -0,0 +1,147 @@
+#include "Game/GenerationProfiler.hpp"
+#include "Game/Map.hpp"
+#include "Game/MapDefinition.hpp"
+#include "Game/MemoryTracking.hpp"
+#include "Engine/Core/Time.hpp"
+#include <atomic>
+#include <fstream>
+#include <stdio.h>
+
+
+static std::atomic<unsigned int> s_nextThreadIndex(0);
+static thread_local unsigned int s_threadIndex = 0;
+static thread_local bool s_hasThreadIndex = false;
+
+static std::string MakeJSONString(const std::string& text)
+{
+	std::string jsonString = "\"";
+	for (char character : text)
+	{
+		if (character == '"' || character == '\\')
+			jsonString += '\\';
+		if ((unsigned char)character < 0x20)
+			continue;
+		jsonString += character;
+	}
+	return jsonString + "\"";
+}
+
+
+GenerationStepScope::GenerationStepScope(Map* mapBeingGenerated, const MapGenerator* generator, int generatorIndex)
+	: m_map(mapBeingGenerated)
+{
+	m_record.m_generatorName = generator->m_name;
+	m_record.m_generatorIndex = generatorIndex;
+	m_record.m_threadIndex = GenerationProfiler::GetCurrentThreadIndex();
+	m_map->m_hasGenerationStepFailed = false;
+
+#if defined(ROGUELIKE_PROFILING)
+	m_tileDefinitionsBefore.resize(m_map->m_tiles.size());
+	for (size_t tileIndex = 0; tileIndex < m_map->m_tiles.size(); tileIndex++)
+	{
+		m_tileDefinitionsBefore[tileIndex] = m_map->m_tiles[tileIndex].m_tileDefinition;
+	}
+#endif
+
+	ThreadAllocationCounts allocationsBefore = GetThreadAllocationCounts();
+	m_numAllocationsBefore = allocationsBefore.m_numAllocations;
+	m_bytesAllocatedBefore = allocationsBefore.m_totalBytesAllocated;
+	m_record.m_startSeconds = GetCurrentTimeSeconds();
+}
+
+GenerationStepScope::~GenerationStepScope()
+{
+	m_record.m_durationSeconds = GetCurrentTimeSeconds() - m_record.m_startSeconds;
+	ThreadAllocationCounts allocationsAfter = GetThreadAllocationCounts();
+	m_record.m_numAllocations = allocationsAfter.m_numAllocations - m_numAllocationsBefore;
+	m_record.m_bytesAllocated = allocationsAfter.m_totalBytesAllocated - m_bytesAllocatedBefore;
+
+#if defined(ROGUELIKE_PROFILING)
+	for (size_t tileIndex = 0; tileIndex < m_map->m_tiles.size(); tileIndex++)
+	{
+		if (m_map->m_tiles[tileIndex].m_tileDefinition != m_tileDefinitionsBefore[tileIndex])
+			m_record.m_numTilesChanged++;
+	}
+#endif
+
+	m_record.m_hasFailed = m_map->m_hasGenerationStepFailed;
+	m_map->m_generationTimeline.push_back(m_record);
+}
+
+
+std::vector<std::string> GenerationProfiler::GetTimelineLines(const Map& map)
+{
+	std::vector<std::string> lines;
+	double totalMilliseconds = 0.0;
+	for (const GenerationStepRecord& record : map.m_generationTimeline)
+	{
+		char line[256];
+#if defined(ROGUELIKE_PROFILING)
+		snprintf(line, sizeof(line), "%d %s: %.2f ms, %d tiles, %llu allocs (%llu KB)", record.m_generatorIndex, record.m_generatorName.c_str(), record.m_durationSeconds * 1000.0,
+			record.m_numTilesChanged, record.m_numAllocations, record.m_bytesAllocated / 1024);
+#else
+		snprintf(line, sizeof(line), "%d %s: %.2f ms", record.m_generatorIndex, record.m_generatorName.c_str(), record.m_durationSeconds * 1000.0);
+#endif
+		lines.push_back(record.m_hasFailed ? std::string(line) + " (failed)" : std::string(line));
+		totalMilliseconds += record.m_durationSeconds * 1000.0;
+	}
+
+	char totalLine[64];
+	snprintf(totalLine, sizeof(totalLine), "Total: %.2f ms", totalMilliseconds);
+	lines.push_back(totalLine);
+	return lines;
+}
+
+//Complete events ("ph":"X") for chrome://tracing or Perfetto. Each map is its own process row and each generating thread its own track.
+bool GenerationProfiler::WriteChromeTrace(const std::string& filePath, const std::vector<const Map*>& maps)
+{
+	std::ofstream traceFile(filePath.c_str(), std::ios::trunc);
+	if (!traceFile.is_open())
+		return false;
+
+	double earliestStartSeconds = -1.0;
+	for (const Map* map : maps)
+	{
+		for (const GenerationStepRecord& record : map->m_generationTimeline)
+		{
+			if (earliestStartSeconds < 0.0 || record.m_startSeconds < earliestStartSeconds)
+				earliestStartSeconds = record.m_startSeconds;
+		}
+	}
+
+	traceFile << "{\"traceEvents\": [\n";
+	bool isFirstEvent = true;
+	for (size_t mapIndex = 0; mapIndex < maps.size(); mapIndex++)
+	{
+		const Map* map = maps[mapIndex];
+		char event[1024];
+		snprintf(event, sizeof(event), "%s\t{ \"name\": \"process_name\", \"ph\": \"M\", \"pid\": %u, \"args\": { \"name\": %s } }", isFirstEvent ? "" : ",\n",
+			(unsigned int)mapIndex + 1, MakeJSONString(map->m_definition->m_name + " (seed " + std::to_string(map->m_seed) + ")").c_str());
+		traceFile << event;
+		isFirstEvent = false;
+
+		for (const GenerationStepRecord& record : map->m_generationTimeline)
+		{
+			snprintf(event, sizeof(event), ",\n\t{ \"name\": %s, \"cat\": \"generation\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": %u, \"tid\": %u, "
+				"\"args\": { \"generatorIndex\": %d, \"tilesChanged\": %d, \"allocations\": %llu, \"bytesAllocated\": %llu, \"failed\": %s } }",
+				MakeJSONString(record.m_generatorName).c_str(), (record.m_startSeconds - earliestStartSeconds) * 1000000.0, record.m_durationSeconds * 1000000.0, (unsigned int)mapIndex + 1,
+				record.m_threadIndex, record.m_generatorIndex, record.m_numTilesChanged, record.m_numAllocations, record.m_bytesAllocated, record.m_hasFailed ? "true" : "false");
+			traceFile << event;
+		}
+	}
+	traceFile << "\n]}\n";
+
+	return !traceFile.fail();
+}
+
+//Small, stable per-thread numbers read better as trace tracks than raw thread ids
+unsigned int GenerationProfiler::GetCurrentThreadIndex()
+{
+	if (!s_hasThreadIndex)
+	{
+		s_threadIndex = s_nextThreadIndex++;
+		s_hasThreadIndex = true;
+	}
+
+	return s_threadIndex;
+}
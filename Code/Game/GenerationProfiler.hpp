@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <vector>
+
+
+class Map;
+class MapGenerator;
+class TileDefinition;
+
+//One MapGenerator::GenerateMap call as seen by the profiler
+struct GenerationStepRecord
+{
+	std::string m_generatorName;
+	int m_generatorIndex = 0;
+	double m_startSeconds = 0.0;
+	double m_durationSeconds = 0.0;
+	int m_numTilesChanged = 0;
+	unsigned long long m_numAllocations = 0;
+	unsigned long long m_bytesAllocated = 0;
+	unsigned int m_threadIndex = 0;
+	bool m_hasFailed = false;
+};
+
+//Times one generator step and appends its record to the map's generation timeline when it goes out of scope.
+//Changed tiles and allocations are only counted with ROGUELIKE_PROFILING, since that means snapshotting the whole map
+//and tracking every allocation. Allocations are counted on the calling thread only, so work a generator farms out to
+//the job system is not included.
+class GenerationStepScope
+{
+public:
+	GenerationStepScope(Map* mapBeingGenerated, const MapGenerator* generator, int generatorIndex);
+	~GenerationStepScope();
+
+private:
+	Map* m_map;
+	GenerationStepRecord m_record;
+	std::vector<const TileDefinition*> m_tileDefinitionsBefore;
+	unsigned long long m_numAllocationsBefore;
+	unsigned long long m_bytesAllocatedBefore;
+};
+
+class GenerationProfiler
+{
+public:
+	static std::vector<std::string> GetTimelineLines(const Map& map);
+	static bool WriteChromeTrace(const std::string& filePath, const std::vector<const Map*>& maps);
+	static unsigned int GetCurrentThreadIndex();
+};
@@ -1,13 +1,13 @@
 #include "Game/Item.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 
-Item::Item(std::string typeName)
+Item::Item(std::string typeName, RandomStream& random)
 	: m_damageTypes()
 {
 	m_definition = ItemDefinition::GetItemDefinition(typeName);
 	ASSERT_OR_DIE(m_definition != nullptr, "Attempted to create item of invalid item definition.");
 
-	m_stats = Stats::CalculateRandomStatsInRange(m_definition->m_minStats, m_definition->m_maxStats);
+	m_stats = Stats::CalculateRandomStatsInRange(m_definition->m_minStats, m_definition->m_maxStats, random);
 
 	m_damageTypes.SetTags(m_definition->m_damageTypeString);
 }
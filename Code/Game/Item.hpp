@@ -1,17 +1,17 @@
 #pragma once
-#include "Engine\Core\Rgba.hpp"
+#include "Engine/Core/Rgba.hpp"
 #include "Game/Stats.hpp"
 #include "Game/ItemDefinition.hpp"
 #include <string>
 #include <vector>
-#include "Engine\Gameplay\Tags.hpp"
+#include "Engine/Gameplay/Tags.hpp"
 
 
 
 class Item
 {
 public:
-	Item(std::string typeName);
+	Item(std::string typeName, RandomStream& random);
 	~Item();
 
 	int CalculateTotalStatModifier() const;
@@ -1,8 +1,8 @@
 #pragma once
-#include "Engine\Core\Rgba.hpp"
+#include "Engine/Core/Rgba.hpp"
 #include "Game/Stats.hpp"
 #include <string>
-#include "ThirdParty\XMLParser\XMLParser.hpp"
+#include "ThirdParty/XMLParser/XMLParser.hpp"
 #include <map>
 
 
@@ -0,0 +1,168 @@
+#include "Game/JobSystem.hpp"
+#include <algorithm>
+#include <memory>
+
+
+JobSystem* g_theJobSystem = nullptr;
+
+
+JobSystem::JobSystem(int numWorkerThreads)
+	: m_workerThreads()
+	, m_jobQueue()
+	, m_backgroundJobQueue()
+	, m_isShuttingDown(false)
+{
+	if (numWorkerThreads < 0)
+		numWorkerThreads = (int)std::thread::hardware_concurrency() - 1;
+
+	if (numWorkerThreads < 1)
+		numWorkerThreads = 1;
+
+	for (int threadIndex = 0; threadIndex < numWorkerThreads; threadIndex++)
+	{
+		m_workerThreads.push_back(std::thread(&JobSystem::WorkerThreadMain, this));
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		m_isShuttingDown = true;
+	}
+	m_jobAvailable.notify_all();
+
+	for (std::thread& workerThread : m_workerThreads)
+	{
+		workerThread.join();
+	}
+}
+
+void JobSystem::QueueJob(const std::function<void()>& work, JobCounter* counter, JobQueueType queueType)
+{
+	Job newJob;
+	newJob.m_work = work;
+	newJob.m_counter = counter;
+	if (counter)
+		counter->m_numJobsRemaining++;
+
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		if (queueType == JOB_QUEUE_BACKGROUND)
+			m_backgroundJobQueue.push_back(newJob);
+		else
+			m_jobQueue.push_back(newJob);
+	}
+	m_jobAvailable.notify_one();
+}
+
+void JobSystem::WaitForCounter(JobCounter& counter)
+{
+	while (counter.m_numJobsRemaining > 0)
+	{
+		if (!TryRunOneJob())
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::ParallelFor(int numItems, const std::function<void(int)>& work)
+{
+	//The calling thread claims items alongside the helpers and only waits for the items to finish, never for the helper jobs
+	//themselves. A helper stuck in the queue behind something long, like a map generating in the background, then costs the
+	//caller nothing; it finds no items left by the time it runs. The state is shared so such a late helper outlives this call.
+	std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+	state->m_work = work;
+	state->m_numItems = numItems;
+
+	int numHelperJobs = std::min(GetNumWorkerThreads(), numItems - 1);
+	for (int helperIndex = 0; helperIndex < numHelperJobs; helperIndex++)
+	{
+		QueueJob([state]() { RunParallelForItems(*state); });
+	}
+
+	RunParallelForItems(*state);
+	while (state->m_numItemsCompleted < numItems)
+	{
+		std::this_thread::yield();
+	}
+}
+
+int JobSystem::GetNumWorkerThreads() const
+{
+	return (int)m_workerThreads.size();
+}
+
+void JobSystem::RunParallelForItems(ParallelForState& state)
+{
+	for (int itemIndex = state.m_nextItem++; itemIndex < state.m_numItems; itemIndex = state.m_nextItem++)
+	{
+		state.m_work(itemIndex);
+		state.m_numItemsCompleted++;
+	}
+}
+
+void JobSystem::WorkerThreadMain()
+{
+	for (;;)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(m_queueMutex);
+			m_jobAvailable.wait(lock, [this]() { return m_isShuttingDown || !m_jobQueue.empty() || !m_backgroundJobQueue.empty(); });
+			if (!m_jobQueue.empty())
+			{
+				job = m_jobQueue.front();
+				m_jobQueue.pop_front();
+			}
+			else if (!m_backgroundJobQueue.empty())
+			{
+				job = m_backgroundJobQueue.front();
+				m_backgroundJobQueue.pop_front();
+			}
+			else
+			{
+				return;
+			}
+		}
+
+		RunJob(job);
+	}
+}
+
+//Only ever takes normal jobs; see the class comment
+bool JobSystem::TryRunOneJob()
+{
+	Job job;
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		if (m_jobQueue.empty())
+			return false;
+
+		job = m_jobQueue.front();
+		m_jobQueue.pop_front();
+	}
+
+	RunJob(job);
+	return true;
+}
+
+void JobSystem::RunJob(Job& job)
+{
+	job.m_work();
+	if (job.m_counter)
+		job.m_counter->m_numJobsRemaining--;
+}
+
+void RunParallelFor(int numItems, const std::function<void(int)>& work)
+{
+	if (g_theJobSystem && numItems > 1)
+	{
+		g_theJobSystem->ParallelFor(numItems, work);
+		return;
+	}
+
+	for (int itemIndex = 0; itemIndex < numItems; itemIndex++)
+	{
+		work(itemIndex);
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+struct JobCounter
+{
+	JobCounter()
+		: m_numJobsRemaining(0) {}
+
+	std::atomic<int> m_numJobsRemaining;
+};
+
+struct ParallelForState
+{
+	ParallelForState()
+		: m_nextItem(0), m_numItemsCompleted(0), m_numItems(0) {}
+
+	std::function<void(int)> m_work;
+	std::atomic<int> m_nextItem;
+	std::atomic<int> m_numItemsCompleted;
+	int m_numItems;
+};
+
+enum JobQueueType
+{
+	JOB_QUEUE_NORMAL,
+	JOB_QUEUE_BACKGROUND
+};
+
+struct Job
+{
+	std::function<void()> m_work;
+	JobCounter* m_counter = nullptr;
+};
+
+//Fixed pool of worker threads pulling from two queues. Threads that wait on a counter run normal jobs while they wait, so jobs may wait on
+//other jobs. Background jobs are long and nobody is in a hurry for them: only the workers run them, and only when no normal job is queued,
+//so a wait on the main thread is never stuck behind one. Don't wait on a background job from inside another job.
+class JobSystem
+{
+public:
+	JobSystem(int numWorkerThreads = -1);
+	~JobSystem();
+
+	void QueueJob(const std::function<void()>& work, JobCounter* counter = nullptr, JobQueueType queueType = JOB_QUEUE_NORMAL);
+	void WaitForCounter(JobCounter& counter);
+	void ParallelFor(int numItems, const std::function<void(int)>& work);
+
+	int GetNumWorkerThreads() const;
+
+private:
+	void WorkerThreadMain();
+	bool TryRunOneJob();
+	void RunJob(Job& job);
+	static void RunParallelForItems(ParallelForState& state);
+
+	std::vector<std::thread> m_workerThreads;
+	std::deque<Job> m_jobQueue;
+	std::deque<Job> m_backgroundJobQueue;
+	std::mutex m_queueMutex;
+	std::condition_variable m_jobAvailable;
+	bool m_isShuttingDown;
+};
+
+void RunParallelFor(int numItems, const std::function<void(int)>& work);
+
+extern JobSystem* g_theJobSystem;
@@ -19,12 +19,28 @@ LootTable::LootTable(XMLNode element)
 		int lootWeight = ParseXMLAttributeInt(lootNode, "weight", 0);
 		ASSERT_OR_DIE(lootWeight != 0, "No/invalid weight found for loot element.");
 
-		m_possibleItems.AddItem(itemName, lootWeight);
+		m_possibleItems.push_back(itemName);
+		m_itemWeights.push_back(lootWeight);
+		m_totalWeight += lootWeight;
 	}
 
 	s_registry[m_name] = this;
 }
 
+std::string LootTable::GetRandomItem(RandomStream& random) const
+{
+	int roll = random.GetRandomIntLessThan(m_totalWeight);
+	for (size_t itemIndex = 0; itemIndex < m_possibleItems.size(); itemIndex++)
+	{
+		if (roll < m_itemWeights[itemIndex])
+			return m_possibleItems[itemIndex];
+
+		roll -= m_itemWeights[itemIndex];
+	}
+
+	return m_possibleItems.back();
+}
+
 LootTable* LootTable::GetLootTable(std::string name)
 {
 	std::map<std::string, LootTable*>::iterator found = LootTable::s_registry.find(name);
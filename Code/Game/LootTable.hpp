@@ -1,6 +1,8 @@
 #pragma once
-#include "Engine\Core\WeightedList.hpp"
 #include "Game/ItemDefinition.hpp"
+#include "Game/RandomStream.hpp"
+#include <string>
+#include <vector>
 
 
 
@@ -9,7 +11,11 @@ class LootTable
 public:
 	LootTable(XMLNode element);
 
-	WeightedList<std::string> m_possibleItems;
+	std::string GetRandomItem(RandomStream& random) const;
+
+	std::vector<std::string> m_possibleItems;
+	std::vector<int> m_itemWeights;
+	int m_totalWeight = 0;
 	std::string m_name;
 
 	static LootTable* GetLootTable(std::string name);
@@ -5,7 +5,16 @@
 #include "Game/MapDefinition.hpp"
 #include "Game/GameCommon.hpp"
 #include "Engine/Core/EngineConfig.hpp"
-#include "Game/App.hpp"
+#include "Game/World.hpp"
+#include "Game/OverworldStreamer.hpp"
+#include "Game/JobSystem.hpp"
+#include "Game/MapGeneratorOverworld.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Game/BinaryBuffer.hpp"
+#include <algorithm>
+#include <climits>
+#include <cfloat>
 
 
 PathGenerator::PathGenerator(const IntVector2& start, const IntVector2& end, Map* map, Character* gCostReferenceCharacter)
@@ -13,14 +22,36 @@ PathGenerator::PathGenerator(const IntVector2& start, const IntVector2& end, Map
 	, m_end(end)
 	, m_map(map)
 	, m_gCostReferenceCharacter(gCostReferenceCharacter)
+	, m_nodes()
 	, m_openList()
+	, m_tileStates()
 {
-	static int pathID = 0;
-	pathID++;
-	m_pathID = pathID;
+	m_endTile = m_map->GetTileAtTileCoords(m_end);
 	OpenNodeForProcessing(*m_map->GetTileAtTileCoords(m_start), nullptr);
 }
 
+bool PathGenerator::Step(Path& out_pathWhenComplete)
+{
+	//select and close best open node
+	OpenNode* currentNode = SelectAndCloseBestOpenNode();
+
+	if (!currentNode)
+		return true;
+
+	//see if goal
+	if (currentNode->m_tile->m_tileCoords == m_end)
+	{
+		out_pathWhenComplete = CreateFinalPath(*currentNode);
+		return true;
+	}
+
+	OpenNodeIfValid(currentNode->m_tile->GetNorthNeighbor(), currentNode);
+	OpenNodeIfValid(currentNode->m_tile->GetEastNeighbor(), currentNode);
+	OpenNodeIfValid(currentNode->m_tile->GetSouthNeighbor(), currentNode);
+	OpenNodeIfValid(currentNode->m_tile->GetWestNeighbor(), currentNode);
+
+	return false;
+}
 
 Path PathGenerator::CreateFinalPath(OpenNode& endNode)
 {
@@ -39,16 +70,17 @@ Path PathGenerator::CreateFinalPath(OpenNode& endNode)
 
 void PathGenerator::OpenNodeForProcessing(Tile& tileToOpen, OpenNode* parent)
 {
-	OpenNode* newOpenNode = new OpenNode;
+	m_nodes.push_back(OpenNode());
+	OpenNode* newOpenNode = &m_nodes.back();
 	newOpenNode->m_tile = &tileToOpen;
 	newOpenNode->m_parent = parent;
 	newOpenNode->m_localGCost = newOpenNode->m_tile->GetGCost() + m_gCostReferenceCharacter->GetGCostBias(newOpenNode->m_tile->m_tileDefinition->m_name);
 	newOpenNode->m_totalGCost = ((parent) ? parent->m_totalGCost : 0.f) + newOpenNode->m_localGCost;
-	newOpenNode->m_estimatedDistToGoal = (float)m_map->CalculateManhattanDistance(*newOpenNode->m_tile, *m_map->GetTileAtTileCoords(m_end));
+	newOpenNode->m_estimatedDistToGoal = (float)m_map->CalculateManhattanDistance(*newOpenNode->m_tile, *m_endTile);
 	newOpenNode->m_fScore = newOpenNode->m_estimatedDistToGoal + newOpenNode->m_totalGCost;
 
 	m_openList.push_back(newOpenNode);
-	tileToOpen.m_isOpenInPathID = m_pathID;
+	m_tileStates[m_map->CalculateTileIndexFromTileCoords(tileToOpen.m_tileCoords)] = PATH_TILE_OPEN;
 }
 
 OpenNode* PathGenerator::SelectAndCloseBestOpenNode()
@@ -70,7 +102,7 @@ OpenNode* PathGenerator::SelectAndCloseBestOpenNode()
 		return nullptr;
 
 	OpenNode* bestNode = m_openList[bestNodeIndex];
-	bestNode->m_tile->m_isClosedInPathID = m_pathID;
+	m_tileStates[m_map->CalculateTileIndexFromTileCoords(bestNode->m_tile->m_tileCoords)] = PATH_TILE_CLOSED;
 	m_openList.erase(m_openList.begin() + bestNodeIndex);
 	return bestNode;
 }
@@ -83,15 +115,21 @@ void PathGenerator::OpenNodeIfValid(Tile* tileToOpen, OpenNode* parent)
 	if (tileToOpen->IsSolidToTags(m_gCostReferenceCharacter->m_tags))
 		return;
 
-	if (tileToOpen->m_isClosedInPathID == m_pathID)
-		return;
-
-	if (tileToOpen->m_isOpenInPathID == m_pathID)
+	if (GetTileState(*tileToOpen) != PATH_TILE_UNVISITED)
 		return;
 
 	OpenNodeForProcessing(*tileToOpen, parent);
 }
 
+PathTileState PathGenerator::GetTileState(const Tile& tile) const
+{
+	auto found = m_tileStates.find(m_map->CalculateTileIndexFromTileCoords(tile.m_tileCoords));
+	if (found == m_tileStates.end())
+		return PATH_TILE_UNVISITED;
+
+	return found->second;
+}
+
 
 const float Map::DAMAGE_NUMBER_LIFETIME = 1.f;
 
@@ -106,25 +144,49 @@ DamageNumber::DamageNumber(std::string number, const Vector2& position, const Rg
 }
 
 
-Map::Map(std::string mapDefinitionName)
+Map::Map(std::string mapDefinitionName, unsigned int seed)
 	: m_tiles()
 	, m_entities()
+	, m_entitySlots()
+	, m_tileIndicesByType()
+	, m_tileIndicesByTag()
+	, m_movementClassIndices()
+	, m_freeEntitySlots()
 	, m_name()
+	, m_seed(seed)
+	, m_random(seed)
 {
 	m_definition = MapDefinition::GetDefinition(mapDefinitionName);
 
-	m_tiles.resize(m_definition->m_dimensions.x * m_definition->m_dimensions.y);
+	//Tiles are stored with a one tile border of solid, opaque sentinels so neighbor lookups never need bounds checks
+	m_tileStride = m_definition->m_dimensions.x + 2;
+	m_neighborOffsets[NEIGHBOR_NORTH] = m_tileStride;
+	m_neighborOffsets[NEIGHBOR_SOUTH] = -m_tileStride;
+	m_neighborOffsets[NEIGHBOR_EAST] = 1;
+	m_neighborOffsets[NEIGHBOR_WEST] = -1;
+	m_neighborOffsets[NEIGHBOR_NORTH_EAST] = m_tileStride + 1;
+	m_neighborOffsets[NEIGHBOR_NORTH_WEST] = m_tileStride - 1;
+	m_neighborOffsets[NEIGHBOR_SOUTH_EAST] = -m_tileStride + 1;
+	m_neighborOffsets[NEIGHBOR_SOUTH_WEST] = -m_tileStride - 1;
+
+	m_tiles.resize(m_tileStride * (m_definition->m_dimensions.y + 2));
 	for (size_t tileIndex = 0; tileIndex < m_tiles.size(); tileIndex++)
 	{
 		m_tiles[tileIndex].m_tileCoords = CalculateTileCoordsFromTileIndex(tileIndex);
 		m_tiles[tileIndex].m_containingMap = this;
-		m_tiles[tileIndex].ChangeType(m_definition->m_fillTileType);
+		if (IsInMap(m_tiles[tileIndex].m_tileCoords))
+			m_tiles[tileIndex].ChangeType(m_definition->m_fillTileType, m_random);
+		else
+			m_tiles[tileIndex].MakeMapBorder();
 	}
 }
 
 Map::~Map()
 {
-
+	delete m_currentPath;
+	m_currentPath = nullptr;
+	delete m_overworldStreamer;
+	m_overworldStreamer = nullptr;
 }
 
 
@@ -132,12 +194,10 @@ void Map::Update(float deltaSeconds)
 {
 	for (size_t tileIndex = 0; tileIndex < m_tiles.size(); tileIndex++)
 	{
-		m_tiles[tileIndex].Update(deltaSeconds);
-	}
+		if (m_tiles[tileIndex].IsMapBorder())
+			continue;
 
-	for (size_t entityIndex = 0; entityIndex < m_entities.size(); entityIndex++)
-	{
-		m_entities[entityIndex]->Update(deltaSeconds);
+		m_tiles[tileIndex].Update(deltaSeconds);
 	}
 
 	UpdateDamageNumbers(deltaSeconds);
@@ -147,6 +207,9 @@ void Map::Render() const
 {
 	for (size_t tileIndex = 0; tileIndex < m_tiles.size(); tileIndex++)
 	{
+		if (m_tiles[tileIndex].IsMapBorder())
+			continue;
+
 		m_tiles[tileIndex].Render();
 	}
 
@@ -160,16 +223,20 @@ void Map::Render() const
 
 void Map::RenderDebugPathing() const
 {
+#ifndef ROGUELIKE_HEADLESS
 	if (!m_currentPath)
 		return;
 
-	for (Tile tile : m_tiles)
+	for (const Tile& tile : m_tiles)
 	{
-		if (tile.m_isClosedInPathID == m_currentPath->m_pathID)
+		if (tile.IsMapBorder())
+			continue;
+
+		if (m_currentPath->GetTileState(tile) == PATH_TILE_CLOSED)
 		{
 			g_theRenderer->DrawCenteredText2D((Vector2)tile.m_tileCoords + Vector2(0.5f, 0.5f), g_theRenderer->m_defaultFont, "x", Rgba::RED, 0.5f);
 		}
-		else if (tile.m_isOpenInPathID == m_currentPath->m_pathID)
+		else if (m_currentPath->GetTileState(tile) == PATH_TILE_OPEN)
 		{
 			g_theRenderer->DrawCenteredText2D((Vector2)tile.m_tileCoords + Vector2(0.5f, 0.5f), g_theRenderer->m_defaultFont, "o", Rgba::GREEN, 0.5f);
 		}
@@ -195,6 +262,7 @@ void Map::RenderDebugPathing() const
 		}
 
 	}
+#endif
 }
 
 void Map::RenderDebugGenerating() const
@@ -202,22 +270,229 @@ void Map::RenderDebugGenerating() const
 	m_definition->DebugRender(this);
 }
 
-void Map::AdvanceTurns()
+void Map::AdvanceTurns(int elapsedTicks)
 {
-	for (size_t entityIndex = 0; entityIndex < m_entities.size(); entityIndex++)
+	m_currentTick += elapsedTicks;
+	m_lodStats = SimulationLodStats();
+	WakeDormantCharactersNearPlayer();
+
+	//Everyone due on the same tick decides against the same map, in parallel, before any of their actions land. The actions
+	//are then applied one at a time in schedule order, so the outcome is the same however many threads did the deciding.
+	//Characters that died or left the map since being scheduled no longer resolve and are dropped here. A character faster
+	//than the player is rescheduled before m_currentTick and so acts again within the same call.
+	std::vector<ScheduledTurn> dueTurns;
+	std::vector<ScheduledTurn> plannedTurns;
+	std::vector<Character*> decidingCharacters;
+	while (m_turnScheduler.PopAllDueOnNextTick(m_currentTick, dueTurns))
+	{
+		plannedTurns.clear();
+		decidingCharacters.clear();
+		for (const ScheduledTurn& dueTurn : dueTurns)
+		{
+			Character* actingCharacter = GetCharacter(dueTurn.m_character);
+			if (!actingCharacter)
+				continue;
+
+			if (ShouldCharacterSleep(*actingCharacter))
+			{
+				PutCharacterToSleep(actingCharacter);
+				continue;
+			}
+
+			//Movement class indices are built on first use, so build any missing ones before planning reads them in parallel
+			GetMovementClassIndex(actingCharacter->m_tags);
+			plannedTurns.push_back(dueTurn);
+			decidingCharacters.push_back(actingCharacter);
+		}
+
+		if (m_isInBackground)
+		{
+			for (Character* decidingCharacter : decidingCharacters)
+				decidingCharacter->PlanAction();
+		}
+		else
+		{
+			RunParallelFor((int)decidingCharacters.size(), [&decidingCharacters](int characterIndex)
+			{
+				decidingCharacters[characterIndex]->PlanAction();
+			});
+		}
+
+		for (const ScheduledTurn& plannedTurn : plannedTurns)
+		{
+			//Looked up again, since an action applied earlier this tick may have killed the character
+			Character* actingCharacter = GetCharacter(plannedTurn.m_character);
+			if (!actingCharacter)
+				continue;
+
+			actingCharacter->ApplyPlannedAction();
+			m_lodStats.m_numActions++;
+			if (actingCharacter->m_handle == plannedTurn.m_character)
+				ScheduleNextAction(actingCharacter, plannedTurn.m_tick);
+		}
+	}
+
+	m_lodStats.m_numDormant = (int)m_dormantCharacters.size();
+
+	if (m_overworldStreamer)
+		UpdateOverworldWindow();
+}
+
+//Stepping a turn at a time lands on the same state as one big AdvanceTurns, since either way every due turn is handled in
+//schedule order, so a catch-up can be spread over as many calls as its time budget allows.
+bool Map::AdvanceToTick(int targetTick, double maxSeconds /*= 0.0*/)
+{
+	double startSeconds = GetCurrentTimeSeconds();
+	while (m_currentTick < targetTick)
+	{
+		AdvanceTurns(std::min(TICKS_PER_TURN, targetTick - m_currentTick));
+		if (maxSeconds > 0.0 && GetCurrentTimeSeconds() - startSeconds >= maxSeconds)
+			break;
+	}
+
+	return m_currentTick >= targetTick;
+}
+
+void Map::WakeCharacter(Character* character)
+{
+	if (!character->m_isDormant)
+		return;
+
+	m_dormantCharacters.erase(std::find(m_dormantCharacters.begin(), m_dormantCharacters.end(), character->m_handle));
+	ResumeDormantCharacter(character);
+}
+
+//Covers where every character stands, its health and whether it sleeps, and how many items lie on each tile
+unsigned long long Map::CalculateStateHash(unsigned long long stateHash) const
+{
+	stateHash = HashBytes(stateHash, &m_currentTick, sizeof(m_currentTick));
+	for (int tileIndex = 0; tileIndex < (int)m_tiles.size(); tileIndex++)
+	{
+		const Tile& tile = m_tiles[tileIndex];
+		int numItemsOnTile = (int)tile.m_tileInventory.m_items.size();
+		if (!tile.m_occupyingCharacter && numItemsOnTile == 0)
+			continue;
+
+		stateHash = HashBytes(stateHash, &tileIndex, sizeof(tileIndex));
+		stateHash = HashBytes(stateHash, &numItemsOnTile, sizeof(numItemsOnTile));
+
+		const Character* character = tile.m_occupyingCharacter;
+		if (character)
+		{
+			int numItemsCarried = (int)character->m_entityInventory.m_items.size();
+			stateHash = HashBytes(stateHash, character->m_name.data(), character->m_name.size());
+			stateHash = HashBytes(stateHash, &character->m_currentHP, sizeof(character->m_currentHP));
+			stateHash = HashBytes(stateHash, &character->m_isDormant, sizeof(character->m_isDormant));
+			stateHash = HashBytes(stateHash, &numItemsCarried, sizeof(numItemsCarried));
+		}
+	}
+
+	return stateHash;
+}
+
+bool Map::IsSimulationLodActive() const
+{
+	//With no player here there is nobody to measure distance from, so nobody new falls asleep and nobody asleep wakes up
+	Character* player = GetPlayer();
+	return SIMULATION_ACTIVE_RADIUS > 0 && player && player->m_currentMap == this;
+}
+
+bool Map::ShouldCharacterSleep(const Character& character) const
+{
+	if (!IsSimulationLodActive() || character.GetTarget() || character.m_currentTile->m_isVisibleToPlayer)
+		return false;
+
+	IntVector2 displacementToPlayer = GetPlayer()->m_currentTile->m_tileCoords - character.m_currentTile->m_tileCoords;
+	int distanceSquared = (displacementToPlayer.x * displacementToPlayer.x) + (displacementToPlayer.y * displacementToPlayer.y);
+	return distanceSquared > SIMULATION_ACTIVE_RADIUS * SIMULATION_ACTIVE_RADIUS;
+}
+
+void Map::ResumeDormantCharacter(Character* character)
+{
+	//It acts as soon as the current tick is processed, picking up whatever path it was following when it fell asleep
+	character->m_isDormant = false;
+	m_turnScheduler.Schedule(character->m_handle, m_currentTick);
+	m_lodStats.m_numWoken++;
+}
+
+void Map::PutCharacterToSleep(Character* character)
+{
+	character->m_isDormant = true;
+	m_dormantCharacters.push_back(character->m_handle);
+	m_lodStats.m_numPutToSleep++;
+}
+
+void Map::WakeDormantCharactersNearPlayer()
+{
+	bool isLodActive = IsSimulationLodActive();
+
+	size_t numStillDormant = 0;
+	for (size_t dormantIndex = 0; dormantIndex < m_dormantCharacters.size(); dormantIndex++)
+	{
+		//Characters that died in their sleep are dropped
+		Character* dormantCharacter = GetCharacter(m_dormantCharacters[dormantIndex]);
+		if (!dormantCharacter)
+			continue;
+
+		if (isLodActive && !ShouldCharacterSleep(*dormantCharacter))
+		{
+			ResumeDormantCharacter(dormantCharacter);
+			continue;
+		}
+
+		m_dormantCharacters[numStillDormant] = m_dormantCharacters[dormantIndex];
+		numStillDormant++;
+	}
+
+	m_dormantCharacters.resize(numStillDormant);
+}
+
+bool Map::ResolvePlannedAction(Character* actingCharacter, const PlannedAction& action)
+{
+	switch (action.m_type)
 	{
-		m_entities[entityIndex]->AdvanceTurn();
+	case PLANNED_ACTION_MOVE:
+	{
+		//Paths only ever step to a neighbor. A destination anywhere else comes from a path that went stale under the
+		//character, so the behaviors start over rather than letting it jump there.
+		if (!action.m_destinationTile || CalculateManhattanDistance(*actingCharacter->m_currentTile, *action.m_destinationTile) != 1)
+		{
+			actingCharacter->InvalidateBehaviorPaths();
+			return false;
+		}
+
+		//Someone else stepped onto the destination after this character decided to go there. It waits for its next turn
+		//rather than attacking whoever that turned out to be.
+		Character* occupyingCharacter = action.m_destinationTile->m_occupyingCharacter;
+		if (occupyingCharacter && occupyingCharacter->m_handle != action.m_expectedOccupant)
+			return false;
+
+		return TryToMoveCharacterToTile(actingCharacter, action.m_destinationTile);
+	}
+	case PLANNED_ACTION_ATTACK:
+	{
+		Character* target = GetCharacter(action.m_target);
+		if (!target || CalculateManhattanDistance(*actingCharacter->m_currentTile, *target->m_currentTile) > 1)
+			return false;
+
+		actingCharacter->Attack(target, m_random);
+		return true;
+	}
+	case PLANNED_ACTION_REST:
+	default:
+		actingCharacter->Rest();
+		return true;
 	}
 }
 
 int Map::CalculateTileIndexFromTileCoords(const IntVector2& tileCoords) const
 {
-	return tileCoords.y * m_definition->m_dimensions.x + tileCoords.x;
+	return (tileCoords.y + 1) * m_tileStride + (tileCoords.x + 1);
 }
 
 IntVector2 Map::CalculateTileCoordsFromTileIndex(int tileIndex) const
 {
-	return IntVector2(tileIndex % m_definition->m_dimensions.x, tileIndex / m_definition->m_dimensions.x);
+	return IntVector2((tileIndex % m_tileStride) - 1, (tileIndex / m_tileStride) - 1);
 }
 
 IntVector2 Map::CalculateTileCoordsFromMapCoords(const Vector2& mapCoords) const
@@ -252,52 +527,100 @@ Tile* Map::GetTileAtTileIndex(int tileIndex)
 
 Tile* Map::GetRandomTile()
 {
-	IntVector2 randomTileCoords(GetRandomIntLessThan(m_definition->m_dimensions.x), GetRandomIntLessThan(m_definition->m_dimensions.y));
+	IntVector2 randomTileCoords(m_random.GetRandomIntLessThan(m_definition->m_dimensions.x), m_random.GetRandomIntLessThan(m_definition->m_dimensions.y));
 	return GetTileAtTileCoords(randomTileCoords);
 }
 
 Tile* Map::GetRandomTraversableTile()
 {
-	Tile* randomTile = GetRandomTile();
-	int counter = 0;
-	int maxAttempts = 1000;
-	while (randomTile->m_tileDefinition->m_isSolid || randomTile->m_occupyingCharacter != nullptr || (randomTile->m_occupyingFeature != nullptr && randomTile->m_occupyingFeature->m_isSolid))
-	{
-		if (counter >= maxAttempts)
-			return nullptr;
+	return GetRandomTraversableTile(Tags());
+}
 
-		randomTile = GetRandomTile();
-		counter++;
-	}
-	return randomTile;
+Tile* Map::GetRandomTraversableTile(const Tags& movementTags)
+{
+	return GetRandomTraversableTile(movementTags, m_random);
+}
+
+Tile* Map::GetRandomTraversableTile(const Tags& movementTags, RandomStream& random)
+{
+	MovementClassIndex& movementClass = GetMovementClassIndex(movementTags);
+	if (movementClass.m_freeTraversableTiles.IsEmpty())
+		return nullptr;
+
+	return &m_tiles[movementClass.m_freeTraversableTiles.GetRandomTileIndex(random)];
 }
 
 Tile* Map::GetRandomTileOfType(std::string tileType)
 {
-	Tile* randomTile = GetRandomTile();
-	int counter = 0;
-	int maxAttempts = 1000;
-	while (randomTile->m_tileDefinition->m_name != tileType || randomTile->m_occupyingCharacter != nullptr || (randomTile->m_occupyingFeature != nullptr && randomTile->m_occupyingFeature->m_isSolid))
+	const TileIndexSet* tilesOfType = GetTileIndicesOfType(TileDefinition::GetTileDefinition(tileType));
+	if (!tilesOfType || tilesOfType->IsEmpty())
+		return nullptr;
+
+	//Most tiles of a type are free, so a few random picks almost always succeed before falling back to a pass over the type
+	int maxAttempts = 8;
+	for (int attemptIndex = 0; attemptIndex < maxAttempts; attemptIndex++)
 	{
-		if (counter >= maxAttempts)
-			return nullptr;
+		Tile* randomTile = &m_tiles[tilesOfType->GetRandomTileIndex(m_random)];
+		if (IsTileUnoccupied(*randomTile))
+			return randomTile;
+	}
 
-		randomTile = GetRandomTile();
-		counter++;
+	std::vector<Tile*> unoccupiedTiles;
+	for (int tileIndex : tilesOfType->GetTileIndices())
+	{
+		if (IsTileUnoccupied(m_tiles[tileIndex]))
+			unoccupiedTiles.push_back(&m_tiles[tileIndex]);
 	}
-	return randomTile;
+
+	if (unoccupiedTiles.empty())
+		return nullptr;
+
+	return unoccupiedTiles[m_random.GetRandomIntLessThan(unoccupiedTiles.size())];
 }
 
-Tile* Map::GetRandomTileWithTags(std::string tags)
+Tile* Map::GetRandomTileWithTags(std::string tags, RandomStream& random)
 {
+	//Narrow the search to the smallest index of the required tags, then filter by the full tag query
+	std::vector<std::string> queryTags = Split(tags, ',');
+	const TileIndexSet* smallestTagIndex = nullptr;
+	for (std::string queryTag : queryTags)
+	{
+		if (queryTag.empty() || queryTag[0] == '!')
+			continue;
+
+		const TileIndexSet* tagIndex = GetTileIndicesWithTag(queryTag);
+		if (!tagIndex || tagIndex->IsEmpty())
+			return nullptr;
+
+		if (!smallestTagIndex || tagIndex->GetSize() < smallestTagIndex->GetSize())
+			smallestTagIndex = tagIndex;
+	}
+
+	if (smallestTagIndex && queryTags.size() == 1)
+		return &m_tiles[smallestTagIndex->GetRandomTileIndex(random)];
+
 	std::vector<Tile*> tilesWithTags;
-	for (size_t tileIndex = 0; tileIndex < m_tiles.size(); tileIndex++)
+	if (smallestTagIndex)
 	{
-		if (m_tiles[tileIndex].m_tags.MatchTags(tags))
-			tilesWithTags.push_back(&m_tiles[tileIndex]);
+		for (int tileIndex : smallestTagIndex->GetTileIndices())
+		{
+			if (m_tiles[tileIndex].m_tags.MatchTags(tags))
+				tilesWithTags.push_back(&m_tiles[tileIndex]);
+		}
+	}
+	else
+	{
+		for (size_t tileIndex = 0; tileIndex < m_tiles.size(); tileIndex++)
+		{
+			if (!m_tiles[tileIndex].IsMapBorder() && m_tiles[tileIndex].m_tags.MatchTags(tags))
+				tilesWithTags.push_back(&m_tiles[tileIndex]);
+		}
 	}
 
-	int randomTileIndex = GetRandomIntLessThan(tilesWithTags.size());
+	if (tilesWithTags.empty())
+		return nullptr;
+
+	int randomTileIndex = random.GetRandomIntLessThan(tilesWithTags.size());
 	return tilesWithTags[randomTileIndex];
 }
 
@@ -322,7 +645,7 @@ bool Map::TryToMoveCharacterToTile(Character* characterToMove, Tile* destination
 
 	if (destinationTile->m_occupyingCharacter)
 	{
-		characterToMove->Attack(destinationTile->m_occupyingCharacter);
+		characterToMove->Attack(destinationTile->m_occupyingCharacter, m_random);
 		return false;
 	}
 
@@ -333,25 +656,19 @@ bool Map::TryToMoveCharacterToTile(Character* characterToMove, Tile* destination
 	{
 		if (destinationTile->m_occupyingFeature->m_isSolid)
 			return false;
-		else if(destinationTile->m_occupyingFeature->m_isExit && characterToMove == g_theApp->m_game->m_theWorld->m_thePlayer)
+		else if(destinationTile->m_occupyingFeature->m_isExit && characterToMove == GetPlayer())
 		{
-			if (destinationTile->m_occupyingFeature->m_exitData.m_destinationTile->m_containingMap != this)
+			Tile* exitDestinationTile = m_world->ResolveExit(destinationTile->m_occupyingFeature);
+			if (exitDestinationTile && exitDestinationTile->m_containingMap != this)
 			{
-				int characterToMoveIndex = -1;
-				for (size_t entityIndex = 0; entityIndex < m_entities.size(); entityIndex++)
-				{
-					if (m_entities[entityIndex] == characterToMove)
-					{
-						characterToMoveIndex = (int)entityIndex;
-						break;
-					}
-				}
-				if(characterToMoveIndex >= 0)
-					m_entities.erase(m_entities.begin() + characterToMoveIndex);
+				RemoveEntityFromMap(characterToMove);
+				characterToMove->SetTarget(nullptr);
+				characterToMove->m_visibleCharacters.clear();
 
-				g_theApp->m_game->m_theWorld->m_currentMap = destinationTile->m_occupyingFeature->m_exitData.m_destinationTile->m_containingMap;
+				m_world->ChangeCurrentMap(exitDestinationTile->m_containingMap);
 				characterToMove->m_currentTile->m_occupyingCharacter = nullptr;
-				destinationTile->m_occupyingFeature->m_exitData.m_destinationTile->m_containingMap->PlaceCharacterInMap(characterToMove, destinationTile->m_occupyingFeature->m_exitData.m_destinationTile);
+				RefreshTileAvailability(*characterToMove->m_currentTile);
+				exitDestinationTile->m_containingMap->PlaceCharacterInMap(characterToMove, exitDestinationTile);
 			}
 			else
 			{
@@ -371,13 +688,13 @@ bool Map::TryToMoveCharacterToTile(Character* characterToMove, Tile* destination
 
 void Map::SpawnActors()
 {
-	Character* pixie = CharacterBuilder::BuildNewCharacter("pixie");
+	Character* pixie = CharacterBuilder::BuildNewCharacter("pixie", m_random);
 	PlaceCharacterInMap(pixie, GetRandomTraversableTile());
 
-	Character* pixie2 = CharacterBuilder::BuildNewCharacter("pixie");
+	Character* pixie2 = CharacterBuilder::BuildNewCharacter("pixie", m_random);
 	PlaceCharacterInMap(pixie2, GetRandomTraversableTile());
 
-	Character* pixie3 = CharacterBuilder::BuildNewCharacter("pixie");
+	Character* pixie3 = CharacterBuilder::BuildNewCharacter("pixie", m_random);
 	PlaceCharacterInMap(pixie3, GetRandomTraversableTile());
 }
 
@@ -518,19 +835,21 @@ std::vector<Character *> Map::FindAllCharacters()
 
 Tile* Map::FindNearestTileOfType(const IntVector2& startingPosition, std::string type)
 {
+	const TileIndexSet* tilesOfType = GetTileIndicesOfType(TileDefinition::GetTileDefinition(type));
+	if (!tilesOfType)
+		return nullptr;
+
 	Tile* startingTile = GetTileAtTileCoords(startingPosition);
 	Tile* nearestTile = nullptr;
 	int distanceToNearestTile = INT_MAX;
-	for (Tile& tile : m_tiles)
+	for (int tileIndex : tilesOfType->GetTileIndices())
 	{
-		if (tile.m_tileDefinition->m_name == type)
+		Tile& tile = m_tiles[tileIndex];
+		int distanceToTile = CalculateManhattanDistance(*startingTile, tile);
+		if (distanceToTile < distanceToNearestTile)
 		{
-			int distanceToTile = CalculateManhattanDistance(*startingTile, tile);
-			if (distanceToTile < distanceToNearestTile)
-			{
-				distanceToNearestTile = distanceToTile;
-				nearestTile = &tile;
-			}
+			distanceToNearestTile = distanceToTile;
+			nearestTile = &tile;
 		}
 	}
 
@@ -544,7 +863,7 @@ Tile* Map::FindNearestTileNotOfType(const IntVector2& startingPosition, std::str
 	int distanceToNearestTile = INT_MAX;
 	for (Tile& tile : m_tiles)
 	{
-		if (tile.m_tileDefinition->m_name != type)
+		if (!tile.IsMapBorder() && tile.m_tileDefinition->m_name != type)
 		{
 			int distanceToTile = CalculateManhattanDistance(*startingTile, tile);
 			if (distanceToTile < distanceToNearestTile)
@@ -567,19 +886,12 @@ void Map::SpawnFeatures()
 
 void Map::DestroyCharacter(Character* characterToKill)
 {
-	for (Character* character : FindAllCharacters())
-	{
-		if (character->m_visibleCharacters.count(characterToKill) != 0)
-		{
-			character->m_visibleCharacters.erase(characterToKill);
-		}
-
-		if (character->m_target == characterToKill)
-			character->m_target = nullptr;
-	}
+	if (characterToKill->m_isDormant)
+		m_dormantCharacters.erase(std::find(m_dormantCharacters.begin(), m_dormantCharacters.end(), characterToKill->m_handle));
 
 	Tile* tileContainingCharacterToKill = characterToKill->m_currentTile;
 	tileContainingCharacterToKill->m_occupyingCharacter = nullptr;
+	RefreshTileAvailability(*tileContainingCharacterToKill);
 
 	DestroyEntity(characterToKill);
 }
@@ -588,6 +900,7 @@ void Map::DestroyFeature(Feature* featureToDestroy)
 {
 	Tile* tileContainingFeatureToDestroy = featureToDestroy->m_currentTile;
 	tileContainingFeatureToDestroy->m_occupyingFeature = nullptr;
+	RefreshTileAvailability(*tileContainingFeatureToDestroy);
 
 	DestroyEntity(featureToDestroy);
 }
@@ -617,8 +930,16 @@ void Map::PlaceCharacterInMap(Character* characterToPlace, Tile* destinationTile
 		return;
 
 	destinationTile->m_occupyingCharacter = characterToPlace;
+	RefreshTileAvailability(*destinationTile);
 
 	PlaceEntityInMap(characterToPlace, destinationTile);
+	if (characterToPlace != GetPlayer())
+		ScheduleNextAction(characterToPlace, m_currentTick);
+}
+
+void Map::ScheduleNextAction(Character* character, int fromTick)
+{
+	m_turnScheduler.Schedule(character->m_handle, fromTick + character->CalculateActionTicks());
 }
 
 void Map::PlaceFeatureInMap(Feature* featureToPlace, Tile* destinationTile)
@@ -627,6 +948,7 @@ void Map::PlaceFeatureInMap(Feature* featureToPlace, Tile* destinationTile)
 		return;
 
 	destinationTile->m_occupyingFeature = featureToPlace;
+	RefreshTileAvailability(*destinationTile);
 
 	PlaceEntityInMap(featureToPlace, destinationTile);
 }
@@ -635,13 +957,7 @@ void Map::DestroyEntity(Entity* entityToDestroy)
 {
 	entityToDestroy->m_entityInventory.TransferItemsToOtherInventory(entityToDestroy->m_currentTile->m_tileInventory);
 
-	size_t entityIndex = 0;
-	for (; entityIndex < m_entities.size(); entityIndex++)
-	{
-		if (m_entities[entityIndex] == entityToDestroy)
-			break;
-	}
-	m_entities.erase(m_entities.begin() + entityIndex);
+	RemoveEntityFromMap(entityToDestroy);
 
 	delete entityToDestroy;
 	entityToDestroy = nullptr;
@@ -651,18 +967,200 @@ void Map::PlaceEntityInMap(Entity* entityToPlace, Tile* destinationTile)
 {
 	entityToPlace->m_currentMap = this;
 	entityToPlace->m_currentTile = destinationTile;
+
+	unsigned int slotIndex;
+	if (!m_freeEntitySlots.empty())
+	{
+		slotIndex = m_freeEntitySlots.back();
+		m_freeEntitySlots.pop_back();
+	}
+	else
+	{
+		slotIndex = m_entitySlots.size();
+		m_entitySlots.push_back(EntitySlot());
+	}
+
+	m_entitySlots[slotIndex].m_denseIndex = m_entities.size();
+	entityToPlace->m_handle = EntityHandle(slotIndex, m_entitySlots[slotIndex].m_generation);
 	m_entities.push_back(entityToPlace);
 }
 
+void Map::RemoveEntityFromMap(Entity* entityToRemove)
+{
+	EntitySlot& slot = m_entitySlots[entityToRemove->m_handle.m_index];
+	ASSERT_OR_DIE(m_entities[slot.m_denseIndex] == entityToRemove, "Entity handle does not match the entity being removed.");
+
+	//Swap the last entity into the hole and repoint its slot
+	Entity* lastEntity = m_entities.back();
+	m_entities[slot.m_denseIndex] = lastEntity;
+	m_entitySlots[lastEntity->m_handle.m_index].m_denseIndex = slot.m_denseIndex;
+	m_entities.pop_back();
+
+	slot.m_denseIndex = -1;
+	slot.m_generation++;
+	m_freeEntitySlots.push_back(entityToRemove->m_handle.m_index);
+	entityToRemove->m_handle = EntityHandle();
+}
+
 void Map::MoveCharacterToTile(Character* characterToMove, Tile* destinationTile)
 {
 	Tile* startTile = characterToMove->m_currentTile;
 	startTile->m_occupyingCharacter = nullptr;
 	destinationTile->m_occupyingCharacter = characterToMove;
+	RefreshTileAvailability(*startTile);
+	RefreshTileAvailability(*destinationTile);
 
 	characterToMove->m_currentTile = destinationTile;
 }
 
+//Keeps chunks streaming in ahead of the player and slides the window once the player nears its edge. Nothing here waits
+//on a chunk: if the chunks under the new window are not resident yet, the slide is simply retried next turn.
+void Map::UpdateOverworldWindow()
+{
+	Character* player = GetPlayer();
+	if (!player || player->m_currentMap != this)
+		return;
+
+	IntVector2 dimensions = m_definition->m_dimensions;
+	IntVector2 playerWorldCoords = m_overworldOrigin + player->m_currentTile->m_tileCoords;
+	m_overworldStreamer->RequestChunksAround(playerWorldCoords, m_overworldStreamer->GetWindowRadiusInChunks() + m_overworldStreamer->m_generator->m_prefetchRadius);
+
+	IntVector2 playerTileCoords = player->m_currentTile->m_tileCoords;
+	int edgeMargin = std::min(m_overworldStreamer->m_chunkSize, std::min(dimensions.x, dimensions.y) / 4);
+	bool isNearEdge = playerTileCoords.x < edgeMargin || playerTileCoords.y < edgeMargin
+		|| playerTileCoords.x >= dimensions.x - edgeMargin || playerTileCoords.y >= dimensions.y - edgeMargin;
+	if (isNearEdge)
+		TryToRecenterOverworldWindow(playerWorldCoords - IntVector2(dimensions.x / 2, dimensions.y / 2));
+
+	m_overworldStreamer->EnforceMemoryBudget(m_overworldOrigin + IntVector2(dimensions.x / 2, dimensions.y / 2));
+}
+
+bool Map::TryToRecenterOverworldWindow(const IntVector2& newOrigin)
+{
+	IntVector2 newMaxs = newOrigin + m_definition->m_dimensions - IntVector2(1, 1);
+	if (!m_overworldStreamer->AreChunksResident(newOrigin, newMaxs))
+		return false;
+
+	ShiftOverworldWindow(newOrigin);
+	return true;
+}
+
+//Tiles take their new types from resident chunks, and everything standing on the map moves with the world. Entities and
+//items that end up outside the window are stashed with the streamer, and come back when the window reaches them again.
+//Tile pointers now name different world tiles, so every character's behaviors drop their paths and targets.
+void Map::ShiftOverworldWindow(const IntVector2& newOrigin)
+{
+	IntVector2 dimensions = m_definition->m_dimensions;
+	IntVector2 shift = newOrigin - m_overworldOrigin;
+
+	std::vector<Character*> characters(m_tiles.size(), nullptr);
+	std::vector<Feature*> features(m_tiles.size(), nullptr);
+	std::vector<std::vector<Item*>> items(m_tiles.size());
+	std::vector<bool> hasBeenSeen(m_tiles.size(), false);
+	for (size_t tileIndex = 0; tileIndex < m_tiles.size(); tileIndex++)
+	{
+		Tile& tile = m_tiles[tileIndex];
+		if (tile.IsMapBorder())
+			continue;
+
+		characters[tileIndex] = tile.m_occupyingCharacter;
+		features[tileIndex] = tile.m_occupyingFeature;
+		items[tileIndex].swap(tile.m_tileInventory.m_items);
+		hasBeenSeen[tileIndex] = tile.m_hasBeenSeenByPlayer;
+		tile.m_occupyingCharacter = nullptr;
+		tile.m_occupyingFeature = nullptr;
+		tile.m_hasBeenSeenByPlayer = false;
+		tile.m_isVisibleToPlayer = false;
+	}
+
+	for (int yIndex = 0; yIndex < dimensions.y; yIndex++)
+	{
+		for (int xIndex = 0; xIndex < dimensions.x; xIndex++)
+		{
+			IntVector2 tileCoords(xIndex, yIndex);
+			TileTypeID tileType = 0;
+			m_overworldStreamer->TryGetTileType(newOrigin + tileCoords, tileType);
+
+			Tile& tile = m_tiles[CalculateTileIndexFromTileCoords(tileCoords)];
+			TileDefinition* tileDefinition = TileDefinition::GetTileDefinition(tileType);
+			if (tile.m_tileDefinition != tileDefinition)
+				tile.ChangeType(tileDefinition, m_random);
+			tile.m_permanence = m_overworldStreamer->m_generator->m_permanence;
+		}
+	}
+
+	for (size_t tileIndex = 0; tileIndex < m_tiles.size(); tileIndex++)
+	{
+		if (m_tiles[tileIndex].IsMapBorder())
+			continue;
+
+		IntVector2 newCoords = m_tiles[tileIndex].m_tileCoords - shift;
+		Tile* newTile = IsInMap(newCoords) ? GetTileAtTileCoords(newCoords) : nullptr;
+		if (newTile)
+		{
+			newTile->m_occupyingCharacter = characters[tileIndex];
+			newTile->m_occupyingFeature = features[tileIndex];
+			newTile->m_tileInventory.m_items.swap(items[tileIndex]);
+			newTile->m_hasBeenSeenByPlayer = hasBeenSeen[tileIndex];
+			if (characters[tileIndex])
+				characters[tileIndex]->m_currentTile = newTile;
+			if (features[tileIndex])
+				features[tileIndex]->m_currentTile = newTile;
+			continue;
+		}
+
+		if (!characters[tileIndex] && !features[tileIndex] && items[tileIndex].empty())
+			continue;
+
+		OverworldStashedTile stashedTile;
+		stashedTile.m_worldTileCoords = m_overworldOrigin + m_tiles[tileIndex].m_tileCoords;
+		stashedTile.m_character = characters[tileIndex];
+		stashedTile.m_feature = features[tileIndex];
+		stashedTile.m_items.swap(items[tileIndex]);
+		if (stashedTile.m_character)
+		{
+			Character* character = stashedTile.m_character;
+			if (character->m_isDormant)
+			{
+				m_dormantCharacters.erase(std::find(m_dormantCharacters.begin(), m_dormantCharacters.end(), character->m_handle));
+				character->m_isDormant = false;
+			}
+			RemoveEntityFromMap(character);
+			character->m_currentTile = nullptr;
+		}
+		if (stashedTile.m_feature)
+		{
+			RemoveEntityFromMap(stashedTile.m_feature);
+			stashedTile.m_feature->m_currentTile = nullptr;
+		}
+		m_overworldStreamer->StashTile(stashedTile);
+	}
+
+	//Nothing can have moved onto a stashed tile's spot while it was outside the window, since nothing outside the window moves
+	std::vector<OverworldStashedTile> returningTiles;
+	m_overworldStreamer->TakeStashedTiles(newOrigin, newOrigin + dimensions - IntVector2(1, 1), returningTiles);
+	for (OverworldStashedTile& returningTile : returningTiles)
+	{
+		Tile* tile = GetTileAtTileCoords(returningTile.m_worldTileCoords - newOrigin);
+		if (returningTile.m_character)
+			PlaceCharacterInMap(returningTile.m_character, tile);
+		if (returningTile.m_feature)
+			PlaceFeatureInMap(returningTile.m_feature, tile);
+		tile->m_tileInventory.m_items.insert(tile->m_tileInventory.m_items.end(), returningTile.m_items.begin(), returningTile.m_items.end());
+	}
+
+	for (const Tile& tile : m_tiles)
+	{
+		RefreshTileAvailability(tile);
+		if (tile.m_occupyingCharacter)
+			tile.m_occupyingCharacter->InvalidateBehaviorPaths();
+	}
+
+	delete m_currentPath;
+	m_currentPath = nullptr;
+	m_overworldOrigin = newOrigin;
+}
+
 void Map::UpdateDamageNumbers(float deltaSeconds)
 {
 	size_t numDamageNumbers = m_damageNumbers.size();
@@ -683,6 +1181,7 @@ void Map::UpdateDamageNumbers(float deltaSeconds)
 
 void Map::RenderDamageNumbers() const
 {
+#ifndef ROGUELIKE_HEADLESS
 	for (DamageNumber number : m_damageNumbers)
 	{
 		Rgba fadedColor(number.m_color);
@@ -690,6 +1189,7 @@ void Map::RenderDamageNumbers() const
 		Rgba numberColor = Interpolate(number.m_color, fadedColor, RangeMapFloat(number.m_lifetime, DAMAGE_NUMBER_LIFETIME, 0.f, 0.f, 1.f));
 		g_theRenderer->DrawCenteredText2D(number.m_position, g_theRenderer->m_defaultFont, number.m_number, numberColor, number.m_scale);
 	}
+#endif
 }
 
 std::vector<Tile*> Map::GetTilesInRadius(const IntVector2& tileCoords, float radius)
@@ -718,6 +1218,163 @@ std::vector<Tile*> Map::GetTilesInRadius(const IntVector2& tileCoords, float rad
 	return outVector;
 }
 
+bool Map::IsTileUnoccupied(const Tile& tile) const
+{
+	if (tile.m_occupyingCharacter != nullptr)
+		return false;
+
+	if (tile.m_occupyingFeature != nullptr && tile.m_occupyingFeature->m_isSolid)
+		return false;
+
+	return true;
+}
+
+void Map::RefreshTileAvailability(const Tile& tile)
+{
+	if (tile.IsMapBorder())
+		return;
+
+	int tileIndex = CalculateTileIndexFromTileCoords(tile.m_tileCoords);
+	for (std::map<std::string, MovementClassIndex>::iterator movementClassIter = m_movementClassIndices.begin(); movementClassIter != m_movementClassIndices.end(); ++movementClassIter)
+	{
+		MovementClassIndex& movementClass = movementClassIter->second;
+		if (IsTileFreeForMovementClass(tile, movementClass.m_movementTags))
+			movementClass.m_freeTraversableTiles.Add(tileIndex);
+		else
+			movementClass.m_freeTraversableTiles.Remove(tileIndex);
+	}
+}
+
+//Movement classes are keyed by the mover's tags and built the first time something with those tags asks for a free tile
+MovementClassIndex& Map::GetMovementClassIndex(const Tags& movementTags)
+{
+	std::string movementClassName = movementTags.GetTagsAsString();
+	std::map<std::string, MovementClassIndex>::iterator found = m_movementClassIndices.find(movementClassName);
+	if (found != m_movementClassIndices.end())
+		return found->second;
+
+	MovementClassIndex& movementClass = m_movementClassIndices[movementClassName];
+	movementClass.m_movementTags = movementTags;
+	movementClass.m_freeTraversableTiles.Reset();
+	for (size_t tileIndex = 0; tileIndex < m_tiles.size(); tileIndex++)
+	{
+		if (!m_tiles[tileIndex].IsMapBorder() && IsTileFreeForMovementClass(m_tiles[tileIndex], movementTags))
+			movementClass.m_freeTraversableTiles.Add(tileIndex);
+	}
+
+	return movementClass;
+}
+
+bool Map::IsTileFreeForMovementClass(const Tile& tile, const Tags& movementTags) const
+{
+	return !tile.IsSolidToTags(movementTags) && IsTileUnoccupied(tile);
+}
+
+void Map::OnTileTypeChanged(const Tile& changedTile, const TileDefinition* oldDefinition)
+{
+	if (changedTile.IsMapBorder() || oldDefinition == changedTile.m_tileDefinition)
+		return;
+
+	RefreshTileAvailability(changedTile);
+
+	int tileIndex = CalculateTileIndexFromTileCoords(changedTile.m_tileCoords);
+	if (oldDefinition && oldDefinition->m_typeID < m_tileIndicesByType.size())
+		m_tileIndicesByType[oldDefinition->m_typeID].Remove(tileIndex);
+
+	TileTypeID newTypeID = changedTile.m_tileDefinition->m_typeID;
+	if (newTypeID >= m_tileIndicesByType.size())
+		m_tileIndicesByType.resize(newTypeID + 1);
+
+	m_tileIndicesByType[newTypeID].Add(tileIndex);
+}
+
+void Map::OnTileTagsChanged(const Tile& changedTile, const std::vector<std::string>& oldTags, const std::vector<std::string>& newTags)
+{
+	int tileIndex = CalculateTileIndexFromTileCoords(changedTile.m_tileCoords);
+	for (const std::string& oldTag : oldTags)
+	{
+		if (oldTag.empty() || std::find(newTags.begin(), newTags.end(), oldTag) != newTags.end())
+			continue;
+
+		std::map<std::string, TileIndexSet>::iterator found = m_tileIndicesByTag.find(oldTag);
+		if (found != m_tileIndicesByTag.end())
+			found->second.Remove(tileIndex);
+	}
+
+	for (const std::string& newTag : newTags)
+	{
+		if (newTag.empty() || std::find(oldTags.begin(), oldTags.end(), newTag) != oldTags.end())
+			continue;
+
+		std::map<std::string, TileIndexSet>::iterator found = m_tileIndicesByTag.find(newTag);
+		if (found == m_tileIndicesByTag.end())
+			found = m_tileIndicesByTag.insert(std::make_pair(newTag, TileIndexSet())).first;
+
+		found->second.Add(tileIndex);
+	}
+}
+
+void Map::RebuildTileIndices()
+{
+	//Sets are swap-remove ordered, so rebuild them in tile order to make the result independent of how the tiles were produced
+	m_tileIndicesByType.assign(m_tileIndicesByType.size(), TileIndexSet());
+	m_tileIndicesByTag.clear();
+	m_movementClassIndices.clear();
+
+	std::vector<std::string> noTags;
+	for (size_t tileIndex = 0; tileIndex < m_tiles.size(); tileIndex++)
+	{
+		const Tile& tile = m_tiles[tileIndex];
+		if (tile.IsMapBorder())
+			continue;
+
+		OnTileTypeChanged(tile, nullptr);
+		OnTileTagsChanged(tile, noTags, Split(tile.m_tags.GetTagsAsString(), ','));
+	}
+}
+
+const TileIndexSet* Map::GetTileIndicesOfType(const TileDefinition* tileDefinition) const
+{
+	if (!tileDefinition || tileDefinition->m_typeID >= m_tileIndicesByType.size())
+		return nullptr;
+
+	return &m_tileIndicesByType[tileDefinition->m_typeID];
+}
+
+const TileIndexSet* Map::GetTileIndicesWithTag(const std::string& tag) const
+{
+	std::map<std::string, TileIndexSet>::const_iterator found = m_tileIndicesByTag.find(tag);
+	if (found == m_tileIndicesByTag.end())
+		return nullptr;
+
+	return &found->second;
+}
+
+Entity* Map::GetEntity(const EntityHandle& handle) const
+{
+	if (handle.m_index >= m_entitySlots.size())
+		return nullptr;
+
+	const EntitySlot& slot = m_entitySlots[handle.m_index];
+	if (slot.m_generation != handle.m_generation || slot.m_denseIndex < 0)
+		return nullptr;
+
+	return m_entities[slot.m_denseIndex];
+}
+
+Character* Map::GetCharacter(const EntityHandle& handle) const
+{
+	return static_cast<Character*>(GetEntity(handle));
+}
+
+Character* Map::GetPlayer() const
+{
+	if (m_isInBackground)
+		return nullptr;
+
+	return m_world ? m_world->m_thePlayer : nullptr;
+}
+
 bool Map::IsInMap(const IntVector2& tileCoords) const
 {
 	if (tileCoords.x < 0 || tileCoords.x >= m_definition->m_dimensions.x)
@@ -809,13 +1466,14 @@ RaycastResult Map::RaycastForOpaque(const Vector2& startPosition, const Vector2&
 
 Path Map::GeneratePath(const IntVector2& start, const IntVector2& end, Character* characterForPath /*= nullptr*/)
 {
-	StartSteppedPath(start, end, characterForPath);
+	//Searches on a generator of its own rather than m_currentPath, so characters deciding in parallel can all path at once
+	PathGenerator pathGenerator(start, end, this, characterForPath);
 	Path outPath;
 
 	bool isCompleted = false;
 	while (!isCompleted)
 	{
-		isCompleted = ContinueSteppedPath(outPath);
+		isCompleted = pathGenerator.Step(outPath);
 	}
 
 	return outPath;
@@ -831,24 +1489,6 @@ void Map::StartSteppedPath(const IntVector2& start, const IntVector2& end, Chara
 
 bool Map::ContinueSteppedPath(Path& out_pathWhenComplete)
 {
-	//select and close best open node
-	OpenNode* currentNode = m_currentPath->SelectAndCloseBestOpenNode();
-
-	if (!currentNode)
-		return true;
-
-	//see if goal
-	if (currentNode->m_tile->m_tileCoords == m_currentPath->m_end)
-	{
-		out_pathWhenComplete = m_currentPath->CreateFinalPath(*currentNode);
-		return true;
-	}
-
-	m_currentPath->OpenNodeIfValid(currentNode->m_tile->GetNorthNeighbor(), currentNode);
-	m_currentPath->OpenNodeIfValid(currentNode->m_tile->GetEastNeighbor(), currentNode);
-	m_currentPath->OpenNodeIfValid(currentNode->m_tile->GetSouthNeighbor(), currentNode);
-	m_currentPath->OpenNodeIfValid(currentNode->m_tile->GetWestNeighbor(), currentNode);
-
-	return false;
+	return m_currentPath->Step(out_pathWhenComplete);
 }
 
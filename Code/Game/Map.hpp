@@ -3,17 +3,25 @@
 #include "Game/Tile.hpp"
 #include "Game/Entity.hpp"
 #include "Game/Message.hpp"
+#include "Game/TileIndexSet.hpp"
+#include "Game/GenerationProfiler.hpp"
+#include "Game/TurnScheduler.hpp"
 #include <set>
+#include <map>
+#include <deque>
+#include <unordered_map>
 
 
 typedef std::vector<Tile*> Path;
 
 class MapDefinition;
 class Map;
+class World;
+class OverworldStreamer;
 
 struct DamageNumber
 {
-	DamageNumber::DamageNumber(std::string number, const Vector2& position, const Rgba& color = Rgba::RED, float scale = 0.5f);
+	DamageNumber(std::string number, const Vector2& position, const Rgba& color = Rgba::RED, float scale = 0.5f);
 
 	Rgba m_color;
 	std::string m_number;
@@ -32,6 +40,18 @@ struct RaycastResult
 	std::set<Tile*> m_impactedTiles;
 };
 
+struct EntitySlot
+{
+	unsigned int m_generation = 0;
+	int m_denseIndex = -1;
+};
+
+struct MovementClassIndex
+{
+	Tags m_movementTags;
+	TileIndexSet m_freeTraversableTiles;
+};
+
 struct OpenNode
 {
 	Tile* m_tile;
@@ -42,6 +62,25 @@ struct OpenNode
 	float m_fScore = 0.f;
 };
 
+//How much of the map's population actually simulated during the last AdvanceTurns
+struct SimulationLodStats
+{
+	int m_numActions = 0;				//Character actions planned and applied; a fast character can act more than once
+	int m_numDormant = 0;				//Characters asleep once the call finished
+	int m_numWoken = 0;
+	int m_numPutToSleep = 0;
+};
+
+enum PathTileState : unsigned char
+{
+	PATH_TILE_UNVISITED,
+	PATH_TILE_OPEN,
+	PATH_TILE_CLOSED
+};
+
+//A* search over one map. The generator owns its nodes and its open/closed marks rather than writing them into the tiles,
+//so any number of searches can run on the same map at once as long as nothing changes the map while they do.
+//Only tiles the search has reached get a mark, so a short path on a large map costs no more than the tiles it touches.
 class PathGenerator
 {
 	friend class Map;
@@ -49,17 +88,21 @@ class PathGenerator
 private:
 	PathGenerator(const IntVector2& start, const IntVector2& end, Map* map, Character* gCostReferenceCharacter);
 
+	bool Step(Path& out_pathWhenComplete);
 	void OpenNodeForProcessing(Tile& tileToOpen, OpenNode* parent);
 	OpenNode* SelectAndCloseBestOpenNode();
 	Path CreateFinalPath(OpenNode& endNode);
 	void OpenNodeIfValid(Tile* tileToOpen, OpenNode* parent);
+	PathTileState GetTileState(const Tile& tile) const;
 
 	IntVector2 m_start;
 	IntVector2 m_end;
 	Map* m_map = nullptr;
+	Tile* m_endTile = nullptr;
 	Character* m_gCostReferenceCharacter = nullptr;
+	std::deque<OpenNode> m_nodes;
 	std::vector<OpenNode*> m_openList;
-	int m_pathID;
+	std::unordered_map<int, PathTileState> m_tileStates;
 
 	Path m_finalPath;
 };
@@ -67,7 +110,7 @@ private:
 class Map
 {
 public:
-	Map(std::string mapDefinitionName);
+	Map(std::string mapDefinitionName, unsigned int seed);
 	~Map();
 
 	void Update(float deltaSeconds);
@@ -76,7 +119,12 @@ public:
 	void RenderDebugPathing() const;
 	void RenderDebugGenerating() const;
 
-	void AdvanceTurns();
+	void AdvanceTurns(int elapsedTicks = TICKS_PER_TURN);
+	bool AdvanceToTick(int targetTick, double maxSeconds = 0.0);
+	void ScheduleNextAction(Character* character, int fromTick);
+	bool ResolvePlannedAction(Character* actingCharacter, const PlannedAction& action);
+	void WakeCharacter(Character* character);
+	unsigned long long CalculateStateHash(unsigned long long stateHash) const;
 
 	int CalculateTileIndexFromTileCoords(const IntVector2& tileCoords) const;
 	IntVector2 CalculateTileCoordsFromTileIndex(int tileIndex) const;
@@ -86,10 +134,24 @@ public:
 	Tile* GetTileAtTileIndex(int tileIndex);
 	Tile* FindFirstTraversableTile();
 	Tile* GetRandomTraversableTile();
+	Tile* GetRandomTraversableTile(const Tags& movementTags);
+	Tile* GetRandomTraversableTile(const Tags& movementTags, RandomStream& random);
 	Tile* GetRandomTileOfType(std::string tileType);
-	Tile* GetRandomTileWithTags(std::string m_patrolPointTags);
+	Tile* GetRandomTileWithTags(std::string tags, RandomStream& random);
 	Tile* GetRandomTile();
 	bool IsInMap(const IntVector2& tileCoords) const;
+	bool IsTileUnoccupied(const Tile& tile) const;
+	void RefreshTileAvailability(const Tile& tile);
+
+	void OnTileTypeChanged(const Tile& changedTile, const TileDefinition* oldDefinition);
+	void OnTileTagsChanged(const Tile& changedTile, const std::vector<std::string>& oldTags, const std::vector<std::string>& newTags);
+	void RebuildTileIndices();
+	const TileIndexSet* GetTileIndicesOfType(const TileDefinition* tileDefinition) const;
+	const TileIndexSet* GetTileIndicesWithTag(const std::string& tag) const;
+
+	Entity* GetEntity(const EntityHandle& handle) const;
+	Character* GetCharacter(const EntityHandle& handle) const;
+	Character* GetPlayer() const;
 
 	std::vector<Message> GetTooltipInfoForMapCoords(const Vector2& mapCoords);
 
@@ -124,20 +186,67 @@ public:
 
 	std::string m_name;
 	MapDefinition* m_definition;
+
+	//Set once the map belongs to a world; maps generated on their own (benchmarks, caches) have no world and no player
+	World* m_world = nullptr;
+
+	//Everything random that happens in this map, from spawning to combat, draws from this stream
+	unsigned int m_seed;
+	RandomStream m_random;
 	std::vector<Tile> m_tiles;
+	int m_tileStride;
+	int m_neighborOffsets[NUM_TILE_NEIGHBORS];
 	std::vector<Entity*> m_entities;
+	std::vector<EntitySlot> m_entitySlots;
+	std::vector<unsigned int> m_freeEntitySlots;
 	std::vector<DamageNumber> m_damageNumbers;
+	std::vector<TileIndexSet> m_tileIndicesByType;
+	std::map<std::string, TileIndexSet> m_tileIndicesByTag;
+	std::map<std::string, MovementClassIndex> m_movementClassIndices;
 
 	PathGenerator* m_currentPath = nullptr;
 
+	//Every character but the player waits in the scheduler for the tick its next action is due
+	TurnScheduler m_turnScheduler;
+	int m_currentTick = 0;
+
+	//Set by the world on the main thread for as long as the player is on another map. The player may be changing under it, so
+	//the map acts as if it had no player, and plans on the calling thread to leave the workers to the current map.
+	bool m_isInBackground = false;
+
+	//Dormant characters are out of the scheduler entirely and cost one distance check a turn until something wakes them
+	std::vector<EntityHandle> m_dormantCharacters;
+	SimulationLodStats m_lodStats;
+
+	//One record per generator step that has run on this map, in the order they ran
+	std::vector<GenerationStepRecord> m_generationTimeline;
+	//Set by a generator that gave up and left the map unchanged; the running step's record picks it up
+	bool m_hasGenerationStepFailed = false;
+
+	//Only set for maps built by the Overworld generator. The map is then a window onto an unbounded world, and
+	//m_overworldOrigin is the world tile under tile (0,0).
+	OverworldStreamer* m_overworldStreamer = nullptr;
+	IntVector2 m_overworldOrigin;
+
 	static const float DAMAGE_NUMBER_LIFETIME;
 	std::vector<Character *> FindAllCharacters();
 private:
 	void SpawnFeatures();
 	void DestroyEntity(Entity* entityToKill);
 	void PlaceEntityInMap(Entity* entityToPlace, Tile* destinationTile);
+	void RemoveEntityFromMap(Entity* entityToRemove);
+	MovementClassIndex& GetMovementClassIndex(const Tags& movementTags);
+	bool IsTileFreeForMovementClass(const Tile& tile, const Tags& movementTags) const;
 	void MoveCharacterToTile(Character* characterToMove, Tile* destinationTile);
+	bool IsSimulationLodActive() const;
+	bool ShouldCharacterSleep(const Character& character) const;
+	void PutCharacterToSleep(Character* character);
+	void ResumeDormantCharacter(Character* character);
+	void WakeDormantCharactersNearPlayer();
 	void UpdateDamageNumbers(float deltaSeconds);
 	void RenderDamageNumbers() const;
+	void UpdateOverworldWindow();
+	bool TryToRecenterOverworldWindow(const IntVector2& newOrigin);
+	void ShiftOverworldWindow(const IntVector2& newOrigin);
 
 };
@@ -0,0 +1,266 @@
+#include "Game/MapCache.hpp"
+#include "Game/Map.hpp"
+#include "Game/MapDefinition.hpp"
+#include "Game/BinaryBuffer.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Game/TileDefinition.hpp"
+#include <stdio.h>
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+
+const unsigned int MapCache::FILE_MAGIC = 0x434d4c52;		//"RLMC"
+const unsigned int MapCache::FILE_VERSION = 3;
+std::string MapCache::s_cacheDirectory;
+MapCacheStats MapCache::s_stats;
+std::mutex MapCache::s_statsMutex;
+
+
+struct CachedTile
+{
+	unsigned short m_typeIndex;
+	float m_permanence;
+	char m_glyph;
+	Rgba m_glyphColor;
+	Rgba m_fillColor;
+	std::string m_tags;
+};
+
+//Cached tiles carry the glyphs and colors their definitions gave them, so any change to a tile definition has to miss.
+//Which types a map uses isn't known until it is generated, so every registered definition goes into the key.
+static unsigned long long HashTileDefinitions(unsigned long long hash)
+{
+	for (const std::pair<const std::string, TileDefinition*>& registryEntry : TileDefinition::s_tileDefinitionRegistry)
+	{
+		const TileDefinition* tileDefinition = registryEntry.second;
+		hash = HashBytes(hash, tileDefinition->m_name.data(), tileDefinition->m_name.size());
+		hash = HashBytes(hash, &tileDefinition->m_isSolid, sizeof(tileDefinition->m_isSolid));
+		hash = HashBytes(hash, &tileDefinition->m_isOpaque, sizeof(tileDefinition->m_isOpaque));
+		hash = HashBytes(hash, tileDefinition->m_solidExceptions.data(), tileDefinition->m_solidExceptions.size());
+		hash = HashBytes(hash, tileDefinition->m_glyphs.data(), tileDefinition->m_glyphs.size());
+		hash = HashBytes(hash, tileDefinition->m_glyphColors.data(), tileDefinition->m_glyphColors.size() * sizeof(Rgba));
+		hash = HashBytes(hash, tileDefinition->m_fillColors.data(), tileDefinition->m_fillColors.size() * sizeof(Rgba));
+	}
+
+	return hash;
+}
+
+void MapCache::Initialize(const std::string& cacheDirectory)
+{
+	s_cacheDirectory = cacheDirectory;
+	if (s_cacheDirectory.empty())
+		return;
+
+#if defined(_WIN32)
+	_mkdir(s_cacheDirectory.c_str());
+#else
+	mkdir(s_cacheDirectory.c_str(), 0755);
+#endif
+}
+
+bool MapCache::IsEnabled()
+{
+	return !s_cacheDirectory.empty();
+}
+
+void MapCache::GenerateMap(Map* mapToGenerate)
+{
+	if (!IsEnabled())
+	{
+		mapToGenerate->m_definition->GenerateMap(mapToGenerate);
+		return;
+	}
+
+	unsigned long long key = CalculateKey(*mapToGenerate);
+	double startSeconds = GetCurrentTimeSeconds();
+	if (TryLoadMap(mapToGenerate, key))
+	{
+		double loadSeconds = GetCurrentTimeSeconds() - startSeconds;
+		std::lock_guard<std::mutex> lock(s_statsMutex);
+		s_stats.m_numHits++;
+		s_stats.m_totalLoadSeconds += loadSeconds;
+		return;
+	}
+
+	mapToGenerate->m_definition->GenerateMap(mapToGenerate);
+	double generateSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	//Entities placed by generators would need their own serialization, so those maps are always regenerated.
+	//Overworld maps are cheap to rebuild and need their generator to run to get a streamer, so they are never stored either.
+	if (mapToGenerate->m_entities.empty() && !mapToGenerate->m_overworldStreamer)
+		SaveMap(*mapToGenerate, key);
+
+	std::lock_guard<std::mutex> lock(s_statsMutex);
+	s_stats.m_numMisses++;
+	s_stats.m_totalGenerateSeconds += generateSeconds;
+}
+
+MapCacheStats MapCache::GetStats()
+{
+	std::lock_guard<std::mutex> lock(s_statsMutex);
+	return s_stats;
+}
+
+std::string MapCache::GetStatsString()
+{
+	MapCacheStats stats = GetStats();
+	int numLookups = stats.m_numHits + stats.m_numMisses;
+	float hitRate = 0.f;
+	if (numLookups > 0)
+		hitRate = (float)stats.m_numHits / (float)numLookups;
+
+	char statsString[256];
+	snprintf(statsString, sizeof(statsString), "Map cache: %d hits, %d misses (%.0f%% hit rate), %.2f ms average load, %.2f ms average generate", stats.m_numHits, stats.m_numMisses, hitRate * 100.f,
+		stats.m_numHits > 0 ? (stats.m_totalLoadSeconds * 1000.0) / stats.m_numHits : 0.0,
+		stats.m_numMisses > 0 ? (stats.m_totalGenerateSeconds * 1000.0) / stats.m_numMisses : 0.0);
+	return statsString;
+}
+
+unsigned long long MapCache::CalculateKey(const Map& map)
+{
+	unsigned long long key = HASH_BYTES_START;
+	key = HashBytes(key, &FILE_VERSION, sizeof(FILE_VERSION));
+	key = HashBytes(key, map.m_definition->m_sourceXML.data(), map.m_definition->m_sourceXML.size());
+	for (const MapGenerator* generator : map.m_definition->m_generators)
+	{
+		std::string generatorInputs = generator->GetCacheKeyData();
+		key = HashBytes(key, generatorInputs.data(), generatorInputs.size());
+	}
+	key = HashTileDefinitions(key);
+	key = HashBytes(key, &map.m_seed, sizeof(map.m_seed));
+
+	return key;
+}
+
+std::string MapCache::GetCacheFilePath(const Map& map, unsigned long long key)
+{
+	char keyString[32];
+	snprintf(keyString, sizeof(keyString), "%016llx", key);
+	return s_cacheDirectory + "/" + map.m_definition->m_name + "_" + keyString + ".map";
+}
+
+bool MapCache::TryLoadMap(Map* mapToLoadInto, unsigned long long key)
+{
+	std::string filePath = GetCacheFilePath(*mapToLoadInto, key);
+	std::vector<unsigned char> buffer;
+	if (!ReadFileIntoBuffer(filePath, buffer))
+		return false;
+
+	BinaryBufferReader reader(buffer);
+	unsigned int magic = 0;
+	unsigned int version = 0;
+	unsigned long long fileKey = 0;
+	IntVector2 dimensions;
+	reader.ReadBytes(&magic, sizeof(magic));
+	reader.ReadBytes(&version, sizeof(version));
+	reader.ReadBytes(&fileKey, sizeof(fileKey));
+	reader.ReadBytes(&dimensions.x, sizeof(dimensions.x));
+	reader.ReadBytes(&dimensions.y, sizeof(dimensions.y));
+	if (!reader.IsValid() || magic != FILE_MAGIC || version != FILE_VERSION || fileKey != key || dimensions != mapToLoadInto->m_definition->m_dimensions)
+		return false;
+
+	//Tile types are stored by name so the cache survives reordering Tiles.xml
+	unsigned short numTileTypes = 0;
+	reader.ReadBytes(&numTileTypes, sizeof(numTileTypes));
+	std::vector<TileDefinition*> tileTypes;
+	for (unsigned short typeIndex = 0; typeIndex < numTileTypes; typeIndex++)
+	{
+		TileDefinition* tileDefinition = TileDefinition::GetTileDefinition(reader.ReadString());
+		if (!tileDefinition)
+			return false;
+		tileTypes.push_back(tileDefinition);
+	}
+
+	std::vector<CachedTile> cachedTiles(dimensions.x * dimensions.y);
+	for (CachedTile& cachedTile : cachedTiles)
+	{
+		reader.ReadBytes(&cachedTile.m_typeIndex, sizeof(cachedTile.m_typeIndex));
+		reader.ReadBytes(&cachedTile.m_permanence, sizeof(cachedTile.m_permanence));
+		reader.ReadBytes(&cachedTile.m_glyph, sizeof(cachedTile.m_glyph));
+		cachedTile.m_glyphColor = reader.ReadRgba();
+		cachedTile.m_fillColor = reader.ReadRgba();
+		cachedTile.m_tags = reader.ReadString();
+		if (cachedTile.m_typeIndex >= tileTypes.size())
+			return false;
+	}
+
+	if (!reader.IsValid())
+		return false;
+
+	//Glyphs and colors come from the file, so changing type must not draw from the map's own stream
+	RandomStream scratchRandom;
+	for (int yIndex = 0; yIndex < dimensions.y; yIndex++)
+	{
+		for (int xIndex = 0; xIndex < dimensions.x; xIndex++)
+		{
+			const CachedTile& cachedTile = cachedTiles[(yIndex * dimensions.x) + xIndex];
+			Tile& tile = mapToLoadInto->m_tiles[mapToLoadInto->CalculateTileIndexFromTileCoords(IntVector2(xIndex, yIndex))];
+			if (tile.m_tileDefinition != tileTypes[cachedTile.m_typeIndex])
+				tile.ChangeType(tileTypes[cachedTile.m_typeIndex], scratchRandom);
+
+			tile.m_permanence = cachedTile.m_permanence;
+			tile.m_glyph = cachedTile.m_glyph;
+			tile.m_glyphColor = cachedTile.m_glyphColor;
+			tile.m_fillColor = cachedTile.m_fillColor;
+			if (tile.m_tags.GetTagsAsString() != cachedTile.m_tags)
+				tile.SetTags(cachedTile.m_tags);
+		}
+	}
+
+	mapToLoadInto->RebuildTileIndices();
+	return true;
+}
+
+void MapCache::SaveMap(const Map& generatedMap, unsigned long long key)
+{
+	IntVector2 dimensions = generatedMap.m_definition->m_dimensions;
+
+	std::vector<const TileDefinition*> tileTypes;
+	std::map<const TileDefinition*, unsigned short> tileTypeIndices;
+	for (int yIndex = 0; yIndex < dimensions.y; yIndex++)
+	{
+		for (int xIndex = 0; xIndex < dimensions.x; xIndex++)
+		{
+			const TileDefinition* tileDefinition = generatedMap.m_tiles[generatedMap.CalculateTileIndexFromTileCoords(IntVector2(xIndex, yIndex))].m_tileDefinition;
+			if (tileTypeIndices.find(tileDefinition) == tileTypeIndices.end())
+			{
+				tileTypeIndices[tileDefinition] = (unsigned short)tileTypes.size();
+				tileTypes.push_back(tileDefinition);
+			}
+		}
+	}
+
+	std::vector<unsigned char> buffer;
+	WriteBytes(buffer, &FILE_MAGIC, sizeof(FILE_MAGIC));
+	WriteBytes(buffer, &FILE_VERSION, sizeof(FILE_VERSION));
+	WriteBytes(buffer, &key, sizeof(key));
+	WriteBytes(buffer, &dimensions.x, sizeof(dimensions.x));
+	WriteBytes(buffer, &dimensions.y, sizeof(dimensions.y));
+
+	unsigned short numTileTypes = (unsigned short)tileTypes.size();
+	WriteBytes(buffer, &numTileTypes, sizeof(numTileTypes));
+	for (const TileDefinition* tileDefinition : tileTypes)
+	{
+		WriteString(buffer, tileDefinition->m_name);
+	}
+
+	for (int yIndex = 0; yIndex < dimensions.y; yIndex++)
+	{
+		for (int xIndex = 0; xIndex < dimensions.x; xIndex++)
+		{
+			const Tile& tile = generatedMap.m_tiles[generatedMap.CalculateTileIndexFromTileCoords(IntVector2(xIndex, yIndex))];
+			unsigned short typeIndex = tileTypeIndices[tile.m_tileDefinition];
+			WriteBytes(buffer, &typeIndex, sizeof(typeIndex));
+			WriteBytes(buffer, &tile.m_permanence, sizeof(tile.m_permanence));
+			WriteBytes(buffer, &tile.m_glyph, sizeof(tile.m_glyph));
+			WriteRgba(buffer, tile.m_glyphColor);
+			WriteRgba(buffer, tile.m_fillColor);
+			WriteString(buffer, tile.m_tags.GetTagsAsString());
+		}
+	}
+
+	WriteBufferToFile(GetCacheFilePath(generatedMap, key), buffer);
+}
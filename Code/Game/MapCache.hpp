@@ -0,0 +1,42 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <mutex>
+
+
+class Map;
+
+struct MapCacheStats
+{
+	int m_numHits = 0;
+	int m_numMisses = 0;
+	double m_totalLoadSeconds = 0.0;
+	double m_totalGenerateSeconds = 0.0;
+};
+
+//On-disk cache of generated maps. A map is keyed by a hash of its MapDefinition XML, the generators' external inputs, the tile definitions and its seed,
+//so a hit gives exactly the tiles the generators would have produced. Maps whose generators spawn entities are never cached.
+class MapCache
+{
+public:
+	static void Initialize(const std::string& cacheDirectory);
+	static bool IsEnabled();
+
+	//Loads the map from the cache if it is there, otherwise runs its generators and stores the result
+	static void GenerateMap(Map* mapToGenerate);
+
+	static MapCacheStats GetStats();
+	static std::string GetStatsString();
+
+	static const unsigned int FILE_MAGIC;
+	static const unsigned int FILE_VERSION;
+private:
+	static unsigned long long CalculateKey(const Map& map);
+	static std::string GetCacheFilePath(const Map& map, unsigned long long key);
+	static bool TryLoadMap(Map* mapToLoadInto, unsigned long long key);
+	static void SaveMap(const Map& generatedMap, unsigned long long key);
+
+	static std::string s_cacheDirectory;
+	static MapCacheStats s_stats;
+	static std::mutex s_statsMutex;
+};
@@ -11,6 +11,11 @@ MapDefinition::MapDefinition(XMLNode element)
 	m_name = ParseXMLAttributeString(element, "name", "ERROR_INVALID_NAME");
 	ASSERT_OR_DIE(m_name != "ERROR_INVALID_NAME", "No name found for MapDefinition element.");
 
+	//Kept so generated maps can be cached against the exact definition that produced them
+	XMLSTR sourceXML = element.createXMLString(0);
+	m_sourceXML = sourceXML;
+	freeXMLString(sourceXML);
+
 	m_dimensions = ParseXMLAttributeIntVector2(element, "dimensions", IntVector2(0, 0));
 	ASSERT_OR_DIE(m_dimensions != IntVector2(0, 0), "No dimensions or invalid dimensions found for MapDefinition.");
 	
@@ -31,32 +36,55 @@ MapDefinition::MapDefinition(XMLNode element)
 
 void MapDefinition::GenerateMap(Map*& mapToGenerateIn)
 {
+	std::lock_guard<std::mutex> lock(m_generationMutex);
 	for (size_t generatorIndex = m_currentGeneratorIndex; generatorIndex < m_generators.size(); generatorIndex++)
 	{
-		m_generators[generatorIndex]->GenerateMap(mapToGenerateIn);
+		RandomStream generatorRandom(GetGeneratorSeed(mapToGenerateIn, generatorIndex));
+		GenerationStepScope stepScope(mapToGenerateIn, m_generators[generatorIndex], (int)generatorIndex);
+		m_generators[generatorIndex]->GenerateMap(mapToGenerateIn, generatorRandom);
 	}
+
+	mapToGenerateIn->RebuildTileIndices();
 }
 
 bool MapDefinition::StepGeneration(Map*& mapToGenerateIn)
 {
-	m_generators[m_currentGeneratorIndex]->GenerateMap(mapToGenerateIn);
+	std::lock_guard<std::mutex> lock(m_generationMutex);
+	RandomStream generatorRandom(GetGeneratorSeed(mapToGenerateIn, m_currentGeneratorIndex));
+	{
+		GenerationStepScope stepScope(mapToGenerateIn, m_generators[m_currentGeneratorIndex], (int)m_currentGeneratorIndex);
+		m_generators[m_currentGeneratorIndex]->GenerateMap(mapToGenerateIn, generatorRandom);
+	}
 
 	++m_currentGeneratorIndex;
 	if (m_currentGeneratorIndex == m_generators.size())
 	{
 		m_currentGeneratorIndex = 0;
+		mapToGenerateIn->RebuildTileIndices();
 		return true;
 	}
 	else
 		return false;
 }
 
+//Each generator gets its own stream so its output does not depend on how much randomness the generators before it used
+unsigned int MapDefinition::GetGeneratorSeed(const Map* mapToGenerate, unsigned int generatorIndex) const
+{
+	return RandomStream::DeriveSeed(mapToGenerate->m_seed, generatorIndex);
+}
+
 void MapDefinition::DebugRender(const Map* mapToDrawOn) const
 {
-	for (Tile tile : mapToDrawOn->m_tiles)
+	UNUSED(mapToDrawOn);
+#ifndef ROGUELIKE_HEADLESS
+	for (const Tile& tile : mapToDrawOn->m_tiles)
 	{
+		if (tile.IsMapBorder())
+			continue;
+
 		g_theRenderer->DrawCenteredText2D((Vector2)tile.m_tileCoords + Vector2(0.5f, 0.5f), g_theRenderer->m_defaultFont, std::to_string(tile.m_permanence).substr(0, 4), Rgba::RED, 0.25f);
 	}
+#endif
 }
 
 MapDefinition* MapDefinition::GetDefinition(std::string definitionName)
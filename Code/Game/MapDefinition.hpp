@@ -1,8 +1,9 @@
 #pragma once
 #include <string>
-#include "ThirdParty\XMLParser\XMLParser.hpp"
+#include "ThirdParty/XMLParser/XMLParser.hpp"
 #include <map>
 #include <vector>
+#include <mutex>
 #include "Game/MapGenerator.hpp"
 
 
@@ -15,13 +16,18 @@ public:
 	void GenerateMap(Map*& mapToGenerateIn);
 	bool StepGeneration(Map*& mapToGenerateIn);
 	void DebugRender(const Map* mapToDrawOn) const;
+	unsigned int GetGeneratorSeed(const Map* mapToGenerate, unsigned int generatorIndex) const;
 
 	std::string m_name;
+	std::string m_sourceXML;
 	std::string m_fillTileType;
 	IntVector2 m_dimensions;
 	std::vector<MapGenerator*> m_generators;
 	unsigned int m_currentGeneratorIndex = 0;
 
+	//Generators keep per-run state, so maps sharing a definition are generated one at a time
+	std::mutex m_generationMutex;
+
 	static MapDefinition* GetDefinition(std::string definitionName);
 	static std::map<std::string, MapDefinition*> s_registry;
 };
\ No newline at end of file
@@ -1,10 +1,14 @@
 #include "Game/MapGenerator.hpp"
 #include "Engine/Core/XMLUtils.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/EngineConfig.hpp"
 #include "Game/MapGeneratorRoomsAndPaths.hpp"
 #include "Game/MapGeneratorFromFile.hpp"
 #include "Game/MapGeneratorCellularAutomata.hpp"
 #include "Game/MapGeneratorPerlinNoise.hpp"
+#include "Game/MapGeneratorOverworld.hpp"
+#include "Game/MapGeneratorWaveFunctionCollapse.hpp"
+#include "Game/MapGeneratorConnectRegions.hpp"
 
 
 
@@ -16,12 +20,35 @@ MapGenerator::MapGenerator(XMLNode element)
 	m_chanceToRun = ParseXMLAttributeFloat(element, "chanceToRun", 1.f);
 }
 
-void MapGenerator::PlaceTileIfPossible(Tile* tileToChange, std::string newType, float newPermanence)
+//Generators without rules to compare have nothing to report
+std::string MapGenerator::BenchmarkRules(Map* mapToBenchmarkOn, int numRepetitions) const
+{
+	UNUSED(mapToBenchmarkOn);
+	UNUSED(numRepetitions);
+	return "";
+}
+
+//Anything outside the definition XML that changes what this generator produces
+std::string MapGenerator::GetCacheKeyData() const
+{
+	return "";
+}
+
+void MapGenerator::PlaceTileIfPossible(Tile* tileToChange, std::string newType, float newPermanence, RandomStream& random)
+{
+	if (tileToChange->m_permanence > newPermanence)
+		return;
+
+	tileToChange->ChangeType(newType, random);
+	tileToChange->m_permanence = newPermanence;
+}
+
+void MapGenerator::PlaceTileIfPossible(Tile* tileToChange, TileDefinition* newTileDefinition, float newPermanence, RandomStream& random)
 {
 	if (tileToChange->m_permanence > newPermanence)
 		return;
 
-	tileToChange->ChangeType(newType);
+	tileToChange->ChangeType(newTileDefinition, random);
 	tileToChange->m_permanence = newPermanence;
 }
 
@@ -41,5 +68,14 @@ MapGenerator* MapGenerator::Create(XMLNode element)
 	if (elementName == "Perlin")
 		return new MapGeneratorPerlinNoise(element);
 
+	if (elementName == "Overworld")
+		return new MapGeneratorOverworld(element);
+
+	if (elementName == "WaveFunctionCollapse")
+		return new MapGeneratorWaveFunctionCollapse(element);
+
+	if (elementName == "ConnectRegions")
+		return new MapGeneratorConnectRegions(element);
+
 	ERROR_AND_DIE("Invalid generator name.");
 }
@@ -1,5 +1,5 @@
 #pragma once
-#include "ThirdParty\XMLParser\XMLParser.hpp"
+#include "ThirdParty/XMLParser/XMLParser.hpp"
 #include <string>
 #include "Game/Map.hpp"
 
@@ -8,9 +8,13 @@ class MapGenerator
 {
 public:
 	MapGenerator(XMLNode element);
+	virtual ~MapGenerator() {}
 
-	virtual void GenerateMap(Map*& outMapToGenerate) = 0;
-	void PlaceTileIfPossible(Tile* tileToChange, std::string newType, float newPermanence);
+	virtual void GenerateMap(Map*& outMapToGenerate, RandomStream& random) = 0;
+	virtual std::string BenchmarkRules(Map* mapToBenchmarkOn, int numRepetitions) const;
+	virtual std::string GetCacheKeyData() const;
+	void PlaceTileIfPossible(Tile* tileToChange, std::string newType, float newPermanence, RandomStream& random);
+	void PlaceTileIfPossible(Tile* tileToChange, TileDefinition* newTileDefinition, float newPermanence, RandomStream& random);
 
 	std::string m_name;
 	float m_chanceToRun = 1.f;
@@ -4,6 +4,19 @@
 #include "CharacterBuilder.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Core/StringUtils.hpp"
+#include "Game/JobSystem.hpp"
+#include "Game/RandomStream.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <stdio.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define CELLULAR_AUTOMATA_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+
+const int MapGeneratorCellularAutomata::ROWS_PER_BAND = 32;
 
 
 MapGeneratorCellularAutomata::MapGeneratorCellularAutomata(XMLNode element)
@@ -19,41 +32,246 @@ MapGeneratorCellularAutomata::MapGeneratorCellularAutomata(XMLNode element)
 	}
 
 	m_permanence = ParseXMLAttributeFloat(element, "permanence", m_permanence);
+
+	CompileRules();
 }
 
-void MapGeneratorCellularAutomata::GenerateMap(Map*& outMapToGenerate)
+void MapGeneratorCellularAutomata::GenerateMap(Map*& outMapToGenerate, RandomStream& random)
 {
+	//Run every iteration on compact type and permanence buffers and only touch the Tiles once at the end
+	CellularAutomataBuffers buffers;
+	LoadBuffers(*outMapToGenerate, buffers);
+
+	//Bands are a fixed number of rows and each band has its own random stream, so the result does not depend on how many threads run them
+	int numBands = (buffers.m_numRows + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+	unsigned int generationSeed = random.GetRandomUnsignedInt();
+	std::vector<std::vector<CellularAutomataTagChange>> bandTagChanges(numBands);
 	for (int iterationIndex = 0; iterationIndex < m_numIterations; iterationIndex++)
 	{
-		ApplyRulesToMap(outMapToGenerate);
+		unsigned int iterationSeed = RandomStream::DeriveSeed(generationSeed, iterationIndex);
+		buffers.m_nextTypes = buffers.m_currentTypes;
+
+		RunParallelFor(numBands, [&](int bandIndex) { SumRowsInBand(buffers, bandIndex); });
+		RunParallelFor(numBands, [&](int bandIndex) { ApplyRulesToBand(buffers, bandIndex, RandomStream::DeriveSeed(iterationSeed, bandIndex), bandTagChanges[bandIndex]); });
+
+		buffers.m_currentTypes.swap(buffers.m_nextTypes);
+	}
+
+	for (size_t tileIndex = 0; tileIndex < outMapToGenerate->m_tiles.size(); tileIndex++)
+	{
+		Tile& tile = outMapToGenerate->m_tiles[tileIndex];
+		if (tile.IsMapBorder())
+			continue;
+
+		if (tile.m_tileDefinition->m_typeID != buffers.m_currentTypes[tileIndex])
+			tile.ChangeType(TileDefinition::GetTileDefinition(buffers.m_currentTypes[tileIndex]), random);
+		tile.m_permanence = buffers.m_permanences[tileIndex];
+	}
+
+	for (const std::vector<CellularAutomataTagChange>& tagChanges : bandTagChanges)
+	{
+		for (const CellularAutomataTagChange& tagChange : tagChanges)
+		{
+			outMapToGenerate->m_tiles[tagChange.m_tileIndex].SetTags(m_rules[tagChange.m_ruleIndex].m_tagsToSet);
+		}
 	}
 }
 
-void MapGeneratorCellularAutomata::ApplyRulesToMap(Map*& outMapToGenerate)
+std::string MapGeneratorCellularAutomata::BenchmarkRules(Map* mapToBenchmarkOn, int numRepetitions) const
 {
-	std::vector<Tile> tempMap;
-	for (size_t tileIndex = 0; tileIndex < outMapToGenerate->m_tiles.size(); tileIndex++)
+	int numInterpretedMatches = 0;
+	double startSeconds = GetCurrentTimeSeconds();
+	for (int repetitionIndex = 0; repetitionIndex < numRepetitions; repetitionIndex++)
+	{
+		numInterpretedMatches = CountRuleMatchesInterpreted(*mapToBenchmarkOn);
+	}
+	double interpretedSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	int numCompiledMatches = 0;
+	startSeconds = GetCurrentTimeSeconds();
+	for (int repetitionIndex = 0; repetitionIndex < numRepetitions; repetitionIndex++)
+	{
+		numCompiledMatches = CountRuleMatchesCompiled(*mapToBenchmarkOn);
+	}
+	double compiledSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	char resultLine[256];
+	snprintf(resultLine, sizeof(resultLine), "Cellular automata \"%s\": interpreted %.4f ms, compiled %.4f ms per pass (%d / %d rule matches)", m_name.c_str(), (interpretedSeconds * 1000.0) / numRepetitions, (compiledSeconds * 1000.0) / numRepetitions, numInterpretedMatches, numCompiledMatches);
+	return resultLine;
+}
+
+void MapGeneratorCellularAutomata::LoadBuffers(const Map& map, CellularAutomataBuffers& out_buffers) const
+{
+	out_buffers.m_tileStride = map.m_tileStride;
+	out_buffers.m_numRows = (int)map.m_tiles.size() / map.m_tileStride;
+	out_buffers.m_currentTypes.resize(map.m_tiles.size());
+	out_buffers.m_nextTypes.resize(map.m_tiles.size());
+	out_buffers.m_permanences.resize(map.m_tiles.size());
+	for (size_t tileIndex = 0; tileIndex < map.m_tiles.size(); tileIndex++)
+	{
+		out_buffers.m_currentTypes[tileIndex] = map.m_tiles[tileIndex].m_tileDefinition->m_typeID;
+		out_buffers.m_permanences[tileIndex] = map.m_tiles[tileIndex].m_permanence;
+	}
+
+	out_buffers.m_typeMasks.resize(m_neighborTileIDs.size());
+	out_buffers.m_rowSums.resize(m_neighborTileIDs.size());
+	for (size_t neighborTypeIndex = 0; neighborTypeIndex < m_neighborTileIDs.size(); neighborTypeIndex++)
 	{
-		tempMap.push_back(outMapToGenerate->m_tiles[tileIndex]);
+		out_buffers.m_typeMasks[neighborTypeIndex].assign(map.m_tiles.size(), 0);
+		out_buffers.m_rowSums[neighborTypeIndex].assign(map.m_tiles.size(), 0);
 	}
+}
 
-	for (size_t tileIndex = 0; tileIndex < tempMap.size(); tileIndex++)
+//Rule evaluation the way it was done before rules were compiled, kept to compare against
+int MapGeneratorCellularAutomata::CountRuleMatchesInterpreted(const Map& map) const
+{
+	int numMatches = 0;
+	for (size_t tileIndex = 0; tileIndex < map.m_tiles.size(); tileIndex++)
 	{
+		const Tile& tile = map.m_tiles[tileIndex];
+		if (tile.IsMapBorder())
+			continue;
+
 		for (CellularAutomataRule rule : m_rules)
 		{
-			if(outMapToGenerate->m_tiles[tileIndex].m_tileDefinition->m_name == rule.m_ifTile)
+			if (tile.m_tileDefinition->m_name == rule.m_ifTile)
+			{
+				int numNeighborsOfType = GetNumberOfNeighborsOfType(tile, rule.m_ifNeighborTile);
+				if (numNeighborsOfType > rule.m_ifGreaterThanNumber && numNeighborsOfType < rule.m_ifFewerThanNumber)
+					numMatches++;
+			}
+		}
+	}
+
+	return numMatches;
+}
+
+int MapGeneratorCellularAutomata::CountRuleMatchesCompiled(const Map& map) const
+{
+	CellularAutomataBuffers buffers;
+	LoadBuffers(map, buffers);
+
+	int numBands = (buffers.m_numRows + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+	for (int bandIndex = 0; bandIndex < numBands; bandIndex++)
+	{
+		SumRowsInBand(buffers, bandIndex);
+	}
+
+	int numMatches = 0;
+	int tileStride = buffers.m_tileStride;
+	std::vector<unsigned char> neighborCounts(m_neighborTileIDs.size() * tileStride);
+	for (int rowIndex = 1; rowIndex < buffers.m_numRows - 1; rowIndex++)
+	{
+		int rowStart = rowIndex * tileStride;
+		for (size_t neighborTypeIndex = 0; neighborTypeIndex < m_neighborTileIDs.size(); neighborTypeIndex++)
+		{
+			const std::vector<unsigned char>& rowSums = buffers.m_rowSums[neighborTypeIndex];
+			SumNeighborCountRow(&rowSums[rowStart - tileStride], &rowSums[rowStart], &rowSums[rowStart + tileStride], &buffers.m_typeMasks[neighborTypeIndex][rowStart], &neighborCounts[neighborTypeIndex * tileStride], tileStride);
+		}
+
+		for (int columnIndex = 1; columnIndex < tileStride - 1; columnIndex++)
+		{
+			TileTypeID currentType = buffers.m_currentTypes[rowStart + columnIndex];
+			if (currentType >= m_compiledRulesBySourceType.size())
+				continue;
+
+			for (const CompiledCellularAutomataRule& rule : m_compiledRulesBySourceType[currentType])
+			{
+				if (rule.m_runsForNeighborCount[neighborCounts[(rule.m_neighborCountIndex * tileStride) + columnIndex]])
+					numMatches++;
+			}
+		}
+	}
+
+	return numMatches;
+}
+
+int MapGeneratorCellularAutomata::GetNumberOfNeighborsOfType(const Tile& tile, std::string neighborType)
+{
+	int neighborOfTypeCount = 0;
+
+	if (tile.GetEastNeighbor()->m_tileDefinition->m_name == neighborType)
+		neighborOfTypeCount++;
+	if (tile.GetNorthEastNeighbor()->m_tileDefinition->m_name == neighborType)
+		neighborOfTypeCount++;
+	if (tile.GetNorthNeighbor()->m_tileDefinition->m_name == neighborType)
+		neighborOfTypeCount++;
+	if (tile.GetNorthWestNeighbor()->m_tileDefinition->m_name == neighborType)
+		neighborOfTypeCount++;
+	if (tile.GetWestNeighbor()->m_tileDefinition->m_name == neighborType)
+		neighborOfTypeCount++;
+	if (tile.GetSouthWestNeighbor()->m_tileDefinition->m_name == neighborType)
+		neighborOfTypeCount++;
+	if (tile.GetSouthNeighbor()->m_tileDefinition->m_name == neighborType)
+		neighborOfTypeCount++;
+	if (tile.GetSouthEastNeighbor()->m_tileDefinition->m_name == neighborType)
+		neighborOfTypeCount++;
+
+	return neighborOfTypeCount;
+}
+
+void MapGeneratorCellularAutomata::SumRowsInBand(CellularAutomataBuffers& buffers, int bandIndex) const
+{
+	int firstRow = bandIndex * ROWS_PER_BAND;
+	int lastRow = std::min(firstRow + ROWS_PER_BAND, buffers.m_numRows);
+	for (size_t neighborTypeIndex = 0; neighborTypeIndex < m_neighborTileIDs.size(); neighborTypeIndex++)
+	{
+		for (int rowIndex = firstRow; rowIndex < lastRow; rowIndex++)
+		{
+			int rowStart = rowIndex * buffers.m_tileStride;
+			unsigned char* maskRow = &buffers.m_typeMasks[neighborTypeIndex][rowStart];
+			BuildTypeMaskRow(&buffers.m_currentTypes[rowStart], m_neighborTileIDs[neighborTypeIndex], maskRow, buffers.m_tileStride);
+			SumMaskRowWindows(maskRow, &buffers.m_rowSums[neighborTypeIndex][rowStart], buffers.m_tileStride);
+		}
+	}
+}
+
+void MapGeneratorCellularAutomata::ApplyRulesToBand(CellularAutomataBuffers& buffers, int bandIndex, unsigned int bandSeed, std::vector<CellularAutomataTagChange>& out_tagChanges) const
+{
+	RandomStream bandRandom(bandSeed);
+	int tileStride = buffers.m_tileStride;
+	std::vector<unsigned char> neighborCounts(m_neighborTileIDs.size() * tileStride);
+
+	int firstRow = std::max(bandIndex * ROWS_PER_BAND, 1);
+	int lastRow = std::min((bandIndex + 1) * ROWS_PER_BAND, buffers.m_numRows - 1);
+	for (int rowIndex = firstRow; rowIndex < lastRow; rowIndex++)
+	{
+		int rowStart = rowIndex * tileStride;
+		for (size_t neighborTypeIndex = 0; neighborTypeIndex < m_neighborTileIDs.size(); neighborTypeIndex++)
+		{
+			const std::vector<unsigned char>& rowSums = buffers.m_rowSums[neighborTypeIndex];
+			SumNeighborCountRow(&rowSums[rowStart - tileStride], &rowSums[rowStart], &rowSums[rowStart + tileStride], &buffers.m_typeMasks[neighborTypeIndex][rowStart], &neighborCounts[neighborTypeIndex * tileStride], tileStride);
+		}
+
+		for (int columnIndex = 1; columnIndex < tileStride - 1; columnIndex++)
+		{
+			int tileIndex = rowStart + columnIndex;
+			TileTypeID currentType = buffers.m_currentTypes[tileIndex];
+			if (currentType >= m_compiledRulesBySourceType.size())
+				continue;
+
+			for (const CompiledCellularAutomataRule& rule : m_compiledRulesBySourceType[currentType])
 			{
-				int numNeighborsOfType = GetNumberOfNeighborsOfType(outMapToGenerate->m_tiles[tileIndex], rule.m_ifNeighborTile);
-				if (numNeighborsOfType > rule.m_ifGreaterThanNumber && numNeighborsOfType < rule.m_ifFewerThanNumber && GetRandomFloatZeroToOne() <= rule.m_chanceToRunPerTile)
+				int numNeighborsOfType = neighborCounts[(rule.m_neighborCountIndex * tileStride) + columnIndex];
+				if (!rule.m_runsForNeighborCount[numNeighborsOfType] || bandRandom.GetRandomFloatZeroToOne() > rule.m_chanceToRunPerTile)
+					continue;
+
+				if (buffers.m_permanences[tileIndex] <= m_permanence)
+				{
+					buffers.m_nextTypes[tileIndex] = rule.m_changeToTileID;
+					buffers.m_permanences[tileIndex] = m_permanence;
+				}
+
+				if (rule.m_setsTags)
 				{
-					PlaceTileIfPossible(&tempMap[tileIndex], rule.m_changeToTile, m_permanence);
-					tempMap[tileIndex].m_tags.SetTags(rule.m_tagsToSet);
+					CellularAutomataTagChange tagChange;
+					tagChange.m_tileIndex = tileIndex;
+					tagChange.m_ruleIndex = rule.m_ruleIndex;
+					out_tagChanges.push_back(tagChange);
 				}
 			}
 		}
 	}
-
-	outMapToGenerate->m_tiles = tempMap;
 }
 
 void MapGeneratorCellularAutomata::ParseRule(XMLNode ruleElement)
@@ -73,29 +291,102 @@ void MapGeneratorCellularAutomata::ParseRule(XMLNode ruleElement)
 	newRule.m_ifFewerThanNumber = ParseXMLAttributeInt(ruleElement, "ifFewerThan", newRule.m_ifFewerThanNumber);
 	newRule.m_tagsToSet = ParseXMLAttributeString(ruleElement, "setTags", "");
 
+	TileDefinition* ifTileDefinition = TileDefinition::GetTileDefinition(newRule.m_ifTile);
+	TileDefinition* ifNeighborTileDefinition = TileDefinition::GetTileDefinition(newRule.m_ifNeighborTile);
+	TileDefinition* changeToTileDefinition = TileDefinition::GetTileDefinition(newRule.m_changeToTile);
+	ASSERT_OR_DIE(ifTileDefinition && ifNeighborTileDefinition && changeToTileDefinition, "Unknown tile type used in Cellular Automata rule.");
+	newRule.m_ifTileID = ifTileDefinition->m_typeID;
+	newRule.m_ifNeighborTileID = ifNeighborTileDefinition->m_typeID;
+	newRule.m_changeToTileID = changeToTileDefinition->m_typeID;
+
+	newRule.m_neighborCountIndex = std::find(m_neighborTileIDs.begin(), m_neighborTileIDs.end(), newRule.m_ifNeighborTileID) - m_neighborTileIDs.begin();
+	if (newRule.m_neighborCountIndex == (int)m_neighborTileIDs.size())
+		m_neighborTileIDs.push_back(newRule.m_ifNeighborTileID);
+
 	m_rules.push_back(newRule);
 }
 
-int MapGeneratorCellularAutomata::GetNumberOfNeighborsOfType(const Tile& tile, std::string neighborType)
+//Groups the rules by the tile type they apply to and turns each rule's neighbor count range into a lookup, keeping rule order within a type
+void MapGeneratorCellularAutomata::CompileRules()
 {
-	int neighborOfTypeCount = 0;
+	m_compiledRulesBySourceType.clear();
+	m_compiledRulesBySourceType.resize(TileDefinition::s_tileDefinitionsByID.size());
+	for (size_t ruleIndex = 0; ruleIndex < m_rules.size(); ruleIndex++)
+	{
+		const CellularAutomataRule& rule = m_rules[ruleIndex];
 
-	if (tile.GetEastNeighbor() && tile.GetEastNeighbor()->m_tileDefinition->m_name == neighborType)
-		neighborOfTypeCount++;
-	if (tile.GetNorthEastNeighbor() && tile.GetNorthEastNeighbor()->m_tileDefinition->m_name == neighborType)
-		neighborOfTypeCount++;
-	if (tile.GetNorthNeighbor() && tile.GetNorthNeighbor()->m_tileDefinition->m_name == neighborType)
-		neighborOfTypeCount++;
-	if (tile.GetNorthWestNeighbor() && tile.GetNorthWestNeighbor()->m_tileDefinition->m_name == neighborType)
-		neighborOfTypeCount++;
-	if (tile.GetWestNeighbor() && tile.GetWestNeighbor()->m_tileDefinition->m_name == neighborType)
-		neighborOfTypeCount++;
-	if (tile.GetSouthWestNeighbor() && tile.GetSouthWestNeighbor()->m_tileDefinition->m_name == neighborType)
-		neighborOfTypeCount++;
-	if (tile.GetSouthNeighbor() && tile.GetSouthNeighbor()->m_tileDefinition->m_name == neighborType)
-		neighborOfTypeCount++;
-	if (tile.GetSouthEastNeighbor() && tile.GetSouthEastNeighbor()->m_tileDefinition->m_name == neighborType)
-		neighborOfTypeCount++;
+		CompiledCellularAutomataRule compiledRule;
+		compiledRule.m_ruleIndex = (int)ruleIndex;
+		compiledRule.m_neighborCountIndex = rule.m_neighborCountIndex;
+		compiledRule.m_changeToTileID = rule.m_changeToTileID;
+		compiledRule.m_chanceToRunPerTile = rule.m_chanceToRunPerTile;
+		compiledRule.m_setsTags = !rule.m_tagsToSet.empty();
+		for (int neighborCount = 0; neighborCount <= NUM_TILE_NEIGHBORS; neighborCount++)
+		{
+			compiledRule.m_runsForNeighborCount[neighborCount] = neighborCount > rule.m_ifGreaterThanNumber && neighborCount < rule.m_ifFewerThanNumber;
+		}
 
-	return neighborOfTypeCount;
+		m_compiledRulesBySourceType[rule.m_ifTileID].push_back(compiledRule);
+	}
+}
+
+//Writes 1 for every tile in the row of the given type and 0 otherwise
+void MapGeneratorCellularAutomata::BuildTypeMaskRow(const TileTypeID* rowTypes, TileTypeID type, unsigned char* out_maskRow, int rowLength)
+{
+	int columnIndex = 0;
+#ifdef CELLULAR_AUTOMATA_USE_SSE2
+	const __m128i typeVector = _mm_set1_epi16((short)type);
+	const __m128i oneVector = _mm_set1_epi8(1);
+	for (; columnIndex + 16 <= rowLength; columnIndex += 16)
+	{
+		__m128i lowTypes = _mm_loadu_si128((const __m128i*)&rowTypes[columnIndex]);
+		__m128i highTypes = _mm_loadu_si128((const __m128i*)&rowTypes[columnIndex + 8]);
+		__m128i matches = _mm_packs_epi16(_mm_cmpeq_epi16(lowTypes, typeVector), _mm_cmpeq_epi16(highTypes, typeVector));
+		_mm_storeu_si128((__m128i*)&out_maskRow[columnIndex], _mm_and_si128(matches, oneVector));
+	}
+#endif
+	for (; columnIndex < rowLength; columnIndex++)
+	{
+		out_maskRow[columnIndex] = (rowTypes[columnIndex] == type) ? 1 : 0;
+	}
+}
+
+//Sums each 3 wide horizontal window of the mask row into the window's center column
+void MapGeneratorCellularAutomata::SumMaskRowWindows(const unsigned char* maskRow, unsigned char* out_rowSums, int rowLength)
+{
+	int columnIndex = 1;
+#ifdef CELLULAR_AUTOMATA_USE_SSE2
+	for (; columnIndex + 16 <= rowLength - 1; columnIndex += 16)
+	{
+		__m128i left = _mm_loadu_si128((const __m128i*)&maskRow[columnIndex - 1]);
+		__m128i center = _mm_loadu_si128((const __m128i*)&maskRow[columnIndex]);
+		__m128i right = _mm_loadu_si128((const __m128i*)&maskRow[columnIndex + 1]);
+		_mm_storeu_si128((__m128i*)&out_rowSums[columnIndex], _mm_add_epi8(_mm_add_epi8(left, center), right));
+	}
+#endif
+	for (; columnIndex < rowLength - 1; columnIndex++)
+	{
+		out_rowSums[columnIndex] = (unsigned char)(maskRow[columnIndex - 1] + maskRow[columnIndex] + maskRow[columnIndex + 1]);
+	}
+}
+
+//Adds the window sums of the rows above, at and below, minus the tile itself, giving its 8 neighbor count
+void MapGeneratorCellularAutomata::SumNeighborCountRow(const unsigned char* rowSumsAbove, const unsigned char* rowSums, const unsigned char* rowSumsBelow, const unsigned char* maskRow, unsigned char* out_neighborCounts, int rowLength)
+{
+	int columnIndex = 1;
+#ifdef CELLULAR_AUTOMATA_USE_SSE2
+	for (; columnIndex + 16 <= rowLength - 1; columnIndex += 16)
+	{
+		__m128i above = _mm_loadu_si128((const __m128i*)&rowSumsAbove[columnIndex]);
+		__m128i current = _mm_loadu_si128((const __m128i*)&rowSums[columnIndex]);
+		__m128i below = _mm_loadu_si128((const __m128i*)&rowSumsBelow[columnIndex]);
+		__m128i self = _mm_loadu_si128((const __m128i*)&maskRow[columnIndex]);
+		__m128i neighborCounts = _mm_sub_epi8(_mm_add_epi8(_mm_add_epi8(above, current), below), self);
+		_mm_storeu_si128((__m128i*)&out_neighborCounts[columnIndex], neighborCounts);
+	}
+#endif
+	for (; columnIndex < rowLength - 1; columnIndex++)
+	{
+		out_neighborCounts[columnIndex] = (unsigned char)(rowSumsAbove[columnIndex] + rowSums[columnIndex] + rowSumsBelow[columnIndex] - maskRow[columnIndex]);
+	}
 }
@@ -1,5 +1,5 @@
 #pragma once
-#include "ThirdParty\XMLParser\XMLParser.hpp"
+#include "ThirdParty/XMLParser/XMLParser.hpp"
 #include <string>
 #include "Game/MapGenerator.hpp"
 
@@ -12,19 +12,67 @@ struct CellularAutomataRule
 	int m_ifGreaterThanNumber = -1;
 	int m_ifFewerThanNumber = 9999;
 	float m_chanceToRunPerTile = 1.f;
+
+	TileTypeID m_ifTileID = 0;
+	TileTypeID m_ifNeighborTileID = 0;
+	TileTypeID m_changeToTileID = 0;
+	int m_neighborCountIndex = 0;
+};
+
+struct CompiledCellularAutomataRule
+{
+	int m_ruleIndex;
+	int m_neighborCountIndex;
+	TileTypeID m_changeToTileID;
+	float m_chanceToRunPerTile;
+	bool m_setsTags;
+	bool m_runsForNeighborCount[NUM_TILE_NEIGHBORS + 1];
+};
+
+struct CellularAutomataTagChange
+{
+	int m_tileIndex;
+	int m_ruleIndex;
+};
+
+struct CellularAutomataBuffers
+{
+	int m_tileStride = 0;
+	int m_numRows = 0;
+	std::vector<TileTypeID> m_currentTypes;
+	std::vector<TileTypeID> m_nextTypes;
+	std::vector<float> m_permanences;
+	std::vector<std::vector<unsigned char>> m_typeMasks;
+	std::vector<std::vector<unsigned char>> m_rowSums;
 };
 
 class MapGeneratorCellularAutomata : public MapGenerator
 {
 public:
 	MapGeneratorCellularAutomata(XMLNode element);
-	virtual void GenerateMap(Map*& outMapToGenerate) override;
+	virtual void GenerateMap(Map*& outMapToGenerate, RandomStream& random) override;
+	virtual std::string BenchmarkRules(Map* mapToBenchmarkOn, int numRepetitions) const override;
 
 	int m_numIterations = 1;
 	std::vector<CellularAutomataRule> m_rules;
+	std::vector<TileTypeID> m_neighborTileIDs;
 	float m_permanence = 0.5f;
+
+	static const int ROWS_PER_BAND;
 private:
-	void ApplyRulesToMap(Map*& outMapToGenerate);
+	void LoadBuffers(const Map& map, CellularAutomataBuffers& out_buffers) const;
+	int CountRuleMatchesInterpreted(const Map& map) const;
+	int CountRuleMatchesCompiled(const Map& map) const;
+	static int GetNumberOfNeighborsOfType(const Tile& tile, std::string neighborType);
+
+	void SumRowsInBand(CellularAutomataBuffers& buffers, int bandIndex) const;
+	void ApplyRulesToBand(CellularAutomataBuffers& buffers, int bandIndex, unsigned int bandSeed, std::vector<CellularAutomataTagChange>& out_tagChanges) const;
 	void ParseRule(XMLNode ruleElement);
-	int GetNumberOfNeighborsOfType(const Tile& tile, std::string neighborType);
+	void CompileRules();
+
+	std::vector<std::vector<CompiledCellularAutomataRule>> m_compiledRulesBySourceType;
+
+	static void BuildTypeMaskRow(const TileTypeID* rowTypes, TileTypeID type, unsigned char* out_maskRow, int rowLength);
+	static void SumMaskRowWindows(const unsigned char* maskRow, unsigned char* out_rowSums, int rowLength);
+	static void SumNeighborCountRow(const unsigned char* rowSumsAbove, const unsigned char* rowSums, const unsigned char* rowSumsBelow, const unsigned char* maskRow, unsigned char* out_neighborCounts, int rowLength);
 };
\ No newline at end of file
@@ -0,0 +1,302 @@
+#include "Game/MapGeneratorConnectRegions.hpp"
+#include "Game/MapDefinition.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/XMLUtils.hpp"
+#include <algorithm>
+#include <map>
+
+
+static const IntVector2 REGION_NEIGHBOR_OFFSETS[4] = { IntVector2(0, 1), IntVector2(0, -1), IntVector2(1, 0), IntVector2(-1, 0) };
+
+
+void DisjointSets::Reset(int numElements)
+{
+	m_parents.resize(numElements);
+	m_sizes.assign(numElements, 1);
+	for (int element = 0; element < numElements; element++)
+	{
+		m_parents[element] = element;
+	}
+}
+
+int DisjointSets::FindRoot(int element)
+{
+	while (m_parents[element] != element)
+	{
+		m_parents[element] = m_parents[m_parents[element]];
+		element = m_parents[element];
+	}
+
+	return element;
+}
+
+//Returns false if the two were already in the same set
+bool DisjointSets::Union(int elementA, int elementB)
+{
+	int rootA = FindRoot(elementA);
+	int rootB = FindRoot(elementB);
+	if (rootA == rootB)
+		return false;
+
+	if (m_sizes[rootA] < m_sizes[rootB])
+		std::swap(rootA, rootB);
+
+	m_parents[rootB] = rootA;
+	m_sizes[rootA] += m_sizes[rootB];
+	return true;
+}
+
+
+bool RegionTunnel::operator<(const RegionTunnel& other) const
+{
+	if (m_cost != other.m_cost)
+		return m_cost < other.m_cost;
+	if (m_regionA != other.m_regionA)
+		return m_regionA < other.m_regionA;
+	return m_regionB < other.m_regionB;
+}
+
+
+MapGeneratorConnectRegions::MapGeneratorConnectRegions(XMLNode element)
+	: MapGenerator(element)
+{
+	m_minRegionSize = ParseXMLAttributeInt(element, "minRegionSize", m_minRegionSize);
+	m_connectRegions = ParseXMLAttributeBool(element, "connect", m_connectRegions);
+	m_permanence = ParseXMLAttributeFloat(element, "permanence", m_permanence);
+
+	std::string tunnelTileName = ParseXMLAttributeString(element, "tunnelTile", "");
+	if (!tunnelTileName.empty())
+		m_tunnelTile = TileDefinition::GetTileDefinition(tunnelTileName);
+	ASSERT_OR_DIE(!m_connectRegions || m_tunnelTile, "ConnectRegions needs a valid tunnelTile to connect regions.");
+
+	std::string cullTileName = ParseXMLAttributeString(element, "cullTile", "");
+	if (!cullTileName.empty())
+		m_cullTile = TileDefinition::GetTileDefinition(cullTileName);
+	ASSERT_OR_DIE(cullTileName.empty() || m_cullTile, "Unknown cullTile for ConnectRegions.");
+	ASSERT_OR_DIE(m_minRegionSize <= 0 || m_cullTile, "ConnectRegions needs a cullTile to cull small regions.");
+}
+
+void MapGeneratorConnectRegions::GenerateMap(Map*& outMapToGenerate, RandomStream& random)
+{
+	RegionConnectivity connectivity;
+	LabelRegions(*outMapToGenerate, connectivity);
+	if (connectivity.m_regions.size() <= 1)
+		return;
+
+	if (m_minRegionSize > 0)
+		CullSmallRegions(*outMapToGenerate, connectivity, random);
+
+	if (m_connectRegions)
+	{
+		FindCheapestTunnels(connectivity);
+		DigSpanningTunnels(*outMapToGenerate, connectivity, random);
+	}
+}
+
+//One union per pair of open, orthogonally adjacent tiles, then one pass to number the roots in scan order
+void MapGeneratorConnectRegions::LabelRegions(Map& map, RegionConnectivity& connectivity) const
+{
+	IntVector2 dimensions = map.m_definition->m_dimensions;
+	int numCells = dimensions.x * dimensions.y;
+	connectivity.m_dimensions = dimensions;
+	connectivity.m_isOpen.resize(numCells);
+	connectivity.m_isDiggable.resize(numCells);
+	for (int cellIndex = 0; cellIndex < numCells; cellIndex++)
+	{
+		const Tile* tile = GetTileForCell(map, connectivity, cellIndex);
+		connectivity.m_isOpen[cellIndex] = !tile->m_tileDefinition->m_isSolid;
+		connectivity.m_isDiggable[cellIndex] = tile->m_tileDefinition->m_isSolid && tile->m_permanence <= m_permanence;
+	}
+
+	DisjointSets openTiles;
+	openTiles.Reset(numCells);
+	for (int yIndex = 0; yIndex < dimensions.y; yIndex++)
+	{
+		for (int xIndex = 0; xIndex < dimensions.x; xIndex++)
+		{
+			int cellIndex = (yIndex * dimensions.x) + xIndex;
+			if (!connectivity.m_isOpen[cellIndex])
+				continue;
+
+			if (xIndex + 1 < dimensions.x && connectivity.m_isOpen[cellIndex + 1])
+				openTiles.Union(cellIndex, cellIndex + 1);
+			if (yIndex + 1 < dimensions.y && connectivity.m_isOpen[cellIndex + dimensions.x])
+				openTiles.Union(cellIndex, cellIndex + dimensions.x);
+		}
+	}
+
+	std::vector<int> regionByRoot(numCells, -1);
+	connectivity.m_regionByCell.assign(numCells, -1);
+	connectivity.m_regions.clear();
+	for (int cellIndex = 0; cellIndex < numCells; cellIndex++)
+	{
+		if (!connectivity.m_isOpen[cellIndex])
+			continue;
+
+		int root = openTiles.FindRoot(cellIndex);
+		if (regionByRoot[root] == -1)
+		{
+			regionByRoot[root] = (int)connectivity.m_regions.size();
+			connectivity.m_regions.push_back(MapRegion());
+			connectivity.m_regions.back().m_firstTileIndex = cellIndex;
+		}
+
+		connectivity.m_regionByCell[cellIndex] = regionByRoot[root];
+		connectivity.m_regions[regionByRoot[root]].m_size++;
+	}
+}
+
+//The largest region always survives, however small it is
+void MapGeneratorConnectRegions::CullSmallRegions(Map& map, RegionConnectivity& connectivity, RandomStream& random)
+{
+	int largestRegion = 0;
+	for (int regionIndex = 0; regionIndex < (int)connectivity.m_regions.size(); regionIndex++)
+	{
+		MapRegion& region = connectivity.m_regions[regionIndex];
+		if (region.m_size > connectivity.m_regions[largestRegion].m_size)
+			largestRegion = regionIndex;
+		region.m_isCulled = region.m_size < m_minRegionSize;
+	}
+	connectivity.m_regions[largestRegion].m_isCulled = false;
+
+	for (int cellIndex = 0; cellIndex < (int)connectivity.m_regionByCell.size(); cellIndex++)
+	{
+		int regionIndex = connectivity.m_regionByCell[cellIndex];
+		if (regionIndex == -1 || !connectivity.m_regions[regionIndex].m_isCulled)
+			continue;
+
+		Tile* tile = GetTileForCell(map, connectivity, cellIndex);
+		PlaceTileIfPossible(tile, m_cullTile, m_permanence, random);
+		if (tile->m_tileDefinition == m_cullTile)
+		{
+			connectivity.m_isOpen[cellIndex] = false;
+			connectivity.m_isDiggable[cellIndex] = true;
+			connectivity.m_regionByCell[cellIndex] = -1;
+		}
+	}
+}
+
+//Breadth-first search outward from every region at once, through diggable walls only. Each wall cell is claimed by
+//the first region to reach it, and wherever two regions' claims touch, the shortest tunnel between that pair is kept.
+void MapGeneratorConnectRegions::FindCheapestTunnels(RegionConnectivity& connectivity) const
+{
+	IntVector2 dimensions = connectivity.m_dimensions;
+	int numCells = dimensions.x * dimensions.y;
+	connectivity.m_tunnelDistance.assign(numCells, -1);
+	connectivity.m_tunnelParent.assign(numCells, -1);
+
+	std::vector<int> frontier;
+	frontier.reserve(numCells);
+	for (int cellIndex = 0; cellIndex < numCells; cellIndex++)
+	{
+		int regionIndex = connectivity.m_regionByCell[cellIndex];
+		if (regionIndex != -1 && !connectivity.m_regions[regionIndex].m_isCulled)
+		{
+			connectivity.m_tunnelDistance[cellIndex] = 0;
+			frontier.push_back(cellIndex);
+		}
+	}
+
+	std::map<std::pair<int, int>, RegionTunnel> cheapestTunnelByRegionPair;
+	for (size_t frontierIndex = 0; frontierIndex < frontier.size(); frontierIndex++)
+	{
+		int cellIndex = frontier[frontierIndex];
+		int regionIndex = connectivity.m_regionByCell[cellIndex];
+		IntVector2 cellCoords(cellIndex % dimensions.x, cellIndex / dimensions.x);
+		for (const IntVector2& neighborOffset : REGION_NEIGHBOR_OFFSETS)
+		{
+			IntVector2 neighborCoords = cellCoords + neighborOffset;
+			if (neighborCoords.x < 0 || neighborCoords.y < 0 || neighborCoords.x >= dimensions.x || neighborCoords.y >= dimensions.y)
+				continue;
+
+			int neighborIndex = (neighborCoords.y * dimensions.x) + neighborCoords.x;
+			if (connectivity.m_tunnelDistance[neighborIndex] == -1)
+			{
+				if (!connectivity.m_isDiggable[neighborIndex])
+					continue;
+
+				connectivity.m_tunnelDistance[neighborIndex] = connectivity.m_tunnelDistance[cellIndex] + 1;
+				connectivity.m_tunnelParent[neighborIndex] = cellIndex;
+				connectivity.m_regionByCell[neighborIndex] = regionIndex;
+				frontier.push_back(neighborIndex);
+				continue;
+			}
+
+			int neighborRegionIndex = connectivity.m_regionByCell[neighborIndex];
+			if (neighborRegionIndex == regionIndex)
+				continue;
+
+			RegionTunnel tunnel;
+			tunnel.m_regionA = std::min(regionIndex, neighborRegionIndex);
+			tunnel.m_regionB = std::max(regionIndex, neighborRegionIndex);
+			tunnel.m_cost = connectivity.m_tunnelDistance[cellIndex] + connectivity.m_tunnelDistance[neighborIndex];
+			tunnel.m_meetingCellA = (regionIndex == tunnel.m_regionA) ? cellIndex : neighborIndex;
+			tunnel.m_meetingCellB = (regionIndex == tunnel.m_regionA) ? neighborIndex : cellIndex;
+
+			std::pair<int, int> regionPair(tunnel.m_regionA, tunnel.m_regionB);
+			std::map<std::pair<int, int>, RegionTunnel>::iterator found = cheapestTunnelByRegionPair.find(regionPair);
+			if (found == cheapestTunnelByRegionPair.end() || tunnel.m_cost < found->second.m_cost)
+				cheapestTunnelByRegionPair[regionPair] = tunnel;
+		}
+	}
+
+	connectivity.m_tunnels.clear();
+	for (std::map<std::pair<int, int>, RegionTunnel>::iterator tunnelIter = cheapestTunnelByRegionPair.begin(); tunnelIter != cheapestTunnelByRegionPair.end(); ++tunnelIter)
+	{
+		connectivity.m_tunnels.push_back(tunnelIter->second);
+	}
+}
+
+//Kruskal over the candidate tunnels. Regions that walls too permanent to dig still cut off from the largest region are
+//culled when there is a cullTile, so nothing reachable by spawning is left stranded.
+void MapGeneratorConnectRegions::DigSpanningTunnels(Map& map, RegionConnectivity& connectivity, RandomStream& random)
+{
+	std::sort(connectivity.m_tunnels.begin(), connectivity.m_tunnels.end());
+
+	DisjointSets connectedRegions;
+	connectedRegions.Reset((int)connectivity.m_regions.size());
+	for (const RegionTunnel& tunnel : connectivity.m_tunnels)
+	{
+		if (!connectedRegions.Union(tunnel.m_regionA, tunnel.m_regionB))
+			continue;
+
+		DigTunnelToRegion(map, connectivity, tunnel.m_meetingCellA, random);
+		DigTunnelToRegion(map, connectivity, tunnel.m_meetingCellB, random);
+	}
+
+	if (!m_cullTile)
+		return;
+
+	int largestRegion = -1;
+	for (int regionIndex = 0; regionIndex < (int)connectivity.m_regions.size(); regionIndex++)
+	{
+		const MapRegion& region = connectivity.m_regions[regionIndex];
+		if (!region.m_isCulled && (largestRegion == -1 || region.m_size > connectivity.m_regions[largestRegion].m_size))
+			largestRegion = regionIndex;
+	}
+
+	for (int cellIndex = 0; cellIndex < (int)connectivity.m_regionByCell.size(); cellIndex++)
+	{
+		int regionIndex = connectivity.m_regionByCell[cellIndex];
+		if (!connectivity.m_isOpen[cellIndex] || regionIndex == -1 || connectivity.m_regions[regionIndex].m_isCulled)
+			continue;
+
+		if (connectedRegions.FindRoot(regionIndex) != connectedRegions.FindRoot(largestRegion))
+			PlaceTileIfPossible(GetTileForCell(map, connectivity, cellIndex), m_cullTile, m_permanence, random);
+	}
+}
+
+void MapGeneratorConnectRegions::DigTunnelToRegion(Map& map, const RegionConnectivity& connectivity, int meetingCell, RandomStream& random)
+{
+	int cellIndex = meetingCell;
+	while (connectivity.m_tunnelDistance[cellIndex] > 0)
+	{
+		PlaceTileIfPossible(GetTileForCell(map, connectivity, cellIndex), m_tunnelTile, m_permanence, random);
+		cellIndex = connectivity.m_tunnelParent[cellIndex];
+	}
+}
+
+Tile* MapGeneratorConnectRegions::GetTileForCell(Map& map, const RegionConnectivity& connectivity, int cellIndex) const
+{
+	return map.GetTileAtTileCoords(IntVector2(cellIndex % connectivity.m_dimensions.x, cellIndex / connectivity.m_dimensions.x));
+}
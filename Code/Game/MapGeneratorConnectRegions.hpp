@@ -0,0 +1,77 @@
+#pragma once
+#include "ThirdParty/XMLParser/XMLParser.hpp"
+#include <string>
+#include <vector>
+#include "Game/MapGenerator.hpp"
+
+
+//Union-find with path halving and union by size; finding a root is effectively constant time
+class DisjointSets
+{
+public:
+	void Reset(int numElements);
+	int FindRoot(int element);
+	bool Union(int elementA, int elementB);
+	int GetSetSize(int element) { return m_sizes[FindRoot(element)]; }
+
+private:
+	std::vector<int> m_parents;
+	std::vector<int> m_sizes;
+};
+
+struct MapRegion
+{
+	int m_size = 0;
+	int m_firstTileIndex = 0;
+	bool m_isCulled = false;
+};
+
+//The cheapest tunnel found between two regions: walls are dug back from both meeting cells to their own region
+struct RegionTunnel
+{
+	int m_regionA;
+	int m_regionB;
+	int m_cost;
+	int m_meetingCellA;
+	int m_meetingCellB;
+
+	bool operator<(const RegionTunnel& other) const;
+};
+
+//Everything one GenerateMap call accumulates. Cells are map tiles in row-major order without the border.
+struct RegionConnectivity
+{
+	IntVector2 m_dimensions;
+	std::vector<bool> m_isOpen;
+	std::vector<bool> m_isDiggable;
+	std::vector<int> m_regionByCell;
+	std::vector<MapRegion> m_regions;
+	std::vector<int> m_tunnelDistance;
+	std::vector<int> m_tunnelParent;
+	std::vector<RegionTunnel> m_tunnels;
+};
+
+//Repair pass for generator stacks that leave pockets of open ground cut off from each other. Open regions are labeled
+//with union-find, regions below minRegionSize are filled in, and the rest are joined by the cheapest set of tunnels that
+//connects them all (a minimum spanning tree over tunnel lengths). Everything runs in time linear in the map's area.
+class MapGeneratorConnectRegions : public MapGenerator
+{
+public:
+	MapGeneratorConnectRegions(XMLNode element);
+
+	virtual void GenerateMap(Map*& outMapToGenerate, RandomStream& random) override;
+
+	TileDefinition* m_tunnelTile = nullptr;
+	TileDefinition* m_cullTile = nullptr;
+	int m_minRegionSize = 0;
+	bool m_connectRegions = true;
+	float m_permanence = 0.5f;
+
+private:
+	void LabelRegions(Map& map, RegionConnectivity& connectivity) const;
+	void CullSmallRegions(Map& map, RegionConnectivity& connectivity, RandomStream& random);
+	void FindCheapestTunnels(RegionConnectivity& connectivity) const;
+	void DigSpanningTunnels(Map& map, RegionConnectivity& connectivity, RandomStream& random);
+	void DigTunnelToRegion(Map& map, const RegionConnectivity& connectivity, int meetingCell, RandomStream& random);
+	Tile* GetTileForCell(Map& map, const RegionConnectivity& connectivity, int cellIndex) const;
+};
@@ -3,7 +3,6 @@
 #include "Engine/Core/XMLUtils.hpp"
 #include "CharacterBuilder.hpp"
 #include "Engine/Math/MathUtils.hpp"
-#include "Engine/Core/StringUtils.hpp"
 
 
 MapGeneratorFromFile::MapGeneratorFromFile(XMLNode element)
@@ -20,123 +19,64 @@ MapGeneratorFromFile::MapGeneratorFromFile(XMLNode element)
 	m_yOffsetRange = ParseXMLAttributeIntVector2(element, "offsetY", IntVector2(0, 0));
 
 	m_permanence = ParseXMLAttributeFloat(element, "permanence", 0.f);
+
+	m_prefab = Prefab::LoadFromFile(m_filename);
 }
 
-void MapGeneratorFromFile::GenerateMap(Map*& outMapToGenerate)
+MapGeneratorFromFile::~MapGeneratorFromFile()
 {
-	XMLNode mapHead = XMLNode::parseFile(m_filename.c_str(), "Map");
+	delete m_prefab;
+}
 
+void MapGeneratorFromFile::GenerateMap(Map*& outMapToGenerate, RandomStream& random)
+{
 	IntVector2 offset;
-	offset.x = GetRandomIntInRange(m_xOffsetRange.x, m_xOffsetRange.y);
-	offset.y = GetRandomIntInRange(m_yOffsetRange.x, m_yOffsetRange.y);
+	offset.x = random.GetRandomIntInRange(m_xOffsetRange.x, m_xOffsetRange.y);
+	offset.y = random.GetRandomIntInRange(m_yOffsetRange.x, m_yOffsetRange.y);
 
 	int rotation;
-	rotation = GetRandomIntInRange(m_rotationRange.x, m_rotationRange.y);
-
-	//Parse legend
-	XMLNode legendNode = mapHead.getChildNode("Legend");
-	std::map<const char, std::string> legend;
-	for (int tileIndex = 0; tileIndex < legendNode.nChildNode("Tile"); tileIndex++)
-	{
-		XMLNode tileNode = legendNode.getChildNode("Tile", tileIndex);
-		const char glyph = ParseXMLAttributeChar(tileNode, "glyph", ' ');
-		std::string tileName = ParseXMLAttributeString(tileNode, "tile", "");
-		ASSERT_OR_DIE(glyph != ' ' && tileName != "", "Missing or invalid glyph or tile name.");
-
-		legend[glyph] = tileName;
-	}
+	rotation = random.GetRandomIntInRange(m_rotationRange.x, m_rotationRange.y);
 
-	//Parse tiles
-	XMLNode tiles = mapHead.getChildNode("Tiles");
-	IntVector2 mapDimensions = ParseXMLAttributeIntVector2(tiles, "dimensions", IntVector2(0, 0));
-
-	ASSERT_OR_DIE(tiles.nChildNode("Row") == mapDimensions.y, "Mismatching number of rows and dimension of map.");
-
-	for (int rowIndex = (tiles.nChildNode("Row") - 1); rowIndex >= 0; rowIndex--)
+	//Stamp tiles
+	IntVector2 prefabCoords;
+	for (prefabCoords.y = 0; prefabCoords.y < m_prefab->m_dimensions.y; prefabCoords.y++)
 	{
-		XMLNode rowNode = tiles.getChildNode("Row", abs(rowIndex - (tiles.nChildNode("Row") - 1)));
-		std::string row = ParseXMLAttributeString(rowNode, "tiles", "");
-		ASSERT_OR_DIE(row.length() == (size_t)mapDimensions.y, "Mismatching length of row and dimension of map.");
-
-		if (m_isMirrored)
-			row = Reverse(row);
-
-		for (size_t glyphIndex = 0; glyphIndex < row.length(); glyphIndex++)
+		for (prefabCoords.x = 0; prefabCoords.x < m_prefab->m_dimensions.x; prefabCoords.x++)
 		{
-			std::map<const char, std::string>::iterator found = legend.find(row.at(glyphIndex));
-			if (found == legend.end())
-				ERROR_AND_DIE("Attempted to use glyph not found in legend.");
+			TileTypeID tileType = m_prefab->GetTileTypeAtIndex((prefabCoords.y * m_prefab->m_dimensions.x) + prefabCoords.x);
+			if (tileType == Prefab::EMPTY_TILE_TYPE)
+				continue;
 
-			IntVector2 tileCoords(glyphIndex, rowIndex);
-			RotateTileCoordsInPlace(tileCoords, rotation, mapDimensions);
-
-			std::string tileTypeName = found->second;
-			if(tileTypeName != "EMPTY")
-			{
-				Tile* tileToChange = outMapToGenerate->GetTileAtTileCoords(tileCoords + offset);
-				if (tileToChange)
-					PlaceTileIfPossible(tileToChange, tileTypeName, m_permanence);
-			}
+			Tile* tileToChange = outMapToGenerate->GetTileAtTileCoords(m_prefab->TransformCoords(prefabCoords, rotation, m_isMirrored) + offset);
+			if (tileToChange)
+				PlaceTileIfPossible(tileToChange, TileDefinition::GetTileDefinition(tileType), m_permanence, random);
 		}
 	}
 
-	//Parse characters
-	XMLNode characters = mapHead.getChildNode("Characters");
-	for (int characterIndex = 0; characterIndex < characters.nChildNode("Character"); characterIndex++)
+	//Place entities
+	for (const PrefabPlacement& characterPlacement : m_prefab->m_characters)
 	{
-		XMLNode characterNode = characters.getChildNode("Character", characterIndex);
-		Character* newCharacter = CharacterBuilder::BuildNewCharacter(ParseXMLAttributeString(characterNode, "name", ""));
-		IntVector2 characterPosition = ParseXMLAttributeIntVector2(characterNode, "position", IntVector2(-1, -1));
-		ASSERT_OR_DIE(characterPosition != IntVector2(-1, -1), "Missing position for character.");
-		RotateTileCoordsInPlace(characterPosition, rotation, mapDimensions);
+		Character* newCharacter = CharacterBuilder::BuildNewCharacter(characterPlacement.m_name, random);
+		IntVector2 characterPosition = m_prefab->TransformCoords(characterPlacement.m_position, rotation, m_isMirrored);
 		outMapToGenerate->PlaceCharacterInMap(newCharacter, outMapToGenerate->GetTileAtTileCoords(characterPosition + offset));
 	}
 
-	//Parse features
-	XMLNode features = mapHead.getChildNode("Features");
-	for (int featureIndex = 0; featureIndex < features.nChildNode("Feature"); featureIndex++)
+	for (const PrefabPlacement& featurePlacement : m_prefab->m_features)
 	{
-		XMLNode featureNode = features.getChildNode("Feature", featureIndex);
-		Feature* newfeature = new Feature(ParseXMLAttributeString(featureNode, "name", ""));
-		IntVector2 featurePosition = ParseXMLAttributeIntVector2(featureNode, "position", IntVector2(-1, -1));
-		ASSERT_OR_DIE(featurePosition != IntVector2(-1, -1), "Missing position for feature.");
-		RotateTileCoordsInPlace(featurePosition, rotation, mapDimensions);
+		Feature* newfeature = new Feature(featurePlacement.m_name);
+		IntVector2 featurePosition = m_prefab->TransformCoords(featurePlacement.m_position, rotation, m_isMirrored);
 		outMapToGenerate->PlaceFeatureInMap(newfeature, outMapToGenerate->GetTileAtTileCoords(featurePosition + offset));
 	}
 
-	//Parse items
-	XMLNode items = mapHead.getChildNode("Items");
-	for (int itemIndex = 0; itemIndex < items.nChildNode("Item"); itemIndex++)
+	for (const PrefabPlacement& itemPlacement : m_prefab->m_items)
 	{
-		XMLNode itemNode = items.getChildNode("Item", itemIndex);
-		Item* newItem = new Item(ParseXMLAttributeString(itemNode, "name", ""));
-		IntVector2 itemPosition = ParseXMLAttributeIntVector2(itemNode, "position", IntVector2(-1, -1));
-		ASSERT_OR_DIE(itemPosition != IntVector2(-1, -1), "Missing position for item.");
-		RotateTileCoordsInPlace(itemPosition, rotation, mapDimensions);
+		Item* newItem = new Item(itemPlacement.m_name, random);
+		IntVector2 itemPosition = m_prefab->TransformCoords(itemPlacement.m_position, rotation, m_isMirrored);
 		outMapToGenerate->PlaceItemInMap(newItem, outMapToGenerate->GetTileAtTileCoords(itemPosition + offset));
 	}
 }
 
-void MapGeneratorFromFile::RotateTileCoordsInPlace(IntVector2& coordsToRotate, int rotation, const IntVector2& dimensions)
+std::string MapGeneratorFromFile::GetCacheKeyData() const
 {
-	switch (rotation)
-	{
-	case 0:
-		break;
-	case 1:
-		coordsToRotate.Rotate90Degrees();
-		coordsToRotate.x += dimensions.y;
-		break;
-	case 2:
-		coordsToRotate.Rotate90Degrees();
-		coordsToRotate.Rotate90Degrees();
-		coordsToRotate = coordsToRotate + dimensions;
-		break;
-	case 3:
-		coordsToRotate.Rotate90Degrees();
-		coordsToRotate.Rotate90Degrees();
-		coordsToRotate.Rotate90Degrees();
-		coordsToRotate.y += dimensions.x;
-		break;
-	}
+	return m_prefab->GetSourceData();
 }
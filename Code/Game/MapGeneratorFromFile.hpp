@@ -1,15 +1,18 @@
 #pragma once
-#include "ThirdParty\XMLParser\XMLParser.hpp"
+#include "ThirdParty/XMLParser/XMLParser.hpp"
 #include <string>
 #include "Game/MapGenerator.hpp"
+#include "Game/Prefab.hpp"
 
 
 class MapGeneratorFromFile : public MapGenerator
 {
 public:
 	MapGeneratorFromFile(XMLNode element);
+	~MapGeneratorFromFile();
 
-	virtual void GenerateMap(Map*& outMapToGenerate) override;
+	virtual void GenerateMap(Map*& outMapToGenerate, RandomStream& random) override;
+	virtual std::string GetCacheKeyData() const override;
 
 	std::string m_filename;
 	IntVector2 m_rotationRange;
@@ -17,6 +20,5 @@ public:
 	IntVector2 m_xOffsetRange;
 	IntVector2 m_yOffsetRange;
 	float m_permanence;
-private:
-	void RotateTileCoordsInPlace(IntVector2& coordsToRotate, int rotation, const IntVector2& dimensions);
+	Prefab* m_prefab;
 };
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "Game/MapGeneratorOverworld.hpp"
+#include "Game/OverworldStreamer.hpp"
+#include "Game/MapDefinition.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/XMLUtils.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Core/Noise.hpp"
+#include <algorithm>
+
+
+MapGeneratorOverworld::MapGeneratorOverworld(XMLNode element)
+	: MapGenerator(element)
+{
+	m_chunkSize = ParseXMLAttributeInt(element, "chunkSize", m_chunkSize);
+	m_prefetchRadius = ParseXMLAttributeInt(element, "prefetchChunks", m_prefetchRadius);
+	m_memoryBudgetKB = ParseXMLAttributeInt(element, "memoryBudgetKB", m_memoryBudgetKB);
+	m_compressedBudgetKB = ParseXMLAttributeInt(element, "compressedBudgetKB", m_compressedBudgetKB);
+	m_perlinScale = ParseXMLAttributeFloat(element, "scale", m_perlinScale);
+	m_numOctaves = ParseXMLAttributeInt(element, "octaves", m_numOctaves);
+	m_octavePersistance = ParseXMLAttributeFloat(element, "octavePersistance", m_octavePersistance);
+	m_octaveScale = ParseXMLAttributeFloat(element, "octaveScale", m_octaveScale);
+	m_smoothingIterations = ParseXMLAttributeInt(element, "smoothingIterations", m_smoothingIterations);
+	m_smoothingThreshold = ParseXMLAttributeInt(element, "smoothingThreshold", m_smoothingThreshold);
+	m_permanence = ParseXMLAttributeFloat(element, "permanence", m_permanence);
+	ASSERT_OR_DIE(m_chunkSize > 0 && m_prefetchRadius >= 0 && m_smoothingIterations >= 0, "Invalid chunk settings for Overworld.");
+
+	ASSERT_OR_DIE(element.nChildNode("Band") > 0, "No bands for Overworld.");
+	for (int bandIndex = 0; bandIndex < element.nChildNode("Band"); bandIndex++)
+	{
+		XMLNode bandElement = element.getChildNode("Band", bandIndex);
+		TileDefinition* tileDefinition = TileDefinition::GetTileDefinition(ParseXMLAttributeString(bandElement, "tile", ""));
+		ASSERT_OR_DIE(tileDefinition, "Unknown tile type used in Overworld band.");
+
+		OverworldNoiseBand newBand;
+		newBand.m_upperBound = ParseXMLAttributeFloat(bandElement, "below", 1.f);
+		newBand.m_tileType = tileDefinition->m_typeID;
+		m_noiseBands.push_back(newBand);
+	}
+
+	std::sort(m_noiseBands.begin(), m_noiseBands.end(), [](const OverworldNoiseBand& bandA, const OverworldNoiseBand& bandB)
+	{
+		return bandA.m_upperBound < bandB.m_upperBound;
+	});
+}
+
+//Fills the map window around world origin and hands the map a streamer to keep sliding it from then on
+void MapGeneratorOverworld::GenerateMap(Map*& outMapToGenerate, RandomStream& random)
+{
+	unsigned int noiseSeed = random.GetRandomUnsignedInt();
+	IntVector2 dimensions = outMapToGenerate->m_definition->m_dimensions;
+
+	delete outMapToGenerate->m_overworldStreamer;
+	OverworldStreamer* streamer = new OverworldStreamer(this, noiseSeed, dimensions);
+	outMapToGenerate->m_overworldStreamer = streamer;
+	outMapToGenerate->m_overworldOrigin = IntVector2(-(dimensions.x / 2), -(dimensions.y / 2));
+
+	IntVector2 windowCenter = outMapToGenerate->m_overworldOrigin + IntVector2(dimensions.x / 2, dimensions.y / 2);
+	streamer->RequestChunksAround(windowCenter, streamer->GetWindowRadiusInChunks() + m_prefetchRadius);
+
+	for (int yIndex = 0; yIndex < dimensions.y; yIndex++)
+	{
+		for (int xIndex = 0; xIndex < dimensions.x; xIndex++)
+		{
+			IntVector2 tileCoords(xIndex, yIndex);
+			TileTypeID tileType = streamer->GetTileTypeBlocking(outMapToGenerate->m_overworldOrigin + tileCoords);
+			PlaceTileIfPossible(outMapToGenerate->GetTileAtTileCoords(tileCoords), TileDefinition::GetTileDefinition(tileType), m_permanence, random);
+		}
+	}
+}
+
+void MapGeneratorOverworld::GenerateChunkTileTypes(const IntVector2& chunkCoords, unsigned int noiseSeed, std::vector<TileTypeID>& out_tileTypes) const
+{
+	//Each smoothing pass consumes one tile of apron, so the chunk itself ends up with every neighbor it needs
+	int apron = m_smoothingIterations;
+	int paddedSize = m_chunkSize + (2 * apron);
+	IntVector2 paddedOrigin((chunkCoords.x * m_chunkSize) - apron, (chunkCoords.y * m_chunkSize) - apron);
+
+	std::vector<unsigned char> bands(paddedSize * paddedSize);
+	for (int yIndex = 0; yIndex < paddedSize; yIndex++)
+	{
+		for (int xIndex = 0; xIndex < paddedSize; xIndex++)
+		{
+			float noise = Compute2dPerlinNoise((float)(paddedOrigin.x + xIndex), (float)(paddedOrigin.y + yIndex), m_perlinScale, m_numOctaves, m_octavePersistance, m_octaveScale, true, noiseSeed);
+			bands[(yIndex * paddedSize) + xIndex] = (unsigned char)GetNoiseBandIndex(RangeMapFloat(noise, -1.f, 1.f, 0.f, 1.f));
+		}
+	}
+
+	//A tile takes its neighbors' most common band once enough of them agree. Ties go to the lower band so the result never depends on scan order.
+	std::vector<unsigned char> smoothedBands(bands);
+	std::vector<int> neighborCounts(m_noiseBands.size());
+	for (int iterationIndex = 0; iterationIndex < m_smoothingIterations; iterationIndex++)
+	{
+		int firstIndex = iterationIndex + 1;
+		int lastIndex = paddedSize - iterationIndex - 2;
+		for (int yIndex = firstIndex; yIndex <= lastIndex; yIndex++)
+		{
+			for (int xIndex = firstIndex; xIndex <= lastIndex; xIndex++)
+			{
+				std::fill(neighborCounts.begin(), neighborCounts.end(), 0);
+				for (int yOffset = -1; yOffset <= 1; yOffset++)
+				{
+					for (int xOffset = -1; xOffset <= 1; xOffset++)
+					{
+						if (xOffset != 0 || yOffset != 0)
+							neighborCounts[bands[((yIndex + yOffset) * paddedSize) + xIndex + xOffset]]++;
+					}
+				}
+
+				int mostCommonBand = 0;
+				for (int bandIndex = 1; bandIndex < (int)neighborCounts.size(); bandIndex++)
+				{
+					if (neighborCounts[bandIndex] > neighborCounts[mostCommonBand])
+						mostCommonBand = bandIndex;
+				}
+
+				int tileIndex = (yIndex * paddedSize) + xIndex;
+				smoothedBands[tileIndex] = (neighborCounts[mostCommonBand] >= m_smoothingThreshold) ? (unsigned char)mostCommonBand : bands[tileIndex];
+			}
+		}
+
+		bands.swap(smoothedBands);
+		smoothedBands = bands;
+	}
+
+	out_tileTypes.resize(m_chunkSize * m_chunkSize);
+	for (int yIndex = 0; yIndex < m_chunkSize; yIndex++)
+	{
+		for (int xIndex = 0; xIndex < m_chunkSize; xIndex++)
+		{
+			out_tileTypes[(yIndex * m_chunkSize) + xIndex] = m_noiseBands[bands[((yIndex + apron) * paddedSize) + xIndex + apron]].m_tileType;
+		}
+	}
+}
+
+int MapGeneratorOverworld::GetNoiseBandIndex(float noise) const
+{
+	for (size_t bandIndex = 0; bandIndex < m_noiseBands.size(); bandIndex++)
+	{
+		if (noise < m_noiseBands[bandIndex].m_upperBound)
+			return (int)bandIndex;
+	}
+
+	return (int)m_noiseBands.size() - 1;
+}
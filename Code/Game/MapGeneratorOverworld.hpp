@@ -0,0 +1,41 @@
+#pragma once
+#include "ThirdParty/XMLParser/XMLParser.hpp"
+#include <string>
+#include <vector>
+#include "Game/MapGenerator.hpp"
+
+
+struct OverworldNoiseBand
+{
+	float m_upperBound;
+	TileTypeID m_tileType;
+};
+
+//Generates an unbounded overworld chunk by chunk. Each chunk is a pure function of the noise seed and its chunk coordinates:
+//Perlin noise in world space picks a band per tile, then a majority cellular automaton smooths the bands. The smoothing
+//reads an apron around the chunk, so neighboring chunks agree at their seams. The map itself is a window that the
+//OverworldStreamer slides across the world as the player moves.
+class MapGeneratorOverworld : public MapGenerator
+{
+public:
+	MapGeneratorOverworld(XMLNode element);
+
+	virtual void GenerateMap(Map*& outMapToGenerate, RandomStream& random) override;
+	void GenerateChunkTileTypes(const IntVector2& chunkCoords, unsigned int noiseSeed, std::vector<TileTypeID>& out_tileTypes) const;
+
+	int m_chunkSize = 16;
+	int m_prefetchRadius = 1;
+	int m_memoryBudgetKB = 256;
+	int m_compressedBudgetKB = 1024;
+	float m_perlinScale = 24.f;
+	unsigned int m_numOctaves = 3;
+	float m_octavePersistance = 0.5f;
+	float m_octaveScale = 2.f;
+	int m_smoothingIterations = 2;
+	int m_smoothingThreshold = 5;
+	float m_permanence = 0.5f;
+	std::vector<OverworldNoiseBand> m_noiseBands;
+
+private:
+	int GetNoiseBandIndex(float noise) const;
+};
@@ -5,6 +5,35 @@
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Core/StringUtils.hpp"
 #include "Engine/Core/Noise.hpp"
+#include "Game/JobSystem.hpp"
+#include "Game/MapDefinition.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <stdio.h>
+
+
+const int MapGeneratorPerlinNoise::ROWS_PER_JOB = 16;
+std::map<PerlinNoiseFieldKey, std::vector<float>> MapGeneratorPerlinNoise::s_noiseFieldCache;
+std::mutex MapGeneratorPerlinNoise::s_noiseFieldCacheMutex;
+
+
+bool PerlinNoiseFieldKey::operator<(const PerlinNoiseFieldKey& other) const
+{
+	if (m_seed != other.m_seed)
+		return m_seed < other.m_seed;
+	if (m_perlinScale != other.m_perlinScale)
+		return m_perlinScale < other.m_perlinScale;
+	if (m_numOctaves != other.m_numOctaves)
+		return m_numOctaves < other.m_numOctaves;
+	if (m_octavePersistance != other.m_octavePersistance)
+		return m_octavePersistance < other.m_octavePersistance;
+	if (m_octaveScale != other.m_octaveScale)
+		return m_octaveScale < other.m_octaveScale;
+	if (m_width != other.m_width)
+		return m_width < other.m_width;
+	return m_height < other.m_height;
+}
+
 
 MapGeneratorPerlinNoise::MapGeneratorPerlinNoise(XMLNode element)
 	: MapGenerator(element)
@@ -13,7 +42,10 @@ MapGeneratorPerlinNoise::MapGeneratorPerlinNoise(XMLNode element)
 	m_numOctaves = ParseXMLAttributeInt(element, "octaves", m_numOctaves);
 	m_octavePersistance = ParseXMLAttributeFloat(element, "octavePersistance", m_octavePersistance);
 	m_octaveScale = ParseXMLAttributeFloat(element, "octaveScale", m_octaveScale);
+	//Without a fixed seed, the noise seed comes from the map's generator stream
+	m_hasFixedSeed = !ParseXMLAttributeString(element, "seed", "").empty();
 	m_seed = ParseXMLAttributeInt(element, "seed", m_seed);
+	m_cacheNoiseField = ParseXMLAttributeBool(element, "cacheNoise", m_cacheNoiseField);
 
 	ASSERT_OR_DIE(element.nChildNode("Rule") > 0, "No rules for Perlin Noise.");
 	for (int ruleIndex = 0; ruleIndex < element.nChildNode("Rule"); ruleIndex++)
@@ -22,26 +54,59 @@ MapGeneratorPerlinNoise::MapGeneratorPerlinNoise(XMLNode element)
 	}
 
 	m_permanence = ParseXMLAttributeFloat(element, "permanence", m_permanence);
+
+	CompileNoiseBands();
+}
+
+void MapGeneratorPerlinNoise::GenerateMap(Map*& outMapToGenerate, RandomStream& random)
+{
+	unsigned int noiseSeed = ChooseNoiseSeed(random);
+	ApplyRulesToMap(outMapToGenerate, noiseSeed, random);
 }
 
-void MapGeneratorPerlinNoise::GenerateMap(Map*& outMapToGenerate)
+//Always draws, so the rest of the generator stream is the same whether or not the seed is fixed
+unsigned int MapGeneratorPerlinNoise::ChooseNoiseSeed(RandomStream& random) const
 {
-	ApplyRulesToMap(outMapToGenerate);
+	unsigned int noiseSeed = random.GetRandomUnsignedInt();
+	if (m_hasFixedSeed)
+		noiseSeed = m_seed;
+
+	return noiseSeed;
 }
 
-void MapGeneratorPerlinNoise::ApplyRulesToMap(Map*& outMapToGenerate)
+void MapGeneratorPerlinNoise::ApplyRulesToMap(Map*& outMapToGenerate, unsigned int noiseSeed, RandomStream& random)
 {
-	for (size_t tileIndex = 0; tileIndex < outMapToGenerate->m_tiles.size(); tileIndex++)
+	IntVector2 dimensions = outMapToGenerate->m_definition->m_dimensions;
+	std::vector<float> noiseField;
+	GetNoiseField(dimensions, noiseSeed, noiseField);
+
+	for (int yIndex = 0; yIndex < dimensions.y; yIndex++)
 	{
-		IntVector2 tileCoords = outMapToGenerate->CalculateTileCoordsFromTileIndex(tileIndex);
-		float noise = Compute2dPerlinNoise((float)tileCoords.x, (float)tileCoords.y, m_perlinScale, m_numOctaves, m_octavePersistance, m_octaveScale, true, m_seed);
-		noise = RangeMapFloat(noise, -1.f, 1.f, 0.f, 1.f);
-		for (PerlinNoiseRule rule : m_rules)
+		for (int xIndex = 0; xIndex < dimensions.x; xIndex++)
 		{
-			if(outMapToGenerate->m_tiles[tileIndex].m_tileDefinition->m_name == rule.m_ifTile)
+			Tile* tile = outMapToGenerate->GetTileAtTileIndex(outMapToGenerate->CalculateTileIndexFromTileCoords(IntVector2(xIndex, yIndex)));
+			int bandIndex = GetNoiseBandIndex(noiseField[(yIndex * dimensions.x) + xIndex]);
+
+			//Rules run in file order. When one changes the tile, carry on with the later rules listed for the new type.
+			int lastRuleIndex = -1;
+			const std::vector<PerlinNoiseAction>* actions = &GetNoiseBandActions(bandIndex, tile->m_tileDefinition->m_typeID);
+			for (int actionIndex = 0; actionIndex < (int)actions->size(); actionIndex++)
 			{
-				if (noise >= rule.m_ifGreaterThanNumber && noise <= rule.m_ifLessThanNumber && GetRandomFloatZeroToOne() < rule.m_chanceToRunPerTile)
-					PlaceTileIfPossible(&outMapToGenerate->m_tiles[tileIndex], rule.m_changeToTile, m_permanence);
+				const PerlinNoiseAction& action = (*actions)[actionIndex];
+				if (action.m_ruleIndex <= lastRuleIndex)
+					continue;
+
+				lastRuleIndex = action.m_ruleIndex;
+				if (random.GetRandomFloatZeroToOne() >= action.m_chanceToRunPerTile)
+					continue;
+
+				TileTypeID oldType = tile->m_tileDefinition->m_typeID;
+				PlaceTileIfPossible(tile, action.m_changeToTileDefinition, m_permanence, random);
+				if (tile->m_tileDefinition->m_typeID != oldType)
+				{
+					actions = &GetNoiseBandActions(bandIndex, tile->m_tileDefinition->m_typeID);
+					actionIndex = -1;
+				}
 			}
 		}
 	}
@@ -60,5 +125,198 @@ void MapGeneratorPerlinNoise::ParseRule(XMLNode ruleElement)
 	newRule.m_ifGreaterThanNumber = ParseXMLAttributeFloat(ruleElement, "ifGreaterThan", newRule.m_ifGreaterThanNumber);
 	newRule.m_ifLessThanNumber = ParseXMLAttributeFloat(ruleElement, "ifLessThan", newRule.m_ifLessThanNumber);
 
+	TileDefinition* ifTileDefinition = TileDefinition::GetTileDefinition(newRule.m_ifTile);
+	newRule.m_changeToTileDefinition = TileDefinition::GetTileDefinition(newRule.m_changeToTile);
+	ASSERT_OR_DIE(ifTileDefinition && newRule.m_changeToTileDefinition, "Unknown tile type used in Perlin Noise rule.");
+	newRule.m_ifTileID = ifTileDefinition->m_typeID;
+
 	m_rules.push_back(newRule);
 }
+
+//Every rule threshold splits the noise range. Bands alternate between the open range below a threshold and the threshold itself,
+//and each band lists, per source tile type, the rules whose inclusive range covers it in their original order.
+void MapGeneratorPerlinNoise::CompileNoiseBands()
+{
+	m_bandThresholds.clear();
+	for (const PerlinNoiseRule& rule : m_rules)
+	{
+		m_bandThresholds.push_back(rule.m_ifGreaterThanNumber);
+		m_bandThresholds.push_back(rule.m_ifLessThanNumber);
+	}
+	std::sort(m_bandThresholds.begin(), m_bandThresholds.end());
+	m_bandThresholds.erase(std::unique(m_bandThresholds.begin(), m_bandThresholds.end()), m_bandThresholds.end());
+
+	int numThresholds = (int)m_bandThresholds.size();
+	m_numNoiseBands = (numThresholds * 2) + 1;
+	m_numSourceTypes = (int)TileDefinition::s_tileDefinitionsByID.size();
+	m_noiseBandActions.clear();
+	m_noiseBandActions.resize(m_numNoiseBands * m_numSourceTypes);
+	for (int bandIndex = 0; bandIndex < m_numNoiseBands; bandIndex++)
+	{
+		int thresholdIndex = bandIndex / 2;
+		float sampleNoise;
+		if (bandIndex % 2 == 1)
+			sampleNoise = m_bandThresholds[thresholdIndex];
+		else if (thresholdIndex == 0)
+			sampleNoise = m_bandThresholds[0] - 1.f;
+		else if (thresholdIndex == numThresholds)
+			sampleNoise = m_bandThresholds[numThresholds - 1] + 1.f;
+		else
+			sampleNoise = (m_bandThresholds[thresholdIndex - 1] + m_bandThresholds[thresholdIndex]) * 0.5f;
+
+		for (size_t ruleIndex = 0; ruleIndex < m_rules.size(); ruleIndex++)
+		{
+			const PerlinNoiseRule& rule = m_rules[ruleIndex];
+			if (sampleNoise >= rule.m_ifGreaterThanNumber && sampleNoise <= rule.m_ifLessThanNumber)
+			{
+				PerlinNoiseAction newAction;
+				newAction.m_ruleIndex = (int)ruleIndex;
+				newAction.m_changeToTileDefinition = rule.m_changeToTileDefinition;
+				newAction.m_chanceToRunPerTile = rule.m_chanceToRunPerTile;
+				m_noiseBandActions[(bandIndex * m_numSourceTypes) + rule.m_ifTileID].push_back(newAction);
+			}
+		}
+	}
+}
+
+int MapGeneratorPerlinNoise::GetNoiseBandIndex(float noise) const
+{
+	int thresholdIndex = (int)(std::lower_bound(m_bandThresholds.begin(), m_bandThresholds.end(), noise) - m_bandThresholds.begin());
+	if (thresholdIndex < (int)m_bandThresholds.size() && m_bandThresholds[thresholdIndex] == noise)
+		return (thresholdIndex * 2) + 1;
+	else
+		return thresholdIndex * 2;
+}
+
+const std::vector<PerlinNoiseAction>& MapGeneratorPerlinNoise::GetNoiseBandActions(int bandIndex, TileTypeID sourceType) const
+{
+	static const std::vector<PerlinNoiseAction> s_noActions;
+	if (sourceType >= m_numSourceTypes)
+		return s_noActions;
+
+	return m_noiseBandActions[(bandIndex * m_numSourceTypes) + sourceType];
+}
+
+std::string MapGeneratorPerlinNoise::BenchmarkRules(Map* mapToBenchmarkOn, int numRepetitions) const
+{
+	//Rebuild the noise field this generator used when it generated the map, from the same generator stream
+	MapDefinition* definition = mapToBenchmarkOn->m_definition;
+	std::vector<MapGenerator*>::const_iterator found = std::find(definition->m_generators.begin(), definition->m_generators.end(), this);
+	ASSERT_OR_DIE(found != definition->m_generators.end(), "Perlin noise benchmark run on a map its generator did not build.");
+	RandomStream generatorRandom(definition->GetGeneratorSeed(mapToBenchmarkOn, (unsigned int)(found - definition->m_generators.begin())));
+
+	std::vector<float> noiseField;
+	GetNoiseField(definition->m_dimensions, ChooseNoiseSeed(generatorRandom), noiseField);
+
+	int numInterpretedMatches = 0;
+	double startSeconds = GetCurrentTimeSeconds();
+	for (int repetitionIndex = 0; repetitionIndex < numRepetitions; repetitionIndex++)
+	{
+		numInterpretedMatches = CountRuleMatchesInterpreted(*mapToBenchmarkOn, noiseField);
+	}
+	double interpretedSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	int numCompiledMatches = 0;
+	startSeconds = GetCurrentTimeSeconds();
+	for (int repetitionIndex = 0; repetitionIndex < numRepetitions; repetitionIndex++)
+	{
+		numCompiledMatches = CountRuleMatchesCompiled(*mapToBenchmarkOn, noiseField);
+	}
+	double compiledSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	char resultLine[256];
+	snprintf(resultLine, sizeof(resultLine), "Perlin noise \"%s\": interpreted %.4f ms, compiled %.4f ms per pass (%d / %d rule matches)", m_name.c_str(), (interpretedSeconds * 1000.0) / numRepetitions, (compiledSeconds * 1000.0) / numRepetitions, numInterpretedMatches, numCompiledMatches);
+	return resultLine;
+}
+
+//Rule evaluation the way it was done before rules were compiled, kept to compare against
+int MapGeneratorPerlinNoise::CountRuleMatchesInterpreted(const Map& map, const std::vector<float>& noiseField) const
+{
+	IntVector2 dimensions = map.m_definition->m_dimensions;
+	int numMatches = 0;
+	for (int yIndex = 0; yIndex < dimensions.y; yIndex++)
+	{
+		for (int xIndex = 0; xIndex < dimensions.x; xIndex++)
+		{
+			const Tile& tile = map.m_tiles[map.CalculateTileIndexFromTileCoords(IntVector2(xIndex, yIndex))];
+			float noise = noiseField[(yIndex * dimensions.x) + xIndex];
+			for (PerlinNoiseRule rule : m_rules)
+			{
+				if (tile.m_tileDefinition->m_name == rule.m_ifTile && noise >= rule.m_ifGreaterThanNumber && noise <= rule.m_ifLessThanNumber)
+					numMatches++;
+			}
+		}
+	}
+
+	return numMatches;
+}
+
+int MapGeneratorPerlinNoise::CountRuleMatchesCompiled(const Map& map, const std::vector<float>& noiseField) const
+{
+	IntVector2 dimensions = map.m_definition->m_dimensions;
+	int numMatches = 0;
+	for (int yIndex = 0; yIndex < dimensions.y; yIndex++)
+	{
+		for (int xIndex = 0; xIndex < dimensions.x; xIndex++)
+		{
+			const Tile& tile = map.m_tiles[map.CalculateTileIndexFromTileCoords(IntVector2(xIndex, yIndex))];
+			int bandIndex = GetNoiseBandIndex(noiseField[(yIndex * dimensions.x) + xIndex]);
+			numMatches += (int)GetNoiseBandActions(bandIndex, tile.m_tileDefinition->m_typeID).size();
+		}
+	}
+
+	return numMatches;
+}
+
+void MapGeneratorPerlinNoise::GetNoiseField(const IntVector2& dimensions, unsigned int noiseSeed, std::vector<float>& out_noiseField) const
+{
+	if (!m_cacheNoiseField || !m_hasFixedSeed)
+	{
+		ComputeNoiseField(dimensions, noiseSeed, out_noiseField);
+		return;
+	}
+
+	PerlinNoiseFieldKey key;
+	key.m_seed = noiseSeed;
+	key.m_perlinScale = m_perlinScale;
+	key.m_numOctaves = m_numOctaves;
+	key.m_octavePersistance = m_octavePersistance;
+	key.m_octaveScale = m_octaveScale;
+	key.m_width = dimensions.x;
+	key.m_height = dimensions.y;
+
+	{
+		std::lock_guard<std::mutex> lock(s_noiseFieldCacheMutex);
+		std::map<PerlinNoiseFieldKey, std::vector<float>>::iterator found = s_noiseFieldCache.find(key);
+		if (found != s_noiseFieldCache.end())
+		{
+			out_noiseField = found->second;
+			return;
+		}
+	}
+
+	ComputeNoiseField(dimensions, noiseSeed, out_noiseField);
+
+	std::lock_guard<std::mutex> lock(s_noiseFieldCacheMutex);
+	s_noiseFieldCache[key] = out_noiseField;
+}
+
+void MapGeneratorPerlinNoise::ComputeNoiseField(const IntVector2& dimensions, unsigned int noiseSeed, std::vector<float>& out_noiseField) const
+{
+	out_noiseField.resize(dimensions.x * dimensions.y);
+	int numJobs = (dimensions.y + ROWS_PER_JOB - 1) / ROWS_PER_JOB;
+	RunParallelFor(numJobs, [&](int jobIndex)
+	{
+		int firstRow = jobIndex * ROWS_PER_JOB;
+		int lastRow = std::min(firstRow + ROWS_PER_JOB, dimensions.y);
+		for (int yIndex = firstRow; yIndex < lastRow; yIndex++)
+		{
+			float* noiseRow = &out_noiseField[yIndex * dimensions.x];
+			for (int xIndex = 0; xIndex < dimensions.x; xIndex++)
+			{
+				float noise = Compute2dPerlinNoise((float)xIndex, (float)yIndex, m_perlinScale, m_numOctaves, m_octavePersistance, m_octaveScale, true, noiseSeed);
+				noiseRow[xIndex] = RangeMapFloat(noise, -1.f, 1.f, 0.f, 1.f);
+			}
+		}
+	});
+}
@@ -1,8 +1,8 @@
 #pragma once
-#include "ThirdParty\XMLParser\XMLParser.hpp"
+#include "ThirdParty/XMLParser/XMLParser.hpp"
 #include <string>
 #include "Game/MapGenerator.hpp"
-#include <time.h>
+#include <mutex>
 
 struct PerlinNoiseRule
 {
@@ -11,22 +11,72 @@ struct PerlinNoiseRule
 	float m_ifGreaterThanNumber = 0.f;
 	float m_ifLessThanNumber = 1.f;
 	float m_chanceToRunPerTile = 1.f;
+
+	TileTypeID m_ifTileID = 0;
+	TileDefinition* m_changeToTileDefinition = nullptr;
+};
+
+//What a rule does to a tile once its noise band and source type are already known
+struct PerlinNoiseAction
+{
+	int m_ruleIndex;
+	TileDefinition* m_changeToTileDefinition;
+	float m_chanceToRunPerTile;
+};
+
+struct PerlinNoiseFieldKey
+{
+	unsigned int m_seed;
+	float m_perlinScale;
+	unsigned int m_numOctaves;
+	float m_octavePersistance;
+	float m_octaveScale;
+	int m_width;
+	int m_height;
+
+	bool operator<(const PerlinNoiseFieldKey& other) const;
 };
 
 class MapGeneratorPerlinNoise : public MapGenerator
 {
 public:
 	MapGeneratorPerlinNoise(XMLNode element);
-	virtual void GenerateMap(Map*& outMapToGenerate) override;
+	virtual void GenerateMap(Map*& outMapToGenerate, RandomStream& random) override;
+	virtual std::string BenchmarkRules(Map* mapToBenchmarkOn, int numRepetitions) const override;
 
 	std::vector<PerlinNoiseRule> m_rules;
 	float m_perlinScale = 30.f;
 	unsigned int m_numOctaves = 3;
 	float m_octavePersistance = 0.5f;
 	float m_octaveScale = 2.f;
-	unsigned int m_seed = (unsigned int)time(NULL);
+	unsigned int m_seed = 0;
+	bool m_hasFixedSeed = false;
 	float m_permanence = 0.5f;
+	bool m_cacheNoiseField = true;			//Ignored without a fixed seed
+
+	static const int ROWS_PER_JOB;
 private:
-	void ApplyRulesToMap(Map*& outMapToGenerate);
+	unsigned int ChooseNoiseSeed(RandomStream& random) const;
+	void ApplyRulesToMap(Map*& outMapToGenerate, unsigned int noiseSeed, RandomStream& random);
 	void ParseRule(XMLNode ruleElement);
-};
\ No newline at end of file
+	void CompileNoiseBands();
+	int GetNoiseBandIndex(float noise) const;
+	const std::vector<PerlinNoiseAction>& GetNoiseBandActions(int bandIndex, TileTypeID sourceType) const;
+	int CountRuleMatchesInterpreted(const Map& map, const std::vector<float>& noiseField) const;
+	int CountRuleMatchesCompiled(const Map& map, const std::vector<float>& noiseField) const;
+
+	void GetNoiseField(const IntVector2& dimensions, unsigned int noiseSeed, std::vector<float>& out_noiseField) const;
+	void ComputeNoiseField(const IntVector2& dimensions, unsigned int noiseSeed, std::vector<float>& out_noiseField) const;
+
+	//A noise band is either a single threshold value or the open range between two neighboring thresholds.
+	//Actions are stored per band and source tile type, at (bandIndex * m_numSourceTypes) + sourceType.
+	std::vector<float> m_bandThresholds;
+	int m_numNoiseBands = 0;
+	int m_numSourceTypes = 0;
+	std::vector<std::vector<PerlinNoiseAction>> m_noiseBandActions;
+
+	//Only generators with a seed fixed in XML use the cache, since only they produce the same field every time. Other
+	//generators draw a new seed per map, so caching their fields would grow the cache by one field for every map made.
+	static std::map<PerlinNoiseFieldKey, std::vector<float>> s_noiseFieldCache;
+	static std::mutex s_noiseFieldCacheMutex;
+};
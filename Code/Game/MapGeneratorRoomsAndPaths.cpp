@@ -4,12 +4,132 @@
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Game/Map.hpp"
 #include "Game/MapDefinition.hpp"
+#include <algorithm>
+
+
+static int ClampCoordinate(int coordinate, int minCoordinate, int maxCoordinate)
+{
+	if (coordinate < minCoordinate)
+		return minCoordinate;
+	if (coordinate > maxCoordinate)
+		return maxCoordinate;
+	return coordinate;
+}
+
+
+RoomOccupancyGrid::RoomOccupancyGrid(const IntVector2& dimensions)
+	: m_dimensions(dimensions)
+	, m_isTileOccupied(dimensions.x * dimensions.y, false)
+	, m_occupiedTileTree((dimensions.x + 1) * (dimensions.y + 1), 0)
+{
+}
+
+void RoomOccupancyGrid::MarkOccupied(const IntVector2& mins, const IntVector2& maxsInclusive)
+{
+	IntVector2 clampedMins(ClampCoordinate(mins.x, 0, m_dimensions.x), ClampCoordinate(mins.y, 0, m_dimensions.y));
+	IntVector2 clampedEnds(ClampCoordinate(maxsInclusive.x + 1, 0, m_dimensions.x), ClampCoordinate(maxsInclusive.y + 1, 0, m_dimensions.y));
+	for (int yIndex = clampedMins.y; yIndex < clampedEnds.y; yIndex++)
+	{
+		for (int xIndex = clampedMins.x; xIndex < clampedEnds.x; xIndex++)
+		{
+			int tileIndex = (yIndex * m_dimensions.x) + xIndex;
+			if (m_isTileOccupied[tileIndex])
+				continue;
+
+			m_isTileOccupied[tileIndex] = true;
+			for (int treeY = yIndex + 1; treeY <= m_dimensions.y; treeY += (treeY & -treeY))
+			{
+				int* treeRow = &m_occupiedTileTree[treeY * (m_dimensions.x + 1)];
+				for (int treeX = xIndex + 1; treeX <= m_dimensions.x; treeX += (treeX & -treeX))
+				{
+					treeRow[treeX]++;
+				}
+			}
+		}
+	}
+}
+
+bool RoomOccupancyGrid::IsAreaFree(const IntVector2& mins, const IntVector2& maxsInclusive) const
+{
+	IntVector2 clampedMins(ClampCoordinate(mins.x, 0, m_dimensions.x), ClampCoordinate(mins.y, 0, m_dimensions.y));
+	IntVector2 clampedEnds(ClampCoordinate(maxsInclusive.x + 1, 0, m_dimensions.x), ClampCoordinate(maxsInclusive.y + 1, 0, m_dimensions.y));
+	if (clampedMins.x >= clampedEnds.x || clampedMins.y >= clampedEnds.y)
+		return true;
+
+	int occupancy = CountOccupiedTilesBefore(clampedEnds.x, clampedEnds.y) - CountOccupiedTilesBefore(clampedMins.x, clampedEnds.y)
+		- CountOccupiedTilesBefore(clampedEnds.x, clampedMins.y) + CountOccupiedTilesBefore(clampedMins.x, clampedMins.y);
+	return occupancy == 0;
+}
+
+//Lists, in row order, every mins in [minimumMins, maximumMins] whose area is free and inside the grid. One pass over the marks
+//measures the free run to the right of each tile, and counts the consecutive rows, going up from each tile, whose run there is
+//at least as wide as the area. The area fits wherever that count reaches its height.
+void RoomOccupancyGrid::FindFreeAreas(const IntVector2& areaDimensions, const IntVector2& minimumMins, const IntVector2& maximumMins, std::vector<IntVector2>& out_freeMins) const
+{
+	out_freeMins.clear();
+	IntVector2 clampedMinimum(std::max(minimumMins.x, 0), std::max(minimumMins.y, 0));
+	IntVector2 clampedMaximum(std::min(maximumMins.x, m_dimensions.x - areaDimensions.x), std::min(maximumMins.y, m_dimensions.y - areaDimensions.y));
+	if (areaDimensions.x <= 0 || areaDimensions.y <= 0 || clampedMaximum.x < clampedMinimum.x || clampedMaximum.y < clampedMinimum.y)
+		return;
+
+	std::vector<int> numWideRowsAbove(m_dimensions.x * (m_dimensions.y + 1), 0);
+	for (int yIndex = m_dimensions.y - 1; yIndex >= 0; yIndex--)
+	{
+		int freeRunLength = 0;
+		for (int xIndex = m_dimensions.x - 1; xIndex >= 0; xIndex--)
+		{
+			int tileIndex = (yIndex * m_dimensions.x) + xIndex;
+			freeRunLength = m_isTileOccupied[tileIndex] ? 0 : freeRunLength + 1;
+			if (freeRunLength >= areaDimensions.x)
+				numWideRowsAbove[tileIndex] = numWideRowsAbove[tileIndex + m_dimensions.x] + 1;
+		}
+	}
+
+	for (int yIndex = clampedMinimum.y; yIndex <= clampedMaximum.y; yIndex++)
+	{
+		for (int xIndex = clampedMinimum.x; xIndex <= clampedMaximum.x; xIndex++)
+		{
+			if (numWideRowsAbove[(yIndex * m_dimensions.x) + xIndex] >= areaDimensions.y)
+				out_freeMins.push_back(IntVector2(xIndex, yIndex));
+		}
+	}
+}
+
+int RoomOccupancyGrid::CountOccupiedTilesBefore(int xEnd, int yEnd) const
+{
+	int numOccupied = 0;
+	for (int treeY = yEnd; treeY > 0; treeY -= (treeY & -treeY))
+	{
+		const int* treeRow = &m_occupiedTileTree[treeY * (m_dimensions.x + 1)];
+		for (int treeX = xEnd; treeX > 0; treeX -= (treeX & -treeX))
+		{
+			numOccupied += treeRow[treeX];
+		}
+	}
+
+	return numOccupied;
+}
+
+
+RoomLayout::RoomLayout(const IntVector2& mapDimensions, int possibleOverlaps)
+	: m_occupancy(mapDimensions)
+	, m_mapDimensions(mapDimensions)
+	, m_remainingOverlaps(possibleOverlaps)
+{
+}
+
+void RoomLayout::Clear(int possibleOverlaps)
+{
+	m_roomMins.clear();
+	m_roomMaxs.clear();
+	m_roomCenters.clear();
+	m_occupancy = RoomOccupancyGrid(m_mapDimensions);
+	m_remainingOverlaps = possibleOverlaps;
+}
+
 
 MapGeneratorRoomsAndPaths::MapGeneratorRoomsAndPaths(XMLNode element)
 	: MapGenerator(element)
-	, m_roomMaxs()
-	, m_roomMins()
-	, m_roomCenters()
 {
 	m_numRooms = ParseXMLAttributeInt(element, "numRooms", 0);
 	m_minRoomDimensions = ParseXMLAttributeIntVector2(element, "minRoomDimensions", IntVector2(-1, -1));
@@ -35,61 +155,46 @@ MapGeneratorRoomsAndPaths::MapGeneratorRoomsAndPaths(XMLNode element)
 	m_possibleOverlaps = ParseXMLAttributeInt(element, "possibleOverlaps", 0);
 }
 
-void MapGeneratorRoomsAndPaths::GenerateMap(Map*& outMapToGenerate)
+void MapGeneratorRoomsAndPaths::GenerateMap(Map*& outMapToGenerate, RandomStream& random)
 {
 	//Find room positions
+	RoomLayout layout(outMapToGenerate->m_definition->m_dimensions, m_possibleOverlaps);
 	int maxAttempts = 10;
-	int maxRoomAttempts = 100;
 	for (int attemptIndex = 0; attemptIndex < maxAttempts; attemptIndex++)
 	{
 		for (int roomIndex = 0; roomIndex < m_numRooms; roomIndex++)
 		{
-			for (int roomAttemptIndex = 0; roomAttemptIndex < maxRoomAttempts; roomAttemptIndex++)
-			{
-				IntVector2 newRoomCenter;
-				IntVector2 newRoomMins;
-				IntVector2 newRoomMaxs;
-				bool roomPlacedSuccessfully = AttemptToPlaceRoom(outMapToGenerate, newRoomCenter, newRoomMins, newRoomMaxs);
-				if (roomPlacedSuccessfully)
-				{
-					m_roomCenters.push_back(newRoomCenter);
-					m_roomMins.push_back(newRoomMins);
-					m_roomMaxs.push_back(newRoomMaxs);
-					break;
-				}
-			}
+			AttemptToPlaceRoom(layout, random);
 		}
-		if (m_roomCenters.size() == (size_t)m_numRooms)
+		if (layout.m_roomCenters.size() == (size_t)m_numRooms)
 			break;
 
 		if (attemptIndex == (maxAttempts - 1))
 			break;
 
-		m_roomCenters.clear();
-		m_roomMins.clear();
-		m_roomMaxs.clear();
+		layout.Clear(m_possibleOverlaps);
 	}
 
 	//Place room tiles
-	for (size_t roomIndex = 0; roomIndex < m_roomMins.size(); roomIndex++)
+	for (size_t roomIndex = 0; roomIndex < layout.m_roomMins.size(); roomIndex++)
 	{
-		PlaceRoom(outMapToGenerate, m_roomMins[roomIndex], m_roomMaxs[roomIndex]);
+		PlaceRoom(outMapToGenerate, layout.m_roomMins[roomIndex], layout.m_roomMaxs[roomIndex], random);
 	}
 
 	//Corridors
-	for (size_t roomCenterIndex = 1; roomCenterIndex < m_roomCenters.size(); roomCenterIndex++)
+	for (size_t roomCenterIndex = 1; roomCenterIndex < layout.m_roomCenters.size(); roomCenterIndex++)
 	{
-		PlaceCorridor(outMapToGenerate, m_roomCenters[roomCenterIndex - 1], m_roomCenters[roomCenterIndex]);
+		PlaceCorridor(outMapToGenerate, layout.m_roomCenters[roomCenterIndex - 1], layout.m_roomCenters[roomCenterIndex], random);
 	}
 }
 
 
-void MapGeneratorRoomsAndPaths::PlaceCorridor(Map*& mapToPlaceCorridorIn, const IntVector2& startCoords, const IntVector2& endCoords)
+void MapGeneratorRoomsAndPaths::PlaceCorridor(Map*& mapToPlaceCorridorIn, const IntVector2& startCoords, const IntVector2& endCoords, RandomStream& random)
 {
 	IntVector2 distanceDebts = endCoords - startCoords;
 	IntVector2 currentCoords = startCoords;
 
-	PlaceTileIfPossible(mapToPlaceCorridorIn->GetTileAtTileCoords(currentCoords), m_pathTile, m_pathPermanence);
+	PlaceTileIfPossible(mapToPlaceCorridorIn->GetTileAtTileCoords(currentCoords), m_pathTile, m_pathPermanence, random);
 
 	IntVector2 previousDirection(0, 0);
 	while (distanceDebts.x != 0 || distanceDebts.y != 0)
@@ -100,7 +205,7 @@ void MapGeneratorRoomsAndPaths::PlaceCorridor(Map*& mapToPlaceCorridorIn, const
 		if	((previousDirection != IntVector2(0, 0))
 			&& ((absoluteDistanceDebts - absolutePreviousDirection).x >= 0)
 			&& ((absoluteDistanceDebts - absolutePreviousDirection).y >= 0)
-			&& (GetRandomFloatZeroToOne() <= m_pathStraightness))
+			&& (random.GetRandomFloatZeroToOne() <= m_pathStraightness))
 		{
 			nextDirection = previousDirection;
 		}
@@ -118,18 +223,18 @@ void MapGeneratorRoomsAndPaths::PlaceCorridor(Map*& mapToPlaceCorridorIn, const
 			else if (distanceDebts.y < 0)
 				possibleDirections.push_back(IntVector2(0, -1));
 
-			nextDirection = possibleDirections[GetRandomIntLessThan(possibleDirections.size())];
+			nextDirection = possibleDirections[random.GetRandomIntLessThan(possibleDirections.size())];
 		}
 		
 		distanceDebts = distanceDebts - nextDirection;
 		currentCoords = currentCoords + nextDirection;
 		previousDirection = nextDirection;
 
-		PlaceTileIfPossible(mapToPlaceCorridorIn->GetTileAtTileCoords(currentCoords), m_pathTile, m_pathPermanence);
+		PlaceTileIfPossible(mapToPlaceCorridorIn->GetTileAtTileCoords(currentCoords), m_pathTile, m_pathPermanence, random);
 	}
 }
 
-void MapGeneratorRoomsAndPaths::PlaceRoom(Map*& mapToPlaceRoomIn, const IntVector2& roomMins, const IntVector2& roomMaxs)
+void MapGeneratorRoomsAndPaths::PlaceRoom(Map*& mapToPlaceRoomIn, const IntVector2& roomMins, const IntVector2& roomMaxs, RandomStream& random)
 {
 	IntVector2 startingPoint = roomMins;
 	IntVector2 newRoomDimensions = roomMaxs - roomMins;
@@ -140,7 +245,7 @@ void MapGeneratorRoomsAndPaths::PlaceRoom(Map*& mapToPlaceRoomIn, const IntVecto
 		for (int xIndex = 0; xIndex < newRoomDimensions.x; xIndex++)
 		{
 			IntVector2 currentTileCoords(startingPoint + IntVector2(xIndex, yIndex));
-			PlaceTileIfPossible(mapToPlaceRoomIn->GetTileAtTileCoords(currentTileCoords), m_roomFloorTile, m_roomFloorPermanence);
+			PlaceTileIfPossible(mapToPlaceRoomIn->GetTileAtTileCoords(currentTileCoords), m_roomFloorTile, m_roomFloorPermanence, random);
 		}
 	}
 
@@ -150,8 +255,8 @@ void MapGeneratorRoomsAndPaths::PlaceRoom(Map*& mapToPlaceRoomIn, const IntVecto
 		IntVector2 topTileCoords(startingPoint + IntVector2(xIndex, newRoomDimensions.y));
 		IntVector2 bottomTileCoords(startingPoint + IntVector2(xIndex, -1));
 
-		PlaceTileIfPossible(mapToPlaceRoomIn->GetTileAtTileCoords(topTileCoords), m_roomWallTile, m_roomWallPermanence);
-		PlaceTileIfPossible(mapToPlaceRoomIn->GetTileAtTileCoords(bottomTileCoords), m_roomWallTile, m_roomWallPermanence);
+		PlaceTileIfPossible(mapToPlaceRoomIn->GetTileAtTileCoords(topTileCoords), m_roomWallTile, m_roomWallPermanence, random);
+		PlaceTileIfPossible(mapToPlaceRoomIn->GetTileAtTileCoords(bottomTileCoords), m_roomWallTile, m_roomWallPermanence, random);
 	}
 
 	for (int yIndex = -1; yIndex <= newRoomDimensions.y; yIndex++)
@@ -159,80 +264,77 @@ void MapGeneratorRoomsAndPaths::PlaceRoom(Map*& mapToPlaceRoomIn, const IntVecto
 		IntVector2 leftTileCoords(startingPoint + IntVector2(-1, yIndex));
 		IntVector2 rightTileCoords(startingPoint + IntVector2(newRoomDimensions.x, yIndex));
 
-		PlaceTileIfPossible(mapToPlaceRoomIn->GetTileAtTileCoords(leftTileCoords), m_roomWallTile, m_roomWallPermanence);
-		PlaceTileIfPossible(mapToPlaceRoomIn->GetTileAtTileCoords(rightTileCoords), m_roomWallTile, m_roomWallPermanence);
+		PlaceTileIfPossible(mapToPlaceRoomIn->GetTileAtTileCoords(leftTileCoords), m_roomWallTile, m_roomWallPermanence, random);
+		PlaceTileIfPossible(mapToPlaceRoomIn->GetTileAtTileCoords(rightTileCoords), m_roomWallTile, m_roomWallPermanence, random);
 	}
 }
 
-bool MapGeneratorRoomsAndPaths::DoRoomsOverlap(const IntVector2& roomAMins, const IntVector2& roomAMaxs, const IntVector2& roomBMins, const IntVector2& roomBMaxs)
+bool MapGeneratorRoomsAndPaths::AttemptToPlaceRoom(RoomLayout& layout, RandomStream& random)
 {
-	if (roomAMins.x > roomBMins.x && roomAMins.x < roomBMaxs.x)
-		return true;
-
-	if (roomAMins.y > roomBMins.y && roomAMins.y < roomBMaxs.y)
-		return true;
+	IntVector2 newRoomDimensions(random.GetRandomIntInRange(m_minRoomDimensions.x, m_maxRoomDimensions.x), random.GetRandomIntInRange(m_minRoomDimensions.y, m_maxRoomDimensions.y));
 
-	if (roomAMaxs.x > roomBMins.x && roomAMaxs.x < roomBMaxs.x)
-		return true;
+	IntVector2 startingPoint;
+	if (!PickRoomStartingPoint(layout, newRoomDimensions, startingPoint, random))
+	{
+		//Fall back to the smallest allowed room before giving up on this one
+		newRoomDimensions = m_minRoomDimensions;
+		if (!FindFreeRoomStartingPoint(layout, newRoomDimensions, startingPoint, random))
+			return false;
+	}
 
-	if (roomAMaxs.y > roomBMins.y && roomAMaxs.y < roomBMaxs.y)
-		return true;
+	IntVector2 roomRelativeCenter(newRoomDimensions.x / 2, newRoomDimensions.y / 2);
+	IntVector2 newRoomMins = startingPoint;
+	IntVector2 newRoomMaxs = startingPoint + newRoomDimensions;
 
-	return false;
+	layout.m_roomCenters.push_back(startingPoint + roomRelativeCenter);
+	layout.m_roomMins.push_back(newRoomMins);
+	layout.m_roomMaxs.push_back(newRoomMaxs);
+	layout.m_occupancy.MarkOccupied(newRoomMins - IntVector2(1, 1), newRoomMaxs);
+	return true;
 }
 
-bool MapGeneratorRoomsAndPaths::AttemptToPlaceRoom(Map*& mapToPlaceRoomIn, IntVector2& outRoomCenter, IntVector2& outRoomMins, IntVector2& outRoomMaxs)
+//A room occupies its floor plus the ring of walls around it, so the tested area is [start - 1, start + dimensions]
+bool MapGeneratorRoomsAndPaths::PickRoomStartingPoint(RoomLayout& layout, const IntVector2& roomDimensions, IntVector2& out_startingPoint, RandomStream& random)
 {
-	IntVector2 newRoomDimensions(GetRandomIntInRange(m_minRoomDimensions.x, m_maxRoomDimensions.x), GetRandomIntInRange(m_minRoomDimensions.y, m_maxRoomDimensions.y));
-
 	IntVector2 minimumStartingPoint(2, 2);
-	IntVector2 maximumStartingPoint((mapToPlaceRoomIn->m_definition->m_dimensions - newRoomDimensions) - IntVector2(2, 2));
-
-	IntVector2 startingPoint(GetRandomIntInRange(minimumStartingPoint.x, maximumStartingPoint.x), GetRandomIntInRange(minimumStartingPoint.y, maximumStartingPoint.y));
-
-	IntVector2 roomRelativeCenter = ((startingPoint + newRoomDimensions) - startingPoint);
-	roomRelativeCenter = IntVector2((int)floor(roomRelativeCenter.x / 2), (int)floor(roomRelativeCenter.y / 2));
-	IntVector2 newRoomCenter = startingPoint + roomRelativeCenter;
-	IntVector2 newRoomMins = startingPoint;
-	IntVector2 newRoomMaxs = startingPoint + newRoomDimensions;
+	IntVector2 maximumStartingPoint((layout.m_mapDimensions - roomDimensions) - IntVector2(2, 2));
+	if (maximumStartingPoint.x < minimumStartingPoint.x || maximumStartingPoint.y < minimumStartingPoint.y)
+		return false;
 
-
-	bool hasOverlapped = false;
-
-	for (size_t roomIndex = 0; roomIndex < m_roomMins.size(); roomIndex++)
+	//Sparse layouts almost always succeed within a few random samples
+	int maxSampleAttempts = 8;
+	for (int sampleIndex = 0; sampleIndex < maxSampleAttempts; sampleIndex++)
 	{
-		if (DoRoomsOverlap(newRoomMins, newRoomMaxs, m_roomMins[roomIndex], m_roomMaxs[roomIndex]))
+		IntVector2 startingPoint(random.GetRandomIntInRange(minimumStartingPoint.x, maximumStartingPoint.x), random.GetRandomIntInRange(minimumStartingPoint.y, maximumStartingPoint.y));
+		if (layout.m_occupancy.IsAreaFree(startingPoint - IntVector2(1, 1), startingPoint + roomDimensions))
+		{
+			out_startingPoint = startingPoint;
+			return true;
+		}
+
+		if (layout.m_remainingOverlaps > 0)
 		{
-			if (m_possibleOverlaps > 0)
-				hasOverlapped = true;
-			else
-				return false;
+			layout.m_remainingOverlaps--;
+			out_startingPoint = startingPoint;
+			return true;
 		}
 	}
 
-	//Determine if chosen room is allowed
-// 	for (int yIndex = -1; yIndex <= newRoomDimensions.y; yIndex++)
-// 	{
-// 		for (int xIndex = -1; xIndex <= newRoomDimensions.x; xIndex++)
-// 		{
-// 			IntVector2 currentTileCoords(startingPoint + IntVector2(xIndex, yIndex));
-// 			if (mapToPlaceRoomIn->GetTileAtTileCoords(currentTileCoords)->m_tileDefinition->m_name == m_roomFloorTile || mapToPlaceRoomIn->GetTileAtTileCoords(currentTileCoords)->m_tileDefinition->m_name == m_roomWallTile)
-// 			{
-// 				if (m_possibleOverlaps > 0)
-// 					hasOverlapped = true;
-// 				else
-// 					return false;
-// 			}
-// 		}
-// 	}
-
-
-	if (hasOverlapped)
-		m_possibleOverlaps--;
-
-	outRoomCenter = newRoomCenter;
-	outRoomMaxs = newRoomMaxs;
-	outRoomMins = newRoomMins;
+	return FindFreeRoomStartingPoint(layout, roomDimensions, out_startingPoint, random);
+}
+
+//Picks uniformly among every free starting point, so crowded layouts cost one pass instead of endless rejected samples
+bool MapGeneratorRoomsAndPaths::FindFreeRoomStartingPoint(const RoomLayout& layout, const IntVector2& roomDimensions, IntVector2& out_startingPoint, RandomStream& random)
+{
+	IntVector2 minimumStartingPoint(2, 2);
+	IntVector2 maximumStartingPoint((layout.m_mapDimensions - roomDimensions) - IntVector2(2, 2));
+
+	//Searched as footprints, which include the ring of walls
+	std::vector<IntVector2> freeFootprintMins;
+	layout.m_occupancy.FindFreeAreas(roomDimensions + IntVector2(2, 2), minimumStartingPoint - IntVector2(1, 1), maximumStartingPoint - IntVector2(1, 1), freeFootprintMins);
+	if (freeFootprintMins.empty())
+		return false;
 
+	out_startingPoint = freeFootprintMins[random.GetRandomIntLessThan((int)freeFootprintMins.size())] + IntVector2(1, 1);
 	return true;
 }
@@ -1,16 +1,49 @@
 #pragma once
-#include "ThirdParty\XMLParser\XMLParser.hpp"
+#include "ThirdParty/XMLParser/XMLParser.hpp"
 #include <string>
 #include "Game/MapGenerator.hpp"
 #include <vector>
 
 
+//Marks which tiles some room footprint covers. Each tile is marked once, so placing a room costs its own area, and a 2D Fenwick
+//tree over the marks counts the occupied tiles in any rectangle in O(log W * log H).
+class RoomOccupancyGrid
+{
+public:
+	RoomOccupancyGrid(const IntVector2& dimensions);
+
+	void MarkOccupied(const IntVector2& mins, const IntVector2& maxsInclusive);
+	bool IsAreaFree(const IntVector2& mins, const IntVector2& maxsInclusive) const;
+	void FindFreeAreas(const IntVector2& areaDimensions, const IntVector2& minimumMins, const IntVector2& maximumMins, std::vector<IntVector2>& out_freeMins) const;
+
+private:
+	int CountOccupiedTilesBefore(int xEnd, int yEnd) const;
+
+	IntVector2 m_dimensions;
+	std::vector<bool> m_isTileOccupied;
+	std::vector<int> m_occupiedTileTree;
+};
+
+//Everything one GenerateMap call accumulates, kept off the generator so it can run on several maps at once
+struct RoomLayout
+{
+	RoomLayout(const IntVector2& mapDimensions, int possibleOverlaps);
+	void Clear(int possibleOverlaps);
+
+	std::vector<IntVector2> m_roomMins;
+	std::vector<IntVector2> m_roomMaxs;
+	std::vector<IntVector2> m_roomCenters;
+	RoomOccupancyGrid m_occupancy;
+	IntVector2 m_mapDimensions;
+	int m_remainingOverlaps;
+};
+
 class MapGeneratorRoomsAndPaths : public MapGenerator
 {
 public:
 	MapGeneratorRoomsAndPaths(XMLNode element);
 
-	virtual void GenerateMap(Map*& outMapToGenerate) override;
+	virtual void GenerateMap(Map*& outMapToGenerate, RandomStream& random) override;
 
 	int m_numRooms;
 	IntVector2 m_minRoomDimensions;
@@ -27,13 +60,10 @@ public:
 	float m_roomWallPermanence;
 	float m_pathPermanence;
 
-	std::vector<IntVector2> m_roomMins;
-	std::vector<IntVector2> m_roomMaxs;
-	std::vector<IntVector2> m_roomCenters;
-
 private:
-	bool AttemptToPlaceRoom(Map*& mapToPlaceRoomIn, IntVector2& outRoomCenter, IntVector2& outRoomMins, IntVector2& outRoomMaxs);
-	void PlaceCorridor(Map*& mapToPlaceCorridorIn, const IntVector2& startCoords, const IntVector2& endCoords);
-	void PlaceRoom(Map*& mapToPlaceRoomIn, const IntVector2& roomMins, const IntVector2& roomMaxs);
-	bool DoRoomsOverlap(const IntVector2& roomAMins, const IntVector2& roomAMaxs, const IntVector2& roomBMins, const IntVector2& roomBMaxs);
+	bool AttemptToPlaceRoom(RoomLayout& layout, RandomStream& random);
+	bool PickRoomStartingPoint(RoomLayout& layout, const IntVector2& roomDimensions, IntVector2& out_startingPoint, RandomStream& random);
+	bool FindFreeRoomStartingPoint(const RoomLayout& layout, const IntVector2& roomDimensions, IntVector2& out_startingPoint, RandomStream& random);
+	void PlaceCorridor(Map*& mapToPlaceCorridorIn, const IntVector2& startCoords, const IntVector2& endCoords, RandomStream& random);
+	void PlaceRoom(Map*& mapToPlaceRoomIn, const IntVector2& roomMins, const IntVector2& roomMaxs, RandomStream& random);
 };
\ No newline at end of file
@@ -0,0 +1,474 @@
+#include "Game/MapGeneratorWaveFunctionCollapse.hpp"
+#include "Game/Prefab.hpp"
+#include "Game/MapDefinition.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/XMLUtils.hpp"
+#include <algorithm>
+#include <math.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+static const IntVector2 WAVE_DIRECTION_OFFSETS[NUM_WAVE_DIRECTIONS] = { IntVector2(0, 1), IntVector2(0, -1), IntVector2(1, 0), IntVector2(-1, 0) };
+static const float ENTROPY_NOISE_SCALE = 0.0001f;
+
+//Word must not be zero
+static int CountTrailingZeros(unsigned long long word)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+	unsigned long bitIndex;
+	_BitScanForward64(&bitIndex, word);
+	return (int)bitIndex;
+#elif defined(_MSC_VER)
+	//Win32 has no 64-bit scan, so scan the low half and fall back to the high half
+	unsigned long bitIndex;
+	if (_BitScanForward(&bitIndex, (unsigned long)word))
+		return (int)bitIndex;
+	_BitScanForward(&bitIndex, (unsigned long)(word >> 32));
+	return (int)bitIndex + 32;
+#else
+	return __builtin_ctzll(word);
+#endif
+}
+
+
+void EntropyHeap::Reset(int numCells)
+{
+	m_heap.clear();
+	m_heap.reserve(numCells);
+	m_heapIndexByCell.assign(numCells, -1);
+	m_entropyByCell.assign(numCells, 0.f);
+}
+
+void EntropyHeap::Push(int cellIndex, float entropy)
+{
+	m_entropyByCell[cellIndex] = entropy;
+	m_heapIndexByCell[cellIndex] = (int)m_heap.size();
+	m_heap.push_back(cellIndex);
+	SiftUp((int)m_heap.size() - 1);
+}
+
+void EntropyHeap::Update(int cellIndex, float entropy)
+{
+	int heapIndex = m_heapIndexByCell[cellIndex];
+	if (heapIndex == -1)
+		return;
+
+	float oldEntropy = m_entropyByCell[cellIndex];
+	m_entropyByCell[cellIndex] = entropy;
+	if (entropy < oldEntropy)
+		SiftUp(heapIndex);
+	else
+		SiftDown(heapIndex);
+}
+
+void EntropyHeap::Remove(int cellIndex)
+{
+	int heapIndex = m_heapIndexByCell[cellIndex];
+	if (heapIndex == -1)
+		return;
+
+	int lastHeapIndex = (int)m_heap.size() - 1;
+	SwapEntries(heapIndex, lastHeapIndex);
+	m_heap.pop_back();
+	m_heapIndexByCell[cellIndex] = -1;
+	if (heapIndex < lastHeapIndex)
+	{
+		SiftUp(heapIndex);
+		SiftDown(heapIndex);
+	}
+}
+
+int EntropyHeap::PopMin()
+{
+	int cellIndex = m_heap[0];
+	Remove(cellIndex);
+	return cellIndex;
+}
+
+void EntropyHeap::SiftUp(int heapIndex)
+{
+	while (heapIndex > 0)
+	{
+		int parentIndex = (heapIndex - 1) / 2;
+		if (m_entropyByCell[m_heap[parentIndex]] <= m_entropyByCell[m_heap[heapIndex]])
+			return;
+
+		SwapEntries(heapIndex, parentIndex);
+		heapIndex = parentIndex;
+	}
+}
+
+void EntropyHeap::SiftDown(int heapIndex)
+{
+	int heapSize = (int)m_heap.size();
+	while (true)
+	{
+		int smallestIndex = heapIndex;
+		int leftIndex = (2 * heapIndex) + 1;
+		int rightIndex = leftIndex + 1;
+		if (leftIndex < heapSize && m_entropyByCell[m_heap[leftIndex]] < m_entropyByCell[m_heap[smallestIndex]])
+			smallestIndex = leftIndex;
+		if (rightIndex < heapSize && m_entropyByCell[m_heap[rightIndex]] < m_entropyByCell[m_heap[smallestIndex]])
+			smallestIndex = rightIndex;
+		if (smallestIndex == heapIndex)
+			return;
+
+		SwapEntries(heapIndex, smallestIndex);
+		heapIndex = smallestIndex;
+	}
+}
+
+void EntropyHeap::SwapEntries(int heapIndexA, int heapIndexB)
+{
+	std::swap(m_heap[heapIndexA], m_heap[heapIndexB]);
+	m_heapIndexByCell[m_heap[heapIndexA]] = heapIndexA;
+	m_heapIndexByCell[m_heap[heapIndexB]] = heapIndexB;
+}
+
+
+MapGeneratorWaveFunctionCollapse::MapGeneratorWaveFunctionCollapse(XMLNode element)
+	: MapGenerator(element)
+{
+	m_includeRotations = ParseXMLAttributeBool(element, "includeRotations", m_includeRotations);
+	m_includeMirrors = ParseXMLAttributeBool(element, "includeMirrors", m_includeMirrors);
+	m_maxRestarts = ParseXMLAttributeInt(element, "maxRestarts", m_maxRestarts);
+	//Without a fixed seed, the solve seed comes from the map's generator stream
+	m_hasFixedSeed = !ParseXMLAttributeString(element, "seed", "").empty();
+	m_seed = ParseXMLAttributeInt(element, "seed", m_seed);
+	m_permanence = ParseXMLAttributeFloat(element, "permanence", m_permanence);
+
+	ASSERT_OR_DIE(element.nChildNode("Sample") > 0, "No samples for WaveFunctionCollapse.");
+	for (int sampleIndex = 0; sampleIndex < element.nChildNode("Sample"); sampleIndex++)
+	{
+		std::string filename = ParseXMLAttributeString(element.getChildNode("Sample", sampleIndex), "filename", "INVALID_FILENAME");
+		ASSERT_OR_DIE(filename != "INVALID_FILENAME", "No filename found for WaveFunctionCollapse sample.");
+		m_sampleFilenames.push_back(filename);
+
+		//Only the learned rules are kept, so the sample is dropped once it has been read
+		Prefab* sample = Prefab::LoadFromFile(filename);
+		LearnFromSample(*sample);
+		m_cacheKeyData += sample->GetSourceData();
+		delete sample;
+	}
+
+	ASSERT_OR_DIE(m_numTypes > 0, "WaveFunctionCollapse samples contain no tiles.");
+	m_numWordsPerCell = (m_numTypes + 63) / 64;
+	for (std::vector<unsigned long long>& compatibleTypes : m_compatibleTypes)
+	{
+		compatibleTypes.resize(m_numWordsPerCell, 0);
+	}
+}
+
+void MapGeneratorWaveFunctionCollapse::GenerateMap(Map*& outMapToGenerate, RandomStream& random)
+{
+	unsigned int solveSeed = random.GetRandomUnsignedInt();
+	if (m_hasFixedSeed)
+		solveSeed = m_seed;
+
+	//Restarts continue the same stream, so a given seed always lands on the same attempt and layout
+	RandomStream solveRandom(solveSeed);
+	WaveFunctionCollapseState state;
+	state.m_dimensions = outMapToGenerate->m_definition->m_dimensions;
+
+	bool wasSolved = false;
+	for (int attemptIndex = 0; attemptIndex <= m_maxRestarts && !wasSolved; attemptIndex++)
+	{
+		wasSolved = RunAttempt(state, solveRandom);
+	}
+
+	//A contradiction on every attempt leaves the map unchanged and shows up as a failed step in the generation timeline
+	if (!wasSolved)
+	{
+		outMapToGenerate->m_hasGenerationStepFailed = true;
+		return;
+	}
+
+	for (int yIndex = 0; yIndex < state.m_dimensions.y; yIndex++)
+	{
+		for (int xIndex = 0; xIndex < state.m_dimensions.x; xIndex++)
+		{
+			int localType = GetCollapsedType(state, (yIndex * state.m_dimensions.x) + xIndex);
+			Tile* tileToChange = outMapToGenerate->GetTileAtTileCoords(IntVector2(xIndex, yIndex));
+			PlaceTileIfPossible(tileToChange, TileDefinition::GetTileDefinition(m_tileTypes[localType]), m_permanence, random);
+		}
+	}
+}
+
+std::string MapGeneratorWaveFunctionCollapse::GetCacheKeyData() const
+{
+	return m_cacheKeyData;
+}
+
+void MapGeneratorWaveFunctionCollapse::LearnFromSample(const Prefab& sample)
+{
+	int numRotations = m_includeRotations ? 4 : 1;
+	for (int rotation = 0; rotation < numRotations; rotation++)
+	{
+		LearnFromTransformedSample(sample, rotation, false);
+		if (m_includeMirrors)
+			LearnFromTransformedSample(sample, rotation, true);
+	}
+}
+
+//Adjacencies are read off the sample as it would be stamped, so rotated and mirrored copies teach their own rules
+void MapGeneratorWaveFunctionCollapse::LearnFromTransformedSample(const Prefab& sample, int rotation, bool isMirrored)
+{
+	IntVector2 dimensions = sample.m_dimensions;
+	if (rotation % 2 == 1)
+		dimensions = IntVector2(sample.m_dimensions.y, sample.m_dimensions.x);
+
+	std::vector<int> localTypes(dimensions.x * dimensions.y, -1);
+	IntVector2 sampleCoords;
+	for (sampleCoords.y = 0; sampleCoords.y < sample.m_dimensions.y; sampleCoords.y++)
+	{
+		for (sampleCoords.x = 0; sampleCoords.x < sample.m_dimensions.x; sampleCoords.x++)
+		{
+			TileTypeID tileType = sample.GetTileTypeAtIndex((sampleCoords.y * sample.m_dimensions.x) + sampleCoords.x);
+			if (tileType == Prefab::EMPTY_TILE_TYPE)
+				continue;
+
+			IntVector2 transformedCoords = sample.TransformCoords(sampleCoords, rotation, isMirrored);
+			int localType = GetOrAddLocalType(tileType);
+			localTypes[(transformedCoords.y * dimensions.x) + transformedCoords.x] = localType;
+			m_weights[localType] += 1.0;
+		}
+	}
+
+	for (int yIndex = 0; yIndex < dimensions.y; yIndex++)
+	{
+		for (int xIndex = 0; xIndex < dimensions.x; xIndex++)
+		{
+			int localType = localTypes[(yIndex * dimensions.x) + xIndex];
+			if (localType == -1)
+				continue;
+
+			int eastLocalType = (xIndex + 1 < dimensions.x) ? localTypes[(yIndex * dimensions.x) + xIndex + 1] : -1;
+			if (eastLocalType != -1)
+			{
+				AddCompatibility(WAVE_EAST, localType, eastLocalType);
+				AddCompatibility(WAVE_WEST, eastLocalType, localType);
+			}
+
+			int northLocalType = (yIndex + 1 < dimensions.y) ? localTypes[((yIndex + 1) * dimensions.x) + xIndex] : -1;
+			if (northLocalType != -1)
+			{
+				AddCompatibility(WAVE_NORTH, localType, northLocalType);
+				AddCompatibility(WAVE_SOUTH, northLocalType, localType);
+			}
+		}
+	}
+}
+
+int MapGeneratorWaveFunctionCollapse::GetOrAddLocalType(TileTypeID tileType)
+{
+	for (int localType = 0; localType < m_numTypes; localType++)
+	{
+		if (m_tileTypes[localType] == tileType)
+			return localType;
+	}
+
+	m_tileTypes.push_back(tileType);
+	m_weights.push_back(0.0);
+	m_compatibleTypes.resize(m_compatibleTypes.size() + NUM_WAVE_DIRECTIONS);
+	return m_numTypes++;
+}
+
+void MapGeneratorWaveFunctionCollapse::AddCompatibility(WaveDirection direction, int localType, int neighborLocalType)
+{
+	std::vector<unsigned long long>& compatibleTypes = m_compatibleTypes[(localType * NUM_WAVE_DIRECTIONS) + direction];
+	size_t wordIndex = neighborLocalType / 64;
+	if (compatibleTypes.size() <= wordIndex)
+		compatibleTypes.resize(wordIndex + 1, 0);
+	compatibleTypes[wordIndex] |= 1ULL << (neighborLocalType % 64);
+}
+
+bool MapGeneratorWaveFunctionCollapse::RunAttempt(WaveFunctionCollapseState& state, RandomStream& random) const
+{
+	ResetState(state, random);
+	if (!Propagate(state))
+		return false;
+
+	while (!state.m_entropyHeap.IsEmpty())
+	{
+		CollapseCell(state, state.m_entropyHeap.PopMin(), random);
+		if (!Propagate(state))
+			return false;
+	}
+
+	return true;
+}
+
+//Every cell starts able to be anything, and every cell is queued once so types that can never border the map's interior are pruned up front
+void MapGeneratorWaveFunctionCollapse::ResetState(WaveFunctionCollapseState& state, RandomStream& random) const
+{
+	int numCells = state.m_dimensions.x * state.m_dimensions.y;
+
+	std::vector<unsigned long long> allTypes(m_numWordsPerCell, ~0ULL);
+	if (m_numTypes % 64 != 0)
+		allTypes.back() = (1ULL << (m_numTypes % 64)) - 1;
+
+	double sumOfWeights = 0.0;
+	double sumOfWeightLogWeights = 0.0;
+	for (double weight : m_weights)
+	{
+		sumOfWeights += weight;
+		sumOfWeightLogWeights += weight * log(weight);
+	}
+
+	state.m_domains.resize(numCells * m_numWordsPerCell);
+	for (int cellIndex = 0; cellIndex < numCells; cellIndex++)
+	{
+		std::copy(allTypes.begin(), allTypes.end(), state.m_domains.begin() + (cellIndex * m_numWordsPerCell));
+	}
+	state.m_numPossibleTypes.assign(numCells, m_numTypes);
+	state.m_sumOfWeights.assign(numCells, sumOfWeights);
+	state.m_sumOfWeightLogWeights.assign(numCells, sumOfWeightLogWeights);
+	state.m_isInWorklist.assign(numCells, true);
+
+	state.m_worklist.resize(numCells);
+	state.m_entropyNoise.resize(numCells);
+	state.m_entropyHeap.Reset(numCells);
+	for (int cellIndex = 0; cellIndex < numCells; cellIndex++)
+	{
+		state.m_worklist[cellIndex] = cellIndex;
+		state.m_entropyNoise[cellIndex] = random.GetRandomFloatZeroToOne() * ENTROPY_NOISE_SCALE;
+		if (m_numTypes > 1)
+			state.m_entropyHeap.Push(cellIndex, CalculateEntropy(state, cellIndex));
+	}
+}
+
+void MapGeneratorWaveFunctionCollapse::CollapseCell(WaveFunctionCollapseState& state, int cellIndex, RandomStream& random) const
+{
+	const unsigned long long* domain = &state.m_domains[cellIndex * m_numWordsPerCell];
+	double weightToSkip = random.GetRandomFloatZeroToOne() * state.m_sumOfWeights[cellIndex];
+	int chosenType = -1;
+	for (int wordIndex = 0; wordIndex < m_numWordsPerCell && weightToSkip >= 0.0; wordIndex++)
+	{
+		unsigned long long remainingTypes = domain[wordIndex];
+		while (remainingTypes != 0)
+		{
+			chosenType = (wordIndex * 64) + CountTrailingZeros(remainingTypes);
+			remainingTypes &= remainingTypes - 1;
+			weightToSkip -= m_weights[chosenType];
+			if (weightToSkip < 0.0)
+				break;
+		}
+	}
+
+	std::vector<unsigned long long> chosenTypeOnly(m_numWordsPerCell, 0);
+	chosenTypeOnly[chosenType / 64] = 1ULL << (chosenType % 64);
+	ConstrainCell(state, cellIndex, chosenTypeOnly);
+}
+
+//Drains the worklist, narrowing each neighbor of a changed cell to the types some remaining type in that cell allows
+bool MapGeneratorWaveFunctionCollapse::Propagate(WaveFunctionCollapseState& state) const
+{
+	std::vector<unsigned long long> allowedTypes(m_numWordsPerCell);
+	while (!state.m_worklist.empty())
+	{
+		int cellIndex = state.m_worklist.back();
+		state.m_worklist.pop_back();
+		state.m_isInWorklist[cellIndex] = false;
+
+		IntVector2 cellCoords(cellIndex % state.m_dimensions.x, cellIndex / state.m_dimensions.x);
+		const unsigned long long* domain = &state.m_domains[cellIndex * m_numWordsPerCell];
+		for (int direction = 0; direction < NUM_WAVE_DIRECTIONS; direction++)
+		{
+			IntVector2 neighborCoords = cellCoords + WAVE_DIRECTION_OFFSETS[direction];
+			if (neighborCoords.x < 0 || neighborCoords.y < 0 || neighborCoords.x >= state.m_dimensions.x || neighborCoords.y >= state.m_dimensions.y)
+				continue;
+
+			std::fill(allowedTypes.begin(), allowedTypes.end(), 0);
+			for (int wordIndex = 0; wordIndex < m_numWordsPerCell; wordIndex++)
+			{
+				unsigned long long remainingTypes = domain[wordIndex];
+				while (remainingTypes != 0)
+				{
+					int localType = (wordIndex * 64) + CountTrailingZeros(remainingTypes);
+					remainingTypes &= remainingTypes - 1;
+
+					const std::vector<unsigned long long>& compatibleTypes = m_compatibleTypes[(localType * NUM_WAVE_DIRECTIONS) + direction];
+					for (int allowedWordIndex = 0; allowedWordIndex < m_numWordsPerCell; allowedWordIndex++)
+					{
+						allowedTypes[allowedWordIndex] |= compatibleTypes[allowedWordIndex];
+					}
+				}
+			}
+
+			if (!ConstrainCell(state, (neighborCoords.y * state.m_dimensions.x) + neighborCoords.x, allowedTypes))
+			{
+				state.m_worklist.clear();
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+//Returns false on a contradiction, when no type is left for the cell
+bool MapGeneratorWaveFunctionCollapse::ConstrainCell(WaveFunctionCollapseState& state, int cellIndex, const std::vector<unsigned long long>& allowedTypes) const
+{
+	unsigned long long* domain = &state.m_domains[cellIndex * m_numWordsPerCell];
+	bool wasChanged = false;
+	for (int wordIndex = 0; wordIndex < m_numWordsPerCell; wordIndex++)
+	{
+		unsigned long long removedTypes = domain[wordIndex] & ~allowedTypes[wordIndex];
+		if (removedTypes == 0)
+			continue;
+
+		wasChanged = true;
+		domain[wordIndex] &= allowedTypes[wordIndex];
+		while (removedTypes != 0)
+		{
+			int localType = (wordIndex * 64) + CountTrailingZeros(removedTypes);
+			removedTypes &= removedTypes - 1;
+
+			double weight = m_weights[localType];
+			state.m_numPossibleTypes[cellIndex]--;
+			state.m_sumOfWeights[cellIndex] -= weight;
+			state.m_sumOfWeightLogWeights[cellIndex] -= weight * log(weight);
+		}
+	}
+
+	if (!wasChanged)
+		return true;
+
+	if (state.m_numPossibleTypes[cellIndex] == 0)
+		return false;
+
+	if (state.m_numPossibleTypes[cellIndex] == 1)
+		state.m_entropyHeap.Remove(cellIndex);
+	else
+		state.m_entropyHeap.Update(cellIndex, CalculateEntropy(state, cellIndex));
+
+	if (!state.m_isInWorklist[cellIndex])
+	{
+		state.m_isInWorklist[cellIndex] = true;
+		state.m_worklist.push_back(cellIndex);
+	}
+
+	return true;
+}
+
+//Shannon entropy of the cell's weighted types, plus a little per-cell noise so ties break randomly rather than by scan order
+float MapGeneratorWaveFunctionCollapse::CalculateEntropy(const WaveFunctionCollapseState& state, int cellIndex) const
+{
+	double sumOfWeights = state.m_sumOfWeights[cellIndex];
+	double entropy = log(sumOfWeights) - (state.m_sumOfWeightLogWeights[cellIndex] / sumOfWeights);
+	return (float)entropy + state.m_entropyNoise[cellIndex];
+}
+
+int MapGeneratorWaveFunctionCollapse::GetCollapsedType(const WaveFunctionCollapseState& state, int cellIndex) const
+{
+	const unsigned long long* domain = &state.m_domains[cellIndex * m_numWordsPerCell];
+	for (int wordIndex = 0; wordIndex < m_numWordsPerCell; wordIndex++)
+	{
+		if (domain[wordIndex] != 0)
+			return (wordIndex * 64) + CountTrailingZeros(domain[wordIndex]);
+	}
+
+	return 0;
+}
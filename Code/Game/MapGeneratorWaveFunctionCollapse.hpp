@@ -0,0 +1,96 @@
+#pragma once
+#include "ThirdParty/XMLParser/XMLParser.hpp"
+#include <string>
+#include <vector>
+#include "Game/MapGenerator.hpp"
+
+
+class Prefab;
+
+enum WaveDirection
+{
+	WAVE_NORTH,
+	WAVE_SOUTH,
+	WAVE_EAST,
+	WAVE_WEST,
+	NUM_WAVE_DIRECTIONS
+};
+
+//Min-heap of cells keyed by entropy, with each cell's heap position tracked so its key can be changed or removed in place
+class EntropyHeap
+{
+public:
+	void Reset(int numCells);
+	void Push(int cellIndex, float entropy);
+	void Update(int cellIndex, float entropy);
+	void Remove(int cellIndex);
+	int PopMin();
+	bool IsEmpty() const { return m_heap.empty(); }
+
+private:
+	void SiftUp(int heapIndex);
+	void SiftDown(int heapIndex);
+	void SwapEntries(int heapIndexA, int heapIndexB);
+
+	std::vector<int> m_heap;
+	std::vector<int> m_heapIndexByCell;
+	std::vector<float> m_entropyByCell;
+};
+
+//Everything one solve attempt owns, kept off the generator so it can run on several maps at once.
+//Each cell's domain is a bitset over the learned tile types, m_numWordsPerCell words wide.
+struct WaveFunctionCollapseState
+{
+	IntVector2 m_dimensions;
+	std::vector<unsigned long long> m_domains;
+	std::vector<int> m_numPossibleTypes;
+	std::vector<double> m_sumOfWeights;
+	std::vector<double> m_sumOfWeightLogWeights;
+	std::vector<float> m_entropyNoise;
+	std::vector<int> m_worklist;
+	std::vector<bool> m_isInWorklist;
+	EntropyHeap m_entropyHeap;
+};
+
+//Learns which tile types may sit next to each other from FromFile style prefabs, then fills the map with a layout that
+//obeys those adjacencies everywhere. Solving restarts from scratch on a contradiction, up to maxRestarts times.
+class MapGeneratorWaveFunctionCollapse : public MapGenerator
+{
+public:
+	MapGeneratorWaveFunctionCollapse(XMLNode element);
+
+	virtual void GenerateMap(Map*& outMapToGenerate, RandomStream& random) override;
+	virtual std::string GetCacheKeyData() const override;
+
+	std::vector<std::string> m_sampleFilenames;
+	bool m_includeRotations = true;
+	bool m_includeMirrors = true;
+	int m_maxRestarts = 10;
+	unsigned int m_seed = 0;
+	bool m_hasFixedSeed = false;
+	float m_permanence = 0.5f;
+
+	//Learned rules. Types are indexed locally in the order they were first seen; m_compatibleTypes holds, per type and
+	//direction, the bitset of types allowed in the neighboring cell that way, at (type * NUM_WAVE_DIRECTIONS) + direction.
+	std::vector<TileTypeID> m_tileTypes;
+	std::vector<double> m_weights;
+	int m_numTypes = 0;
+	int m_numWordsPerCell = 0;
+	std::vector<std::vector<unsigned long long>> m_compatibleTypes;
+
+private:
+	void LearnFromSample(const Prefab& sample);
+	void LearnFromTransformedSample(const Prefab& sample, int rotation, bool isMirrored);
+	int GetOrAddLocalType(TileTypeID tileType);
+	void AddCompatibility(WaveDirection direction, int localType, int neighborLocalType);
+
+	bool RunAttempt(WaveFunctionCollapseState& state, RandomStream& random) const;
+	void ResetState(WaveFunctionCollapseState& state, RandomStream& random) const;
+	void CollapseCell(WaveFunctionCollapseState& state, int cellIndex, RandomStream& random) const;
+	bool Propagate(WaveFunctionCollapseState& state) const;
+	bool ConstrainCell(WaveFunctionCollapseState& state, int cellIndex, const std::vector<unsigned long long>& allowedTypes) const;
+	float CalculateEntropy(const WaveFunctionCollapseState& state, int cellIndex) const;
+	int GetCollapsedType(const WaveFunctionCollapseState& state, int cellIndex) const;
+
+	std::string m_cacheKeyData;
+};
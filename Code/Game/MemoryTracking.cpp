@@ -0,0 +1,125 @@
+#include "Game/MemoryTracking.hpp"
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+
+#if defined(ROGUELIKE_PROFILING)
+//Each block carries its size in a header so delete can update the live byte count. The header stays 16 bytes
+//to keep the returned pointer aligned for any fundamental type.
+static const size_t ALLOCATION_HEADER_SIZE = 16;
+
+static std::atomic<unsigned long long> s_numAllocations(0);
+static std::atomic<unsigned long long> s_numFrees(0);
+static std::atomic<unsigned long long> s_totalBytesAllocated(0);
+static std::atomic<unsigned long long> s_liveBytes(0);
+static std::atomic<unsigned long long> s_peakLiveBytes(0);
+static thread_local unsigned long long s_threadNumAllocations = 0;
+static thread_local unsigned long long s_threadBytesAllocated = 0;
+
+
+static void* TrackedAllocate(size_t numBytes)
+{
+	unsigned char* block = (unsigned char*)malloc(numBytes + ALLOCATION_HEADER_SIZE);
+	if (!block)
+		return nullptr;
+
+	*(size_t*)block = numBytes;
+	s_numAllocations++;
+	s_totalBytesAllocated += numBytes;
+	s_threadNumAllocations++;
+	s_threadBytesAllocated += numBytes;
+	unsigned long long liveBytes = (s_liveBytes += numBytes);
+	unsigned long long peakLiveBytes = s_peakLiveBytes.load();
+	while (liveBytes > peakLiveBytes && !s_peakLiveBytes.compare_exchange_weak(peakLiveBytes, liveBytes))
+	{
+	}
+
+	return block + ALLOCATION_HEADER_SIZE;
+}
+
+static void TrackedFree(void* pointer)
+{
+	if (!pointer)
+		return;
+
+	unsigned char* block = (unsigned char*)pointer - ALLOCATION_HEADER_SIZE;
+	s_numFrees++;
+	s_liveBytes -= *(size_t*)block;
+	free(block);
+}
+
+static void* TrackedAllocateOrThrow(size_t numBytes)
+{
+	void* pointer = TrackedAllocate(numBytes == 0 ? 1 : numBytes);
+	if (!pointer)
+		throw std::bad_alloc();
+	return pointer;
+}
+
+
+void* operator new(size_t numBytes) { return TrackedAllocateOrThrow(numBytes); }
+void* operator new[](size_t numBytes) { return TrackedAllocateOrThrow(numBytes); }
+void* operator new(size_t numBytes, const std::nothrow_t&) throw() { return TrackedAllocate(numBytes == 0 ? 1 : numBytes); }
+void* operator new[](size_t numBytes, const std::nothrow_t&) throw() { return TrackedAllocate(numBytes == 0 ? 1 : numBytes); }
+void operator delete(void* pointer) throw() { TrackedFree(pointer); }
+void operator delete[](void* pointer) throw() { TrackedFree(pointer); }
+void operator delete(void* pointer, size_t) throw() { TrackedFree(pointer); }
+void operator delete[](void* pointer, size_t) throw() { TrackedFree(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) throw() { TrackedFree(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) throw() { TrackedFree(pointer); }
+#endif
+
+
+MemorySnapshot GetMemorySnapshot()
+{
+	MemorySnapshot snapshot = {};
+#if defined(ROGUELIKE_PROFILING)
+	snapshot.m_numAllocations = s_numAllocations.load();
+	snapshot.m_numFrees = s_numFrees.load();
+	snapshot.m_totalBytesAllocated = s_totalBytesAllocated.load();
+	snapshot.m_liveBytes = s_liveBytes.load();
+	snapshot.m_peakLiveBytes = s_peakLiveBytes.load();
+#endif
+	return snapshot;
+}
+
+ThreadAllocationCounts GetThreadAllocationCounts()
+{
+	ThreadAllocationCounts counts = {};
+#if defined(ROGUELIKE_PROFILING)
+	counts.m_numAllocations = s_threadNumAllocations;
+	counts.m_totalBytesAllocated = s_threadBytesAllocated;
+#endif
+	return counts;
+}
+
+void ResetPeakLiveBytes()
+{
+#if defined(ROGUELIKE_PROFILING)
+	s_peakLiveBytes = s_liveBytes.load();
+#endif
+}
+
+unsigned long long GetProcessPeakResidentBytes()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS memoryCounters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &memoryCounters, sizeof(memoryCounters)))
+		return 0;
+	return memoryCounters.PeakWorkingSetSize;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+	return (unsigned long long)usage.ru_maxrss * 1024;
+#endif
+}
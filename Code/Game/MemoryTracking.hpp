@@ -0,0 +1,33 @@
+#pragma once
+#include <stddef.h>
+
+
+//Counters fed by the global operator new/delete replacements in MemoryTracking.cpp. They cover every heap allocation
+//in the process, so measurements should be taken around single-threaded work or use the per-thread counts below.
+//The replacements are only built with ROGUELIKE_PROFILING, so allocations in other builds cost nothing extra and
+//every counter reads zero.
+struct MemorySnapshot
+{
+	unsigned long long m_numAllocations;
+	unsigned long long m_numFrees;
+	unsigned long long m_totalBytesAllocated;
+	unsigned long long m_liveBytes;
+	unsigned long long m_peakLiveBytes;
+};
+
+struct ThreadAllocationCounts
+{
+	unsigned long long m_numAllocations;
+	unsigned long long m_totalBytesAllocated;
+};
+
+MemorySnapshot GetMemorySnapshot();
+
+//Allocations made by the calling thread only, so work running alongside other threads can still be measured
+ThreadAllocationCounts GetThreadAllocationCounts();
+
+//Restarts peak tracking from the current live byte count
+void ResetPeakLiveBytes();
+
+//Peak resident memory of the whole process as reported by the OS, or 0 if unavailable
+unsigned long long GetProcessPeakResidentBytes();
@@ -1,6 +1,6 @@
 #pragma once
 #include <string>
-#include "Engine\Core\Rgba.hpp"
+#include "Engine/Core/Rgba.hpp"
 
 
 struct Message
@@ -0,0 +1,379 @@
+#include "Game/OverworldStreamer.hpp"
+#include "Game/MapGeneratorOverworld.hpp"
+#include "Game/BinaryBuffer.hpp"
+#include "Game/Character.hpp"
+#include "Game/Feature.hpp"
+#include "Game/Item.hpp"
+#include <algorithm>
+#include <stdlib.h>
+
+
+static int FloorDivide(int numerator, int denominator)
+{
+	int quotient = numerator / denominator;
+	if ((numerator % denominator != 0) && ((numerator < 0) != (denominator < 0)))
+		quotient--;
+	return quotient;
+}
+
+static int GetChunkDistance(const IntVector2& chunkCoordsA, const IntVector2& chunkCoordsB)
+{
+	return std::max(abs(chunkCoordsA.x - chunkCoordsB.x), abs(chunkCoordsA.y - chunkCoordsB.y));
+}
+
+
+OverworldStreamer::OverworldStreamer(const MapGeneratorOverworld* generator, unsigned int noiseSeed, const IntVector2& windowDimensions)
+	: m_generator(generator)
+	, m_noiseSeed(noiseSeed)
+	, m_chunkSize(generator->m_chunkSize)
+	, m_windowDimensions(windowDimensions)
+{
+	//The budget never drops below what the window plus its prefetch ring needs, or chunks would thrash every turn
+	int bytesPerChunk = m_chunkSize * m_chunkSize * (int)sizeof(TileTypeID);
+	int chunksAcross = (2 * (GetWindowRadiusInChunks() + generator->m_prefetchRadius)) + 1;
+	m_maxResidentChunks = std::max((generator->m_memoryBudgetKB * 1024) / bytesPerChunk, chunksAcross * chunksAcross);
+	m_maxCompressedBytes = (size_t)std::max(generator->m_compressedBudgetKB, 0) * 1024;
+}
+
+OverworldStreamer::~OverworldStreamer()
+{
+	for (std::map<unsigned long long, OverworldChunk*>::iterator chunkIter = m_chunks.begin(); chunkIter != m_chunks.end(); ++chunkIter)
+	{
+		if (g_theJobSystem)
+			g_theJobSystem->WaitForCounter(chunkIter->second->m_jobCounter);
+		delete chunkIter->second;
+	}
+
+	for (std::map<unsigned long long, std::vector<OverworldStashedTile>>::iterator stashIter = m_stashedTilesByChunk.begin(); stashIter != m_stashedTilesByChunk.end(); ++stashIter)
+	{
+		for (OverworldStashedTile& stashedTile : stashIter->second)
+		{
+			delete stashedTile.m_character;
+			delete stashedTile.m_feature;
+			for (Item* item : stashedTile.m_items)
+			{
+				delete item;
+			}
+		}
+	}
+}
+
+void OverworldStreamer::RequestChunksAround(const IntVector2& worldTileCoords, int radiusInChunks)
+{
+	IntVector2 centerChunkCoords = GetChunkCoordsForWorldTile(worldTileCoords);
+
+	//Nearest rings first, so the chunks the player reaches soonest are queued ahead of the rest
+	for (int ringIndex = 0; ringIndex <= radiusInChunks; ringIndex++)
+	{
+		for (int yOffset = -ringIndex; yOffset <= ringIndex; yOffset++)
+		{
+			for (int xOffset = -ringIndex; xOffset <= ringIndex; xOffset++)
+			{
+				if (std::max(abs(xOffset), abs(yOffset)) == ringIndex)
+					GetOrRequestChunk(centerChunkCoords + IntVector2(xOffset, yOffset));
+			}
+		}
+	}
+}
+
+bool OverworldStreamer::AreChunksResident(const IntVector2& worldTileMins, const IntVector2& worldTileMaxs)
+{
+	IntVector2 minChunkCoords = GetChunkCoordsForWorldTile(worldTileMins);
+	IntVector2 maxChunkCoords = GetChunkCoordsForWorldTile(worldTileMaxs);
+	for (int chunkY = minChunkCoords.y; chunkY <= maxChunkCoords.y; chunkY++)
+	{
+		for (int chunkX = minChunkCoords.x; chunkX <= maxChunkCoords.x; chunkX++)
+		{
+			if (!TryGetResidentChunk(IntVector2(chunkX, chunkY)))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+bool OverworldStreamer::TryGetTileType(const IntVector2& worldTileCoords, TileTypeID& out_tileType)
+{
+	IntVector2 chunkCoords = GetChunkCoordsForWorldTile(worldTileCoords);
+	const OverworldChunk* chunk = TryGetResidentChunk(chunkCoords);
+	if (!chunk)
+		return false;
+
+	IntVector2 localCoords = worldTileCoords - IntVector2(chunkCoords.x * m_chunkSize, chunkCoords.y * m_chunkSize);
+	out_tileType = chunk->m_tileTypes[(localCoords.y * m_chunkSize) + localCoords.x];
+	return true;
+}
+
+//Only for map generation, which already runs off the turn loop
+TileTypeID OverworldStreamer::GetTileTypeBlocking(const IntVector2& worldTileCoords)
+{
+	OverworldChunk* chunk = GetOrRequestChunk(GetChunkCoordsForWorldTile(worldTileCoords));
+	if (g_theJobSystem)
+		g_theJobSystem->WaitForCounter(chunk->m_jobCounter);
+
+	TileTypeID tileType = 0;
+	TryGetTileType(worldTileCoords, tileType);
+	return tileType;
+}
+
+void OverworldStreamer::EnforceMemoryBudget(const IntVector2& worldTileCoords)
+{
+	IntVector2 centerChunkCoords = GetChunkCoordsForWorldTile(worldTileCoords);
+	CompressFarChunks(centerChunkCoords);
+	DropFarCompressedChunks(centerChunkCoords);
+}
+
+void OverworldStreamer::StashTile(const OverworldStashedTile& stashedTile)
+{
+	m_stashedTilesByChunk[GetChunkKey(GetChunkCoordsForWorldTile(stashedTile.m_worldTileCoords))].push_back(stashedTile);
+}
+
+//Hands back, and forgets, everything stashed inside the area, in the order it was stashed chunk by chunk
+void OverworldStreamer::TakeStashedTiles(const IntVector2& worldTileMins, const IntVector2& worldTileMaxs, std::vector<OverworldStashedTile>& out_stashedTiles)
+{
+	IntVector2 minChunkCoords = GetChunkCoordsForWorldTile(worldTileMins);
+	IntVector2 maxChunkCoords = GetChunkCoordsForWorldTile(worldTileMaxs);
+	for (int chunkY = minChunkCoords.y; chunkY <= maxChunkCoords.y; chunkY++)
+	{
+		for (int chunkX = minChunkCoords.x; chunkX <= maxChunkCoords.x; chunkX++)
+		{
+			std::map<unsigned long long, std::vector<OverworldStashedTile>>::iterator found = m_stashedTilesByChunk.find(GetChunkKey(IntVector2(chunkX, chunkY)));
+			if (found == m_stashedTilesByChunk.end())
+				continue;
+
+			std::vector<OverworldStashedTile>& stashedTiles = found->second;
+			size_t numStillStashed = 0;
+			for (size_t stashIndex = 0; stashIndex < stashedTiles.size(); stashIndex++)
+			{
+				const IntVector2& worldTileCoords = stashedTiles[stashIndex].m_worldTileCoords;
+				if (worldTileCoords.x >= worldTileMins.x && worldTileCoords.y >= worldTileMins.y && worldTileCoords.x <= worldTileMaxs.x && worldTileCoords.y <= worldTileMaxs.y)
+				{
+					out_stashedTiles.push_back(stashedTiles[stashIndex]);
+					continue;
+				}
+
+				stashedTiles[numStillStashed] = stashedTiles[stashIndex];
+				numStillStashed++;
+			}
+
+			stashedTiles.resize(numStillStashed);
+			if (stashedTiles.empty())
+				m_stashedTilesByChunk.erase(found);
+		}
+	}
+}
+IntVector2 OverworldStreamer::GetChunkCoordsForWorldTile(const IntVector2& worldTileCoords) const
+{
+	return IntVector2(FloorDivide(worldTileCoords.x, m_chunkSize), FloorDivide(worldTileCoords.y, m_chunkSize));
+}
+
+//How many chunks from the player's chunk a window centered on the player can reach
+int OverworldStreamer::GetWindowRadiusInChunks() const
+{
+	int halfWindowSize = std::max(m_windowDimensions.x, m_windowDimensions.y) / 2;
+	return (halfWindowSize / m_chunkSize) + 1;
+}
+
+OverworldStreamerStats OverworldStreamer::GetStats() const
+{
+	OverworldStreamerStats stats;
+	for (std::map<unsigned long long, OverworldChunk*>::const_iterator chunkIter = m_chunks.begin(); chunkIter != m_chunks.end(); ++chunkIter)
+	{
+		const OverworldChunk* chunk = chunkIter->second;
+		switch (chunk->m_state)
+		{
+		case CHUNK_RESIDENT:
+			stats.m_numResidentChunks++;
+			stats.m_residentBytes += chunk->m_tileTypes.size() * sizeof(TileTypeID);
+			break;
+		case CHUNK_COMPRESSED:
+			stats.m_numCompressedChunks++;
+			stats.m_compressedBytes += chunk->m_compressedTileTypes.size();
+			break;
+		default:
+			stats.m_numPendingChunks++;
+			break;
+		}
+	}
+
+	for (std::map<unsigned long long, std::vector<OverworldStashedTile>>::const_iterator stashIter = m_stashedTilesByChunk.begin(); stashIter != m_stashedTilesByChunk.end(); ++stashIter)
+	{
+		stats.m_numStashedTiles += (int)stashIter->second.size();
+	}
+
+	return stats;
+}
+
+OverworldChunk* OverworldStreamer::GetOrRequestChunk(const IntVector2& chunkCoords)
+{
+	unsigned long long chunkKey = GetChunkKey(chunkCoords);
+	std::map<unsigned long long, OverworldChunk*>::iterator found = m_chunks.find(chunkKey);
+	if (found == m_chunks.end())
+	{
+		OverworldChunk* newChunk = new OverworldChunk(chunkCoords);
+		m_chunks[chunkKey] = newChunk;
+
+		const MapGeneratorOverworld* generator = m_generator;
+		unsigned int noiseSeed = m_noiseSeed;
+		QueueChunkWork(newChunk, [newChunk, generator, noiseSeed]()
+		{
+			generator->GenerateChunkTileTypes(newChunk->m_chunkCoords, noiseSeed, newChunk->m_tileTypes);
+		});
+		return newChunk;
+	}
+
+	OverworldChunk* chunk = found->second;
+	if (chunk->m_state == CHUNK_COMPRESSED)
+	{
+		chunk->m_state = CHUNK_INFLATING;
+		size_t numTiles = m_chunkSize * m_chunkSize;
+		QueueChunkWork(chunk, [chunk, numTiles]()
+		{
+			DecompressTileTypes(chunk->m_compressedTileTypes, numTiles, chunk->m_tileTypes);
+			std::vector<unsigned char>().swap(chunk->m_compressedTileTypes);
+		});
+	}
+
+	return chunk;
+}
+
+const OverworldChunk* OverworldStreamer::TryGetResidentChunk(const IntVector2& chunkCoords)
+{
+	std::map<unsigned long long, OverworldChunk*>::iterator found = m_chunks.find(GetChunkKey(chunkCoords));
+	if (found == m_chunks.end() || found->second->m_state != CHUNK_RESIDENT)
+		return nullptr;
+
+	return found->second;
+}
+
+void OverworldStreamer::CompressFarChunks(const IntVector2& centerChunkCoords)
+{
+	int numResidentChunks = 0;
+	std::vector<OverworldChunk*> evictionCandidates;
+	int protectedRadius = GetWindowRadiusInChunks() + m_generator->m_prefetchRadius;
+	for (std::map<unsigned long long, OverworldChunk*>::iterator chunkIter = m_chunks.begin(); chunkIter != m_chunks.end(); ++chunkIter)
+	{
+		OverworldChunk* chunk = chunkIter->second;
+		if (chunk->m_state == CHUNK_COMPRESSED)
+			continue;
+
+		numResidentChunks++;
+		if (chunk->m_state == CHUNK_RESIDENT && GetChunkDistance(chunk->m_chunkCoords, centerChunkCoords) > protectedRadius)
+			evictionCandidates.push_back(chunk);
+	}
+
+	if (numResidentChunks <= m_maxResidentChunks)
+		return;
+
+	std::sort(evictionCandidates.begin(), evictionCandidates.end(), [&](const OverworldChunk* chunkA, const OverworldChunk* chunkB)
+	{
+		return GetChunkDistance(chunkA->m_chunkCoords, centerChunkCoords) > GetChunkDistance(chunkB->m_chunkCoords, centerChunkCoords);
+	});
+
+	for (OverworldChunk* chunk : evictionCandidates)
+	{
+		if (numResidentChunks <= m_maxResidentChunks)
+			break;
+
+		CompressTileTypes(chunk->m_tileTypes, chunk->m_compressedTileTypes);
+		std::vector<TileTypeID>().swap(chunk->m_tileTypes);
+		chunk->m_state = CHUNK_COMPRESSED;
+		numResidentChunks--;
+	}
+}
+
+//A chunk's job flips its state before it releases the counter, so a chunk is only safe to delete once both are done
+void OverworldStreamer::DropFarCompressedChunks(const IntVector2& centerChunkCoords)
+{
+	size_t compressedBytes = 0;
+	std::vector<OverworldChunk*> dropCandidates;
+	for (std::map<unsigned long long, OverworldChunk*>::iterator chunkIter = m_chunks.begin(); chunkIter != m_chunks.end(); ++chunkIter)
+	{
+		OverworldChunk* chunk = chunkIter->second;
+		if (chunk->m_state != CHUNK_COMPRESSED)
+			continue;
+
+		compressedBytes += chunk->m_compressedTileTypes.size();
+		if (chunk->m_jobCounter.m_numJobsRemaining == 0)
+			dropCandidates.push_back(chunk);
+	}
+
+	if (compressedBytes <= m_maxCompressedBytes)
+		return;
+
+	std::sort(dropCandidates.begin(), dropCandidates.end(), [&](const OverworldChunk* chunkA, const OverworldChunk* chunkB)
+	{
+		return GetChunkDistance(chunkA->m_chunkCoords, centerChunkCoords) > GetChunkDistance(chunkB->m_chunkCoords, centerChunkCoords);
+	});
+
+	for (OverworldChunk* chunk : dropCandidates)
+	{
+		if (compressedBytes <= m_maxCompressedBytes)
+			break;
+
+		compressedBytes -= chunk->m_compressedTileTypes.size();
+		m_chunks.erase(GetChunkKey(chunk->m_chunkCoords));
+		delete chunk;
+	}
+}
+
+//The job only touches its own chunk, and publishes the result by flipping the chunk's state last
+void OverworldStreamer::QueueChunkWork(OverworldChunk* chunk, const std::function<void()>& work)
+{
+	std::function<void()> chunkWork = [chunk, work]()
+	{
+		work();
+		chunk->m_state = CHUNK_RESIDENT;
+	};
+
+	if (g_theJobSystem)
+		g_theJobSystem->QueueJob(chunkWork, &chunk->m_jobCounter);
+	else
+		chunkWork();
+}
+
+unsigned long long OverworldStreamer::GetChunkKey(const IntVector2& chunkCoords)
+{
+	return ((unsigned long long)(unsigned int)chunkCoords.x << 32) | (unsigned int)chunkCoords.y;
+}
+
+//Runs of (count, type). Overworld terrain is mostly large patches, so this is usually a small fraction of the raw size.
+void OverworldStreamer::CompressTileTypes(const std::vector<TileTypeID>& tileTypes, std::vector<unsigned char>& out_compressed)
+{
+	out_compressed.clear();
+	size_t tileIndex = 0;
+	while (tileIndex < tileTypes.size())
+	{
+		TileTypeID runType = tileTypes[tileIndex];
+		unsigned short runLength = 0;
+		while (tileIndex < tileTypes.size() && tileTypes[tileIndex] == runType && runLength < 0xFFFF)
+		{
+			runLength++;
+			tileIndex++;
+		}
+
+		WriteBytes(out_compressed, &runLength, sizeof(runLength));
+		WriteBytes(out_compressed, &runType, sizeof(runType));
+	}
+}
+
+void OverworldStreamer::DecompressTileTypes(const std::vector<unsigned char>& compressed, size_t numTiles, std::vector<TileTypeID>& out_tileTypes)
+{
+	out_tileTypes.clear();
+	out_tileTypes.reserve(numTiles);
+
+	BinaryBufferReader reader(compressed);
+	while (out_tileTypes.size() < numTiles)
+	{
+		unsigned short runLength = 0;
+		TileTypeID runType = 0;
+		reader.ReadBytes(&runLength, sizeof(runLength));
+		reader.ReadBytes(&runType, sizeof(runType));
+		if (!reader.IsValid() || runLength == 0)
+			break;
+
+		out_tileTypes.insert(out_tileTypes.end(), runLength, runType);
+	}
+
+	out_tileTypes.resize(numTiles, 0);
+}
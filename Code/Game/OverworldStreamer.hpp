@@ -0,0 +1,97 @@
+#pragma once
+#include <atomic>
+#include <map>
+#include <vector>
+#include "Engine/Math/IntVector2.hpp"
+#include "Game/TileDefinition.hpp"
+#include "Game/JobSystem.hpp"
+
+
+class MapGeneratorOverworld;
+class Character;
+class Feature;
+class Item;
+
+enum OverworldChunkState
+{
+	CHUNK_GENERATING,
+	CHUNK_INFLATING,
+	CHUNK_RESIDENT,
+	CHUNK_COMPRESSED
+};
+
+struct OverworldChunk
+{
+	OverworldChunk(const IntVector2& chunkCoords)
+		: m_chunkCoords(chunkCoords)
+		, m_state(CHUNK_GENERATING) {}
+
+	IntVector2 m_chunkCoords;
+	std::atomic<int> m_state;
+	std::vector<TileTypeID> m_tileTypes;
+	std::vector<unsigned char> m_compressedTileTypes;
+	JobCounter m_jobCounter;
+};
+
+//Whatever stood on one world tile when the window slid away from it, kept until the window comes back
+struct OverworldStashedTile
+{
+	IntVector2 m_worldTileCoords;
+	Character* m_character = nullptr;
+	Feature* m_feature = nullptr;
+	std::vector<Item*> m_items;
+};
+
+struct OverworldStreamerStats
+{
+	int m_numResidentChunks = 0;
+	int m_numPendingChunks = 0;
+	int m_numCompressedChunks = 0;
+	size_t m_residentBytes = 0;
+	size_t m_compressedBytes = 0;
+	int m_numStashedTiles = 0;
+};
+
+//Streams fixed-size chunks of an unbounded overworld. Chunks are generated or inflated on the job system and only ever
+//read once resident, so nothing on the turn loop waits for them. Chunks past the memory budget are run-length compressed
+//in place, and compressed chunks past their own budget are dropped, farthest first; terrain is a pure function of the seed,
+//so a dropped chunk is simply generated again. Entities and items that leave the window are stashed by chunk, apart from
+//the terrain, so dropping terrain never loses them. A streamer belongs to one map and is only touched by one thread at a time.
+class OverworldStreamer
+{
+public:
+	OverworldStreamer(const MapGeneratorOverworld* generator, unsigned int noiseSeed, const IntVector2& windowDimensions);
+	~OverworldStreamer();
+
+	void RequestChunksAround(const IntVector2& worldTileCoords, int radiusInChunks);
+	bool AreChunksResident(const IntVector2& worldTileMins, const IntVector2& worldTileMaxs);
+	bool TryGetTileType(const IntVector2& worldTileCoords, TileTypeID& out_tileType);
+	TileTypeID GetTileTypeBlocking(const IntVector2& worldTileCoords);
+	void EnforceMemoryBudget(const IntVector2& worldTileCoords);
+	void StashTile(const OverworldStashedTile& stashedTile);
+	void TakeStashedTiles(const IntVector2& worldTileMins, const IntVector2& worldTileMaxs, std::vector<OverworldStashedTile>& out_stashedTiles);
+
+	IntVector2 GetChunkCoordsForWorldTile(const IntVector2& worldTileCoords) const;
+	int GetWindowRadiusInChunks() const;
+	OverworldStreamerStats GetStats() const;
+
+	const MapGeneratorOverworld* m_generator;
+	unsigned int m_noiseSeed;
+	int m_chunkSize;
+	int m_maxResidentChunks;
+	size_t m_maxCompressedBytes;
+
+private:
+	OverworldChunk* GetOrRequestChunk(const IntVector2& chunkCoords);
+	const OverworldChunk* TryGetResidentChunk(const IntVector2& chunkCoords);
+	void CompressFarChunks(const IntVector2& centerChunkCoords);
+	void DropFarCompressedChunks(const IntVector2& centerChunkCoords);
+	void QueueChunkWork(OverworldChunk* chunk, const std::function<void()>& work);
+	static unsigned long long GetChunkKey(const IntVector2& chunkCoords);
+	static void CompressTileTypes(const std::vector<TileTypeID>& tileTypes, std::vector<unsigned char>& out_compressed);
+	static void DecompressTileTypes(const std::vector<unsigned char>& compressed, size_t numTiles, std::vector<TileTypeID>& out_tileTypes);
+
+	IntVector2 m_windowDimensions;
+	std::map<unsigned long long, OverworldChunk*> m_chunks;
+	std::map<unsigned long long, std::vector<OverworldStashedTile>> m_stashedTilesByChunk;
+};
@@ -20,9 +20,9 @@ PatrolBehavior::~PatrolBehavior()
 
 }
 
-void PatrolBehavior::Act(Character* actingCharacter)
+void PatrolBehavior::Plan(Character* actingCharacter, PlannedAction& out_action)
 {
-	if (actingCharacter->m_target == nullptr)
+	if (actingCharacter->GetTarget() == nullptr)
 	{
 		std::vector<Character*> potentialTargets = actingCharacter->m_currentMap->FindAllCharactersNotOfFaction(actingCharacter->m_faction);
 		for (Character* character : potentialTargets)
@@ -31,7 +31,7 @@ void PatrolBehavior::Act(Character* actingCharacter)
 			RaycastResult result = actingCharacter->m_currentMap->RaycastForOpaque(Vector2(actingCharacter->m_currentTile->m_tileCoords) + Vector2(0.5f, 0.5f), displacementToPotentialTarget.GetNormalized(), displacementToPotentialTarget.CalcLength());
 			if (!result.m_didImpact)
 			{
-				actingCharacter->m_target = character;
+				actingCharacter->SetTarget(character);
 				return;
 			}
 		}
@@ -40,21 +40,40 @@ void PatrolBehavior::Act(Character* actingCharacter)
 	if (!m_patrolTarget || actingCharacter->m_currentTile == m_patrolTarget)
 	{
 		//generate new target
-		m_patrolTarget = actingCharacter->m_currentMap->GetRandomTileWithTags(m_patrolPointTags);
-		m_patrolPath = actingCharacter->m_currentMap->GeneratePath(actingCharacter->m_currentTile->m_tileCoords, m_patrolTarget->m_tileCoords, actingCharacter);
+		m_patrolTarget = actingCharacter->m_currentMap->GetRandomTileWithTags(m_patrolPointTags, actingCharacter->m_random);
+		m_isPathBlocked = true;
 	}
 
-	if(!m_patrolPath.empty())
+	if (m_isPathBlocked)
 	{
-		Tile* nextTile = *(m_patrolPath.end() - 1);
-		bool successfullyMoved = actingCharacter->m_currentMap->TryToMoveCharacterToTile(actingCharacter, nextTile);
-		if (successfullyMoved)
-			m_patrolPath.pop_back();
-		else
+		if (m_patrolTarget)
 			m_patrolPath = actingCharacter->m_currentMap->GeneratePath(actingCharacter->m_currentTile->m_tileCoords, m_patrolTarget->m_tileCoords, actingCharacter);
+		else
+			m_patrolPath.clear();
+		m_isPathBlocked = false;
 	}
 
-	actingCharacter->m_turnsUntilAction = 1;
+	if(!m_patrolPath.empty())
+		PlanMoveToTile(*(m_patrolPath.end() - 1), out_action);
+}
+
+void PatrolBehavior::OnActionResolved(Character* actingCharacter, const PlannedAction& action, bool wasSuccessful)
+{
+	UNUSED(actingCharacter);
+	if (action.m_type != PLANNED_ACTION_MOVE)
+		return;
+
+	//A blocked patrol re-paths on its next plan, from wherever everyone has moved to by then
+	if (wasSuccessful && !m_patrolPath.empty())
+		m_patrolPath.pop_back();
+	else if (!wasSuccessful)
+		m_isPathBlocked = true;
+}
+
+void PatrolBehavior::InvalidatePath()
+{
+	m_patrolTarget = nullptr;
+	m_patrolPath.clear();
 }
 
 float PatrolBehavior::CalcUtility(Character* actingCharacter) const
@@ -71,6 +90,7 @@ std::string PatrolBehavior::GetName() const
 void PatrolBehavior::DebugRender(const Character* actingCharacter) const
 {
 	UNUSED(actingCharacter);
+#ifndef ROGUELIKE_HEADLESS
 	for (size_t tileIndex = 1; tileIndex < m_patrolPath.size(); tileIndex++)
 	{
 		Tile* tile = m_patrolPath[tileIndex];
@@ -78,6 +98,7 @@ void PatrolBehavior::DebugRender(const Character* actingCharacter) const
 	}
 	if(m_patrolTarget)
 		g_theRenderer->DrawCenteredText2D((Vector2)m_patrolTarget->m_tileCoords + Vector2(0.5f, 0.5f), g_theRenderer->m_defaultFont, "T", Rgba::RED, 0.5f);
+#endif
 }
 
 Behavior* PatrolBehavior::Clone()
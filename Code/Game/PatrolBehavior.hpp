@@ -12,11 +12,14 @@ public:
 
 	Tile* m_patrolTarget;
 	Path m_patrolPath;
+	bool m_isPathBlocked = false;
 	std::string m_patrolPointTags;
 	float m_baseUtility = 0.3f;
 
-	virtual void Act(Character* actingCharacter) override;
+	virtual void Plan(Character* actingCharacter, PlannedAction& out_action) override;
+	virtual void OnActionResolved(Character* actingCharacter, const PlannedAction& action, bool wasSuccessful) override;
 	virtual float CalcUtility(Character* actingCharacter) const override;
+	virtual void InvalidatePath() override;
 	virtual std::string GetName() const override;
 	virtual void DebugRender(const Character* actingCharacter) const override;
 
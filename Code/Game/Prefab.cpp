@@ -0,0 +1,251 @@
+#include "Game/Prefab.hpp"
+#include "Game/BinaryBuffer.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/XMLUtils.hpp"
+#include "ThirdParty/XMLParser/XMLParser.hpp"
+
+
+const TileTypeID Prefab::EMPTY_TILE_TYPE = 0xFFFE;
+const TileTypeID Prefab::UNUSED_GLYPH_TILE_TYPE = 0xFFFF;
+const std::string Prefab::BINARY_FILE_EXTENSION = ".prefab";
+const unsigned int Prefab::BINARY_FILE_MAGIC = 0x46504c52;		//"RLPF"
+const unsigned int Prefab::BINARY_FILE_VERSION = 1;
+
+
+static void ParsePlacements(const XMLNode& parentNode, const char* childName, std::vector<PrefabPlacement>& out_placements)
+{
+	for (int placementIndex = 0; placementIndex < parentNode.nChildNode(childName); placementIndex++)
+	{
+		XMLNode placementNode = parentNode.getChildNode(childName, placementIndex);
+		PrefabPlacement placement;
+		placement.m_name = ParseXMLAttributeString(placementNode, "name", "");
+		placement.m_position = ParseXMLAttributeIntVector2(placementNode, "position", IntVector2(-1, -1));
+		ASSERT_OR_DIE(placement.m_position != IntVector2(-1, -1), "Missing position for prefab placement.");
+		out_placements.push_back(placement);
+	}
+}
+
+static void WritePlacements(std::vector<unsigned char>& out_buffer, const std::vector<PrefabPlacement>& placements)
+{
+	unsigned short numPlacements = (unsigned short)placements.size();
+	WriteBytes(out_buffer, &numPlacements, sizeof(numPlacements));
+	for (const PrefabPlacement& placement : placements)
+	{
+		WriteString(out_buffer, placement.m_name);
+		WriteBytes(out_buffer, &placement.m_position.x, sizeof(placement.m_position.x));
+		WriteBytes(out_buffer, &placement.m_position.y, sizeof(placement.m_position.y));
+	}
+}
+
+static void ReadPlacements(BinaryBufferReader& reader, std::vector<PrefabPlacement>& out_placements)
+{
+	unsigned short numPlacements = 0;
+	reader.ReadBytes(&numPlacements, sizeof(numPlacements));
+	for (unsigned short placementIndex = 0; placementIndex < numPlacements && reader.IsValid(); placementIndex++)
+	{
+		PrefabPlacement placement;
+		placement.m_name = reader.ReadString();
+		reader.ReadBytes(&placement.m_position.x, sizeof(placement.m_position.x));
+		reader.ReadBytes(&placement.m_position.y, sizeof(placement.m_position.y));
+		out_placements.push_back(placement);
+	}
+}
+
+
+Prefab::Prefab()
+	: m_dimensions(0, 0)
+{
+	for (int glyph = 0; glyph < 256; glyph++)
+	{
+		m_tileTypeByGlyph[glyph] = UNUSED_GLYPH_TILE_TYPE;
+	}
+}
+
+Prefab* Prefab::LoadFromFile(const std::string& filename)
+{
+	Prefab* newPrefab = new Prefab();
+
+	bool isBinary = filename.size() > BINARY_FILE_EXTENSION.size() && filename.compare(filename.size() - BINARY_FILE_EXTENSION.size(), BINARY_FILE_EXTENSION.size(), BINARY_FILE_EXTENSION) == 0;
+	bool wasLoaded;
+	if (isBinary)
+		wasLoaded = newPrefab->LoadBinaryFile(filename);
+	else
+		wasLoaded = newPrefab->LoadXMLFile(filename);
+
+	ASSERT_OR_DIE(wasLoaded, "Failed to load prefab file.");
+	newPrefab->CheckGlyphsAreInLegend();
+	return newPrefab;
+}
+
+bool Prefab::SaveBinaryFile(const std::string& filename) const
+{
+	std::vector<unsigned char> buffer;
+	WriteBinaryBuffer(buffer);
+	return WriteBufferToFile(filename, buffer);
+}
+
+//Mirrors across the vertical axis first, then rotates by 90 degree steps counterclockwise, keeping the result in the positive quadrant
+IntVector2 Prefab::TransformCoords(const IntVector2& prefabCoords, int rotation, bool isMirrored) const
+{
+	IntVector2 transformedCoords = prefabCoords;
+	if (isMirrored)
+		transformedCoords.x = m_dimensions.x - 1 - transformedCoords.x;
+
+	switch (rotation)
+	{
+	case 1:
+		return IntVector2(m_dimensions.y - 1 - transformedCoords.y, transformedCoords.x);
+	case 2:
+		return IntVector2(m_dimensions.x - 1 - transformedCoords.x, m_dimensions.y - 1 - transformedCoords.y);
+	case 3:
+		return IntVector2(transformedCoords.y, m_dimensions.x - 1 - transformedCoords.x);
+	default:
+		return transformedCoords;
+	}
+}
+
+//The baked binary form doubles as a canonical description of the prefab, independent of XML formatting
+std::string Prefab::GetSourceData() const
+{
+	std::vector<unsigned char> buffer;
+	WriteBinaryBuffer(buffer);
+	return std::string(buffer.begin(), buffer.end());
+}
+
+bool Prefab::LoadXMLFile(const std::string& filename)
+{
+	XMLNode mapHead = XMLNode::parseFile(filename.c_str(), "Map");
+	if (mapHead.isEmpty())
+		return false;
+
+	XMLNode legendNode = mapHead.getChildNode("Legend");
+	for (int tileIndex = 0; tileIndex < legendNode.nChildNode("Tile"); tileIndex++)
+	{
+		XMLNode tileNode = legendNode.getChildNode("Tile", tileIndex);
+		const char glyph = ParseXMLAttributeChar(tileNode, "glyph", ' ');
+		std::string tileName = ParseXMLAttributeString(tileNode, "tile", "");
+		ASSERT_OR_DIE(glyph != ' ' && tileName != "", "Missing or invalid glyph or tile name.");
+
+		SetLegendEntry((unsigned char)glyph, tileName);
+	}
+
+	//Rows are listed top to bottom, but the glyph grid stores the bottom row first to match tile coordinates
+	XMLNode tiles = mapHead.getChildNode("Tiles");
+	m_dimensions = ParseXMLAttributeIntVector2(tiles, "dimensions", IntVector2(0, 0));
+	int numRows = tiles.nChildNode("Row");
+	ASSERT_OR_DIE(numRows == m_dimensions.y, "Mismatching number of rows and dimension of map.");
+
+	m_glyphs.resize(m_dimensions.x * m_dimensions.y);
+	for (int rowNodeIndex = 0; rowNodeIndex < numRows; rowNodeIndex++)
+	{
+		std::string row = ParseXMLAttributeString(tiles.getChildNode("Row", rowNodeIndex), "tiles", "");
+		ASSERT_OR_DIE(row.length() == (size_t)m_dimensions.x, "Mismatching length of row and dimension of map.");
+
+		int yIndex = numRows - 1 - rowNodeIndex;
+		for (int xIndex = 0; xIndex < m_dimensions.x; xIndex++)
+		{
+			m_glyphs[(yIndex * m_dimensions.x) + xIndex] = (unsigned char)row[xIndex];
+		}
+	}
+
+	ParsePlacements(mapHead.getChildNode("Characters"), "Character", m_characters);
+	ParsePlacements(mapHead.getChildNode("Features"), "Feature", m_features);
+	ParsePlacements(mapHead.getChildNode("Items"), "Item", m_items);
+	return true;
+}
+
+bool Prefab::LoadBinaryFile(const std::string& filename)
+{
+	std::vector<unsigned char> buffer;
+	if (!ReadFileIntoBuffer(filename, buffer))
+		return false;
+
+	BinaryBufferReader reader(buffer);
+	unsigned int magic = 0;
+	unsigned int version = 0;
+	reader.ReadBytes(&magic, sizeof(magic));
+	reader.ReadBytes(&version, sizeof(version));
+	reader.ReadBytes(&m_dimensions.x, sizeof(m_dimensions.x));
+	reader.ReadBytes(&m_dimensions.y, sizeof(m_dimensions.y));
+	if (!reader.IsValid() || magic != BINARY_FILE_MAGIC || version != BINARY_FILE_VERSION || m_dimensions.x <= 0 || m_dimensions.y <= 0)
+		return false;
+
+	//Tile types are stored by name so baked prefabs survive reordering Tiles.xml
+	unsigned short numLegendEntries = 0;
+	reader.ReadBytes(&numLegendEntries, sizeof(numLegendEntries));
+	for (unsigned short legendIndex = 0; legendIndex < numLegendEntries && reader.IsValid(); legendIndex++)
+	{
+		unsigned char glyph = 0;
+		reader.ReadBytes(&glyph, sizeof(glyph));
+		std::string tileName = reader.ReadString();
+		if (reader.IsValid())
+			SetLegendEntry(glyph, tileName);
+	}
+
+	//One glyph byte per cell, so a corrupt size is caught here rather than by allocating for it
+	if (!reader.IsValid() || (unsigned long long)m_dimensions.x * (unsigned long long)m_dimensions.y > reader.GetNumBytesRemaining())
+		return false;
+
+	m_glyphs.resize(m_dimensions.x * m_dimensions.y);
+	reader.ReadBytes(&m_glyphs[0], m_glyphs.size());
+
+	ReadPlacements(reader, m_characters);
+	ReadPlacements(reader, m_features);
+	ReadPlacements(reader, m_items);
+	return reader.IsValid();
+}
+
+void Prefab::SetLegendEntry(unsigned char glyph, const std::string& tileName)
+{
+	if (tileName == "EMPTY")
+	{
+		m_tileTypeByGlyph[glyph] = EMPTY_TILE_TYPE;
+		return;
+	}
+
+	TileDefinition* tileDefinition = TileDefinition::GetTileDefinition(tileName);
+	ASSERT_OR_DIE(tileDefinition != nullptr, "Prefab legend uses an unknown tile type.");
+	m_tileTypeByGlyph[glyph] = tileDefinition->m_typeID;
+}
+
+void Prefab::CheckGlyphsAreInLegend() const
+{
+	for (unsigned char glyph : m_glyphs)
+	{
+		if (m_tileTypeByGlyph[glyph] == UNUSED_GLYPH_TILE_TYPE)
+			ERROR_AND_DIE("Attempted to use glyph not found in legend.");
+	}
+}
+
+void Prefab::WriteBinaryBuffer(std::vector<unsigned char>& out_buffer) const
+{
+	WriteBytes(out_buffer, &BINARY_FILE_MAGIC, sizeof(BINARY_FILE_MAGIC));
+	WriteBytes(out_buffer, &BINARY_FILE_VERSION, sizeof(BINARY_FILE_VERSION));
+	WriteBytes(out_buffer, &m_dimensions.x, sizeof(m_dimensions.x));
+	WriteBytes(out_buffer, &m_dimensions.y, sizeof(m_dimensions.y));
+
+	std::vector<unsigned char> legendGlyphs;
+	for (int glyph = 0; glyph < 256; glyph++)
+	{
+		if (m_tileTypeByGlyph[glyph] != UNUSED_GLYPH_TILE_TYPE)
+			legendGlyphs.push_back((unsigned char)glyph);
+	}
+
+	unsigned short numLegendEntries = (unsigned short)legendGlyphs.size();
+	WriteBytes(out_buffer, &numLegendEntries, sizeof(numLegendEntries));
+	for (unsigned char glyph : legendGlyphs)
+	{
+		WriteBytes(out_buffer, &glyph, sizeof(glyph));
+		if (m_tileTypeByGlyph[glyph] == EMPTY_TILE_TYPE)
+			WriteString(out_buffer, "EMPTY");
+		else
+			WriteString(out_buffer, TileDefinition::GetTileDefinition(m_tileTypeByGlyph[glyph])->m_name);
+	}
+
+	if (!m_glyphs.empty())
+		WriteBytes(out_buffer, &m_glyphs[0], m_glyphs.size());
+
+	WritePlacements(out_buffer, m_characters);
+	WritePlacements(out_buffer, m_features);
+	WritePlacements(out_buffer, m_items);
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Engine/Math/IntVector2.hpp"
+#include "Game/TileDefinition.hpp"
+
+
+struct PrefabPlacement
+{
+	std::string m_name;
+	IntVector2 m_position;
+};
+
+//A hand-authored chunk of map, parsed once into a raw glyph grid plus a glyph to tile type table.
+//Rotation and mirroring are applied as coordinate transforms when stamping, so the parsed data is never copied.
+class Prefab
+{
+public:
+	Prefab();
+
+	//Files ending in BINARY_FILE_EXTENSION are read as baked binary prefabs, anything else as XML
+	static Prefab* LoadFromFile(const std::string& filename);
+	bool SaveBinaryFile(const std::string& filename) const;
+
+	TileTypeID GetTileTypeAtIndex(int glyphIndex) const { return m_tileTypeByGlyph[m_glyphs[glyphIndex]]; }
+	IntVector2 TransformCoords(const IntVector2& prefabCoords, int rotation, bool isMirrored) const;
+	std::string GetSourceData() const;
+
+	IntVector2 m_dimensions;
+	std::vector<unsigned char> m_glyphs;
+	TileTypeID m_tileTypeByGlyph[256];
+	std::vector<PrefabPlacement> m_characters;
+	std::vector<PrefabPlacement> m_features;
+	std::vector<PrefabPlacement> m_items;
+
+	static const TileTypeID EMPTY_TILE_TYPE;
+	static const TileTypeID UNUSED_GLYPH_TILE_TYPE;
+	static const std::string BINARY_FILE_EXTENSION;
+	static const unsigned int BINARY_FILE_MAGIC;
+	static const unsigned int BINARY_FILE_VERSION;
+
+private:
+	bool LoadXMLFile(const std::string& filename);
+	bool LoadBinaryFile(const std::string& filename);
+	void SetLegendEntry(unsigned char glyph, const std::string& tileName);
+	void CheckGlyphsAreInLegend() const;
+	void WriteBinaryBuffer(std::vector<unsigned char>& out_buffer) const;
+};
@@ -1,6 +1,6 @@
 #include "Game/PursueBehavior.hpp"
 #include "Game/GameCommon.hpp"
-#include "Game/App.hpp"
+#include "Game/Map.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Core/XMLUtils.hpp"
 #include "Engine/Core/EngineConfig.hpp"
@@ -22,28 +22,36 @@ PursueBehavior::~PursueBehavior()
 
 }
 
-void PursueBehavior::Act(Character* actingCharacter)
+void PursueBehavior::Plan(Character* actingCharacter, PlannedAction& out_action)
 {
-	if(actingCharacter->m_target)
+	if(actingCharacter->GetTarget())
 	{
-		if (m_pursuitPath.empty() || actingCharacter->m_target->m_currentTile->m_tileCoords != m_pursuitPath[0]->m_tileCoords)
+		if (m_pursuitPath.empty() || actingCharacter->GetTarget()->m_currentTile->m_tileCoords != m_pursuitPath[0]->m_tileCoords)
 		{
-			m_pursuitPath = actingCharacter->m_currentMap->GeneratePath(actingCharacter->m_currentTile->m_tileCoords, actingCharacter->m_target->m_currentTile->m_tileCoords, actingCharacter);
+			m_pursuitPath = actingCharacter->m_currentMap->GeneratePath(actingCharacter->m_currentTile->m_tileCoords, actingCharacter->GetTarget()->m_currentTile->m_tileCoords, actingCharacter);
 		}
 
-		Tile* nextTile = *(m_pursuitPath.end() - 1);
-		bool successfullyMoved = actingCharacter->m_currentMap->TryToMoveCharacterToTile(actingCharacter, nextTile);
-		if (successfullyMoved)
-			m_pursuitPath.pop_back();
+		if (!m_pursuitPath.empty())
+			PlanMoveToTile(*(m_pursuitPath.end() - 1), out_action);
 	}
+}
 
-	actingCharacter->m_turnsUntilAction = 1;
+void PursueBehavior::OnActionResolved(Character* actingCharacter, const PlannedAction& action, bool wasSuccessful)
+{
+	UNUSED(actingCharacter);
+	if (wasSuccessful && action.m_type == PLANNED_ACTION_MOVE && !m_pursuitPath.empty())
+		m_pursuitPath.pop_back();
 }
 
 
+void PursueBehavior::InvalidatePath()
+{
+	m_pursuitPath.clear();
+}
+
 float PursueBehavior::CalcUtility(Character* actingCharacter) const
 {
-	if (actingCharacter->m_target)
+	if (actingCharacter->GetTarget())
 		return m_utility;
 	return -1.f;
 }
@@ -55,13 +63,16 @@ std::string PursueBehavior::GetName() const
 
 void PursueBehavior::DebugRender(const Character* actingCharacter) const
 {
-	if(actingCharacter->m_target)
-		g_theRenderer->DrawLine2D((Vector2)actingCharacter->m_currentTile->m_tileCoords + Vector2(0.5f, 0.5f), (Vector2)actingCharacter->m_target->m_currentTile->m_tileCoords + Vector2(0.5f, 0.5f), 0.125f, Rgba::WHITE, Rgba::RED);
+	UNUSED(actingCharacter);
+#ifndef ROGUELIKE_HEADLESS
+	if(actingCharacter->GetTarget())
+		g_theRenderer->DrawLine2D((Vector2)actingCharacter->m_currentTile->m_tileCoords + Vector2(0.5f, 0.5f), (Vector2)actingCharacter->GetTarget()->m_currentTile->m_tileCoords + Vector2(0.5f, 0.5f), 0.125f, Rgba::WHITE, Rgba::RED);
 
 	for (Tile* tile : m_pursuitPath)
 	{
 		g_theRenderer->DrawCenteredText2D((Vector2)tile->m_tileCoords + Vector2(0.5f, 0.5f), g_theRenderer->m_defaultFont, "p", Rgba::BLUE, 0.5f);
 	}
+#endif
 }
 
 Behavior* PursueBehavior::Clone()
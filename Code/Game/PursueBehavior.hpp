@@ -11,8 +11,10 @@ public:
 	virtual ~PursueBehavior();
 	PursueBehavior(PursueBehavior* behaviorToCopy);
 
-	virtual void Act(Character* actingCharacter) override;
+	virtual void Plan(Character* actingCharacter, PlannedAction& out_action) override;
+	virtual void OnActionResolved(Character* actingCharacter, const PlannedAction& action, bool wasSuccessful) override;
 	virtual float CalcUtility(Character* actingCharacter) const override;
+	virtual void InvalidatePath() override;
 	virtual std::string GetName() const override;
 	virtual void DebugRender(const Character* actingCharacter) const override;
 
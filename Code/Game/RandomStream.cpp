@@ -0,0 +1,90 @@
+#include "Game/RandomStream.hpp"
+
+
+static unsigned long long SplitMix64(unsigned long long& state)
+{
+	state += 0x9E3779B97F4A7C15ULL;
+	unsigned long long result = state;
+	result = (result ^ (result >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	result = (result ^ (result >> 27)) * 0x94D049BB133111EBULL;
+	return result ^ (result >> 31);
+}
+
+static unsigned int RotateLeft(unsigned int value, int numBits)
+{
+	return (value << numBits) | (value >> (32 - numBits));
+}
+
+
+RandomStream::RandomStream(unsigned int seed)
+{
+	SetSeed(seed);
+}
+
+void RandomStream::SetSeed(unsigned int seed)
+{
+	unsigned long long splitMixState = seed;
+	unsigned long long firstHalf = SplitMix64(splitMixState);
+	unsigned long long secondHalf = SplitMix64(splitMixState);
+	m_state[0] = (unsigned int)firstHalf;
+	m_state[1] = (unsigned int)(firstHalf >> 32);
+	m_state[2] = (unsigned int)secondHalf;
+	m_state[3] = (unsigned int)(secondHalf >> 32);
+}
+
+unsigned int RandomStream::GetRandomUnsignedInt()
+{
+	unsigned int result = RotateLeft(m_state[1] * 5, 7) * 9;
+	unsigned int shifted = m_state[1] << 9;
+
+	m_state[2] ^= m_state[0];
+	m_state[3] ^= m_state[1];
+	m_state[1] ^= m_state[2];
+	m_state[0] ^= m_state[3];
+	m_state[2] ^= shifted;
+	m_state[3] = RotateLeft(m_state[3], 11);
+
+	return result;
+}
+
+int RandomStream::GetRandomIntLessThan(int maxNotInclusive)
+{
+	if (maxNotInclusive <= 0)
+		return 0;
+
+	return (int)(((unsigned long long)GetRandomUnsignedInt() * (unsigned long long)maxNotInclusive) >> 32);
+}
+
+int RandomStream::GetRandomIntInRange(int minInclusive, int maxInclusive)
+{
+	return minInclusive + GetRandomIntLessThan(maxInclusive - minInclusive + 1);
+}
+
+float RandomStream::GetRandomFloatZeroToOne()
+{
+	return (float)(GetRandomUnsignedInt() >> 8) * (1.f / 16777215.f);
+}
+
+float RandomStream::GetRandomFloatInRange(float minInclusive, float maxInclusive)
+{
+	return minInclusive + ((maxInclusive - minInclusive) * GetRandomFloatZeroToOne());
+}
+
+unsigned int RandomStream::DeriveSeed(unsigned int baseSeed, unsigned int streamIndex)
+{
+	unsigned long long splitMixState = ((unsigned long long)baseSeed << 32) | streamIndex;
+	return (unsigned int)SplitMix64(splitMixState);
+}
+
+//FNV-1a, used to turn names into stream indices that do not depend on the order things are created in
+unsigned int RandomStream::HashString(const std::string& stringToHash)
+{
+	unsigned int hash = 2166136261u;
+	for (char character : stringToHash)
+	{
+		hash ^= (unsigned char)character;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <string>
+
+
+//Small self-contained random number generator (xoshiro128**). Unlike the global rand() based helpers, each stream is
+//independent, so work split across threads can still produce the same results for the same seed.
+class RandomStream
+{
+public:
+	RandomStream(unsigned int seed = 0);
+
+	void SetSeed(unsigned int seed);
+
+	unsigned int GetRandomUnsignedInt();
+	int GetRandomIntLessThan(int maxNotInclusive);
+	int GetRandomIntInRange(int minInclusive, int maxInclusive);
+	float GetRandomFloatZeroToOne();
+	float GetRandomFloatInRange(float minInclusive, float maxInclusive);
+
+	static unsigned int DeriveSeed(unsigned int baseSeed, unsigned int streamIndex);
+	static unsigned int HashString(const std::string& stringToHash);
+
+private:
+	unsigned int m_state[4];
+};
@@ -0,0 +1,158 @@
+#include "Game/SessionRecording.hpp"
+#include "Game/BinaryBuffer.hpp"
+
+
+const unsigned int SessionRecording::FILE_MAGIC = 0x53534c52;		//"RLSS"
+const unsigned int SessionRecording::FILE_VERSION = 1;
+const int SessionRecording::DEFAULT_CHECKPOINT_INTERVAL = 100;
+
+//Each event starts with one byte: the event type in the top two bits and the command in the rest
+static const unsigned char EVENT_TYPE_SHIFT = 6;
+static const unsigned char EVENT_COMMAND_MASK = 0x3f;
+
+
+SessionRecording::SessionRecording()
+	: m_worldSeed(0)
+	, m_adventureName()
+	, m_checkpointInterval(DEFAULT_CHECKPOINT_INTERVAL)
+	, m_events()
+{
+
+}
+
+void SessionRecording::AddTurn(PlayerCommand command)
+{
+	SessionEvent newEvent;
+	newEvent.m_type = SESSION_EVENT_TURN;
+	newEvent.m_playerCommand = command;
+	m_events.push_back(newEvent);
+}
+
+void SessionRecording::AddInventoryCommand(InventoryCommand command, int itemIndex)
+{
+	SessionEvent newEvent;
+	newEvent.m_type = SESSION_EVENT_INVENTORY;
+	newEvent.m_inventoryCommand = command;
+	newEvent.m_itemIndex = itemIndex;
+	m_events.push_back(newEvent);
+}
+
+void SessionRecording::AddCheckpoint(unsigned long long stateHash)
+{
+	SessionEvent newEvent;
+	newEvent.m_type = SESSION_EVENT_CHECKPOINT;
+	newEvent.m_stateHash = stateHash;
+	m_events.push_back(newEvent);
+}
+
+bool SessionRecording::IsCheckpointDue(int numTurnsExecuted) const
+{
+	return m_checkpointInterval > 0 && numTurnsExecuted % m_checkpointInterval == 0;
+}
+
+int SessionRecording::CountTurns() const
+{
+	int numTurns = 0;
+	for (const SessionEvent& sessionEvent : m_events)
+	{
+		if (sessionEvent.m_type == SESSION_EVENT_TURN)
+			numTurns++;
+	}
+
+	return numTurns;
+}
+
+bool SessionRecording::SaveToFile(const std::string& filePath) const
+{
+	std::vector<unsigned char> buffer;
+	WriteBytes(buffer, &FILE_MAGIC, sizeof(FILE_MAGIC));
+	WriteBytes(buffer, &FILE_VERSION, sizeof(FILE_VERSION));
+	WriteBytes(buffer, &m_worldSeed, sizeof(m_worldSeed));
+	WriteString(buffer, m_adventureName);
+	WriteBytes(buffer, &m_checkpointInterval, sizeof(m_checkpointInterval));
+
+	unsigned int numEvents = (unsigned int)m_events.size();
+	WriteBytes(buffer, &numEvents, sizeof(numEvents));
+	for (const SessionEvent& sessionEvent : m_events)
+	{
+		unsigned char command = 0;
+		if (sessionEvent.m_type == SESSION_EVENT_TURN)
+			command = (unsigned char)sessionEvent.m_playerCommand;
+		else if (sessionEvent.m_type == SESSION_EVENT_INVENTORY)
+			command = (unsigned char)sessionEvent.m_inventoryCommand;
+
+		unsigned char header = (unsigned char)((sessionEvent.m_type << EVENT_TYPE_SHIFT) | (command & EVENT_COMMAND_MASK));
+		WriteBytes(buffer, &header, sizeof(header));
+
+		if (sessionEvent.m_type == SESSION_EVENT_INVENTORY)
+		{
+			unsigned short itemIndex = (unsigned short)sessionEvent.m_itemIndex;
+			WriteBytes(buffer, &itemIndex, sizeof(itemIndex));
+		}
+		else if (sessionEvent.m_type == SESSION_EVENT_CHECKPOINT)
+		{
+			WriteBytes(buffer, &sessionEvent.m_stateHash, sizeof(sessionEvent.m_stateHash));
+		}
+	}
+
+	return WriteBufferToFile(filePath, buffer);
+}
+
+bool SessionRecording::LoadFromFile(const std::string& filePath)
+{
+	std::vector<unsigned char> buffer;
+	if (!ReadFileIntoBuffer(filePath, buffer))
+		return false;
+
+	BinaryBufferReader reader(buffer);
+	unsigned int magic = 0;
+	unsigned int version = 0;
+	reader.ReadBytes(&magic, sizeof(magic));
+	reader.ReadBytes(&version, sizeof(version));
+	if (!reader.IsValid() || magic != FILE_MAGIC || version != FILE_VERSION)
+		return false;
+
+	reader.ReadBytes(&m_worldSeed, sizeof(m_worldSeed));
+	m_adventureName = reader.ReadString();
+	reader.ReadBytes(&m_checkpointInterval, sizeof(m_checkpointInterval));
+
+	unsigned int numEvents = 0;
+	reader.ReadBytes(&numEvents, sizeof(numEvents));
+	m_events.clear();
+	for (unsigned int eventIndex = 0; eventIndex < numEvents && reader.IsValid(); eventIndex++)
+	{
+		unsigned char header = 0;
+		reader.ReadBytes(&header, sizeof(header));
+
+		SessionEvent loadedEvent;
+		loadedEvent.m_type = (SessionEventType)(header >> EVENT_TYPE_SHIFT);
+		unsigned char command = header & EVENT_COMMAND_MASK;
+		switch (loadedEvent.m_type)
+		{
+		case SESSION_EVENT_TURN:
+			if (command >= NUM_PLAYER_COMMANDS)
+				return false;
+			loadedEvent.m_playerCommand = (PlayerCommand)command;
+			break;
+		case SESSION_EVENT_INVENTORY:
+		{
+			if (command >= NUM_INVENTORY_COMMANDS)
+				return false;
+			unsigned short itemIndex = 0;
+			reader.ReadBytes(&itemIndex, sizeof(itemIndex));
+			loadedEvent.m_inventoryCommand = (InventoryCommand)command;
+			loadedEvent.m_itemIndex = itemIndex;
+			break;
+		}
+		case SESSION_EVENT_CHECKPOINT:
+			reader.ReadBytes(&loadedEvent.m_stateHash, sizeof(loadedEvent.m_stateHash));
+			break;
+		default:
+			return false;
+		}
+
+		m_events.push_back(loadedEvent);
+	}
+
+	return reader.IsValid();
+}
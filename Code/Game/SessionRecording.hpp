@@ -0,0 +1,49 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Game/World.hpp"
+
+
+enum SessionEventType
+{
+	SESSION_EVENT_TURN,				//A PlayerCommand that took a turn
+	SESSION_EVENT_INVENTORY,		//An InventoryCommand on one item of the player's inventory, between turns
+	SESSION_EVENT_CHECKPOINT,		//World::CalculateStateHash after the turn just before it
+	NUM_SESSION_EVENT_TYPES
+};
+
+struct SessionEvent
+{
+	SessionEventType m_type = SESSION_EVENT_TURN;
+	PlayerCommand m_playerCommand = PLAYER_COMMAND_NONE;
+	InventoryCommand m_inventoryCommand = INVENTORY_COMMAND_TOGGLE_EQUIPPED;
+	int m_itemIndex = 0;
+	unsigned long long m_stateHash = 0;
+};
+
+//A played session as the world seed, the adventure and everything the player did, in order. Feeding the same events to a
+//world built from the same seed lands on the same state, so a session played in the game can be replayed headless to
+//profile it. A turn takes one byte; a checkpoint every m_checkpointInterval turns lets a replay spot where it drifted.
+class SessionRecording
+{
+public:
+	SessionRecording();
+
+	void AddTurn(PlayerCommand command);
+	void AddInventoryCommand(InventoryCommand command, int itemIndex);
+	void AddCheckpoint(unsigned long long stateHash);
+	bool IsCheckpointDue(int numTurnsExecuted) const;
+	int CountTurns() const;
+
+	bool SaveToFile(const std::string& filePath) const;
+	bool LoadFromFile(const std::string& filePath);
+
+	unsigned int m_worldSeed;
+	std::string m_adventureName;
+	int m_checkpointInterval;
+	std::vector<SessionEvent> m_events;
+
+	static const unsigned int FILE_MAGIC;
+	static const unsigned int FILE_VERSION;
+	static const int DEFAULT_CHECKPOINT_INTERVAL;
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include "Game/RandomStream.hpp"
 
 
 enum StatID
@@ -19,7 +20,7 @@ public:
 
 	int m_stats[NUM_STATS];
 
-	static Stats CalculateRandomStatsInRange(const Stats& minStats, const Stats& maxStats);
+	static Stats CalculateRandomStatsInRange(const Stats& minStats, const Stats& maxStats, RandomStream& random);
 
 	Stats& operator=(const Stats& statsToAssign);
 	Stats operator+(const Stats& statsToAdd);
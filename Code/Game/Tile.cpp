@@ -1,8 +1,8 @@
 #include "Game/Tile.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/EngineConfig.hpp"
-#include "Engine/Renderer/RHI/SimpleRenderer.hpp"
 #include "Engine/Math/MathUtils.hpp"
+#include "Engine/Core/StringUtils.hpp"
 #include "Game/GameCommon.hpp"
 #include "Game/Map.hpp"
 #include <string>
@@ -20,7 +20,7 @@ Tile::Tile()
 
 }
 
-Tile::Tile(std::string tileTypeName)
+Tile::Tile(std::string tileTypeName, RandomStream& random)
 	: m_tileCoords(0, 0)
 	, m_containingMap(nullptr)
 	, m_occupyingFeature(nullptr)
@@ -34,9 +34,9 @@ Tile::Tile(std::string tileTypeName)
 		ERROR_AND_DIE("INVALID TILE DEFINITION USED.");
 
 	m_tileDefinition = tileDefinition;
-	m_glyph = m_tileDefinition->m_glyphs[GetRandomIntLessThan(m_tileDefinition->m_glyphs.size())];
-	m_glyphColor = m_tileDefinition->m_glyphColors[GetRandomIntLessThan(m_tileDefinition->m_glyphColors.size())];
-	m_fillColor = m_tileDefinition->m_fillColors[GetRandomIntLessThan(m_tileDefinition->m_fillColors.size())];
+	m_glyph = m_tileDefinition->m_glyphs[random.GetRandomIntLessThan(m_tileDefinition->m_glyphs.size())];
+	m_glyphColor = m_tileDefinition->m_glyphColors[random.GetRandomIntLessThan(m_tileDefinition->m_glyphColors.size())];
+	m_fillColor = m_tileDefinition->m_fillColors[random.GetRandomIntLessThan(m_tileDefinition->m_fillColors.size())];
 }
 
 Tile::~Tile()
@@ -56,6 +56,7 @@ void Tile::Render() const
 	if (m_tileDefinition == nullptr)
 		ERROR_AND_DIE("TILE HAS NO TYPE.");
 
+#ifndef ROGUELIKE_HEADLESS
 	if (!m_hasBeenSeenByPlayer)
 	{
 		g_theRenderer->SetTexture(nullptr);
@@ -99,58 +100,100 @@ void Tile::Render() const
 		g_theRenderer->DrawQuad2D((float)m_tileCoords.x, (float)m_tileCoords.y, 1.f, 1.f, m_fillColor - Rgba(45, 45, 45, 0));
 		g_theRenderer->DrawTextInAABB2(glyphBounds, g_theRenderer->m_defaultFont, std::string(1, m_glyph), m_glyphColor - Rgba(45, 45, 45, 0), glyphScale);
 	}
+#endif
 }
 
-void Tile::ChangeType(std::string tileTypeName)
+void Tile::ChangeType(std::string tileTypeName, RandomStream& random)
 {
 	TileDefinition* tileDefinition = TileDefinition::GetTileDefinition(tileTypeName);
 	if (tileDefinition == nullptr)
 		ERROR_AND_DIE("INVALID TILE DEFINITION USED.");
 
-	m_tileDefinition = tileDefinition;
-	m_glyph = m_tileDefinition->m_glyphs[GetRandomIntLessThan(m_tileDefinition->m_glyphs.size())];
-	m_glyphColor = m_tileDefinition->m_glyphColors[GetRandomIntLessThan(m_tileDefinition->m_glyphColors.size())];
-	m_fillColor = m_tileDefinition->m_fillColors[GetRandomIntLessThan(m_tileDefinition->m_fillColors.size())];
+	ChangeType(tileDefinition, random);
+}
+
+void Tile::ChangeType(TileDefinition* newTileDefinition, RandomStream& random)
+{
+	TileDefinition* oldTileDefinition = m_tileDefinition;
+	m_tileDefinition = newTileDefinition;
+	m_glyph = m_tileDefinition->m_glyphs[random.GetRandomIntLessThan(m_tileDefinition->m_glyphs.size())];
+	m_glyphColor = m_tileDefinition->m_glyphColors[random.GetRandomIntLessThan(m_tileDefinition->m_glyphColors.size())];
+	m_fillColor = m_tileDefinition->m_fillColors[random.GetRandomIntLessThan(m_tileDefinition->m_fillColors.size())];
+
+	if (m_containingMap)
+		m_containingMap->OnTileTypeChanged(*this, oldTileDefinition);
+}
+
+void Tile::MakeMapBorder()
+{
+	m_tileDefinition = TileDefinition::GetMapBorderDefinition();
+	m_glyph = m_tileDefinition->m_glyphs[0];
+	m_glyphColor = m_tileDefinition->m_glyphColors[0];
+	m_fillColor = m_tileDefinition->m_fillColors[0];
+	m_permanence = 1.f;
+}
+
+bool Tile::IsMapBorder() const
+{
+	return m_tileDefinition->IsMapBorder();
+}
+
+void Tile::SetTags(const std::string& tagsToSet)
+{
+	if (tagsToSet.empty())
+		return;
+
+	std::vector<std::string> oldTags = Split(m_tags.GetTagsAsString(), ',');
+	m_tags.SetTags(tagsToSet);
+
+	if (m_containingMap)
+		m_containingMap->OnTileTagsChanged(*this, oldTags, Split(m_tags.GetTagsAsString(), ','));
+}
+
+//Tiles live in the map's padded array, so every neighbor is a fixed offset away. Border tiles are never asked for their neighbors.
+Tile* Tile::GetNeighbor(TileNeighbor neighbor) const
+{
+	return const_cast<Tile*>(this) + m_containingMap->m_neighborOffsets[neighbor];
 }
 
 Tile* Tile::GetNorthNeighbor() const
 {
-	return m_containingMap->GetTileAtTileCoords(m_tileCoords + IntVector2(0, 1));
+	return GetNeighbor(NEIGHBOR_NORTH);
 }
 
 Tile* Tile::GetSouthNeighbor() const
 {
-	return m_containingMap->GetTileAtTileCoords(m_tileCoords + IntVector2(0, -1));
+	return GetNeighbor(NEIGHBOR_SOUTH);
 }
 
 Tile* Tile::GetEastNeighbor() const
 {
-	return m_containingMap->GetTileAtTileCoords(m_tileCoords + IntVector2(1, 0));
+	return GetNeighbor(NEIGHBOR_EAST);
 }
 
 Tile* Tile::GetWestNeighbor() const
 {
-	return m_containingMap->GetTileAtTileCoords(m_tileCoords + IntVector2(-1, 0));
+	return GetNeighbor(NEIGHBOR_WEST);
 }
 
 Tile* Tile::GetNorthEastNeighbor() const
 {
-	return m_containingMap->GetTileAtTileCoords(m_tileCoords + IntVector2(1, 1));
+	return GetNeighbor(NEIGHBOR_NORTH_EAST);
 }
 
 Tile* Tile::GetNorthWestNeighbor() const
 {
-	return m_containingMap->GetTileAtTileCoords(m_tileCoords + IntVector2(-1, 1));
+	return GetNeighbor(NEIGHBOR_NORTH_WEST);
 }
 
 Tile* Tile::GetSouthEastNeighbor() const
 {
-	return m_containingMap->GetTileAtTileCoords(m_tileCoords + IntVector2(1, -1));
+	return GetNeighbor(NEIGHBOR_SOUTH_EAST);
 }
 
 Tile* Tile::GetSouthWestNeighbor() const
 {
-	return m_containingMap->GetTileAtTileCoords(m_tileCoords + IntVector2(-1, -1));
+	return GetNeighbor(NEIGHBOR_SOUTH_WEST);
 }
 
 bool Tile::IsSolidToTags(const Tags& tagsToCheck) const
@@ -5,25 +5,43 @@
 #include "Game/Character.hpp"
 #include "Game/Feature.hpp"
 #include "Game/Message.hpp"
+#include "Game/RandomStream.hpp"
 #include <string>
 
 
+enum TileNeighbor
+{
+	NEIGHBOR_NORTH,
+	NEIGHBOR_SOUTH,
+	NEIGHBOR_EAST,
+	NEIGHBOR_WEST,
+	NEIGHBOR_NORTH_EAST,
+	NEIGHBOR_NORTH_WEST,
+	NEIGHBOR_SOUTH_EAST,
+	NEIGHBOR_SOUTH_WEST,
+	NUM_TILE_NEIGHBORS
+};
 
 
 class Tile
 {
 public:
 	Tile();
-	Tile(std::string tileTypeName);
+	Tile(std::string tileTypeName, RandomStream& random);
 	~Tile();
 
 	void Update(float deltaSeconds);
 	void Render() const;
 
-	void ChangeType(std::string tileTypeName);
+	void ChangeType(std::string tileTypeName, RandomStream& random);
+	void ChangeType(TileDefinition* newTileDefinition, RandomStream& random);
+	void MakeMapBorder();
+	bool IsMapBorder() const;
+	void SetTags(const std::string& tagsToSet);
 
 	std::vector<Message> GetTooltipInfo() const;
 
+	Tile* GetNeighbor(TileNeighbor neighbor) const;
 	Tile* GetNorthNeighbor() const;
 	Tile* GetSouthNeighbor() const;
 	Tile* GetEastNeighbor() const;
@@ -52,8 +70,6 @@ public:
 	bool m_isVisibleToPlayer = false;
 	bool m_hasBeenSeenByPlayer = false;
 
-	int m_isClosedInPathID = 0;
-	int m_isOpenInPathID = 0;
 	float m_permanence;
 };
 
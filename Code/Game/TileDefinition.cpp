@@ -3,6 +3,8 @@
 #include "Engine/Core/ErrorWarningAssert.hpp"
 
 std::map<std::string, TileDefinition*> TileDefinition::s_tileDefinitionRegistry;
+std::vector<TileDefinition*> TileDefinition::s_tileDefinitionsByID;
+TileDefinition* TileDefinition::s_mapBorderDefinition = nullptr;
 
 TileDefinition* TileDefinition::GetTileDefinition(std::string name)
 {
@@ -13,6 +15,37 @@ TileDefinition* TileDefinition::GetTileDefinition(std::string name)
 		return nullptr;
 }
 
+TileDefinition* TileDefinition::GetTileDefinition(TileTypeID typeID)
+{
+	if (typeID >= s_tileDefinitionsByID.size())
+		return nullptr;
+	else
+		return s_tileDefinitionsByID[typeID];
+}
+
+//Called once the XML tile definitions are loaded, so the sentinel takes the ID after theirs
+void TileDefinition::CreateMapBorderDefinition()
+{
+	ASSERT_OR_DIE(s_mapBorderDefinition == nullptr, "Map border tile definition created twice.");
+	s_mapBorderDefinition = new TileDefinition();
+}
+
+//Sentinel used for the one tile border around every map. It gets a type ID like any other definition, so per-type tables
+//have a slot for it, but it is left out of the name registry, so no generator or data file can place it.
+TileDefinition::TileDefinition()
+	: m_name("map border")
+	, m_isSolid(true)
+	, m_isOpaque(true)
+	, m_solidExceptions()
+{
+	m_glyphs.push_back(' ');
+	m_glyphColors.push_back(Rgba::BLACK);
+	m_fillColors.push_back(Rgba::BLACK);
+
+	m_typeID = (TileTypeID)s_tileDefinitionsByID.size();
+	s_tileDefinitionsByID.push_back(this);
+}
+
 TileDefinition::TileDefinition(XMLNode element)
 {
 	m_name = ParseXMLAttributeString(element, "name", "ERROR_INVALID_NAME");
@@ -53,6 +86,9 @@ TileDefinition::TileDefinition(XMLNode element)
 	ASSERT_OR_DIE(element.nChildNode("SolidExceptions") <= 1, "Too many solid exception elements in tile definition.");
 
 	s_tileDefinitionRegistry[m_name] = this;
+
+	m_typeID = (TileTypeID)s_tileDefinitionsByID.size();
+	s_tileDefinitionsByID.push_back(this);
 }
 
 TileDefinition::~TileDefinition()
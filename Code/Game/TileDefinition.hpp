@@ -2,17 +2,22 @@
 #include <string>
 #include <vector>
 #include <map>
-#include "Engine\Core\Rgba.hpp"
+#include "Engine/Core/Rgba.hpp"
 
 struct XMLNode;
 
+typedef unsigned short TileTypeID;
+
 class TileDefinition
 {
 public:
 	TileDefinition(XMLNode element);
 	~TileDefinition();
 
+	bool IsMapBorder() const { return this == s_mapBorderDefinition; }
+
 	std::string m_name;
+	TileTypeID m_typeID;
 	bool m_isSolid;
 	bool m_isOpaque;
 	std::string m_solidExceptions;
@@ -21,5 +26,14 @@ public:
 	std::vector<Rgba> m_fillColors;
 
 	static std::map<std::string, TileDefinition*> s_tileDefinitionRegistry;
+	static std::vector<TileDefinition*> s_tileDefinitionsByID;
 	static TileDefinition* GetTileDefinition(std::string name);
+	static TileDefinition* GetTileDefinition(TileTypeID typeID);
+	static TileDefinition* GetMapBorderDefinition() { return s_mapBorderDefinition; }
+	static void CreateMapBorderDefinition();
+
+private:
+	TileDefinition();
+
+	static TileDefinition* s_mapBorderDefinition;
 };
\ No newline at end of file
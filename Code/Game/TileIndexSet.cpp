@@ -0,0 +1,77 @@
+#include "Game/TileIndexSet.hpp"
+#include "Engine/Math/MathUtils.hpp"
+
+
+TileIndexSet::TileIndexSet()
+	: m_tileIndices()
+	, m_positionsByTileIndex()
+{
+
+}
+
+TileIndexSet::~TileIndexSet()
+{
+
+}
+
+void TileIndexSet::Reset()
+{
+	m_tileIndices.clear();
+	m_positionsByTileIndex.clear();
+}
+
+void TileIndexSet::Add(int tileIndex)
+{
+	if (!m_positionsByTileIndex.insert(std::make_pair(tileIndex, (int)m_tileIndices.size())).second)
+		return;
+
+	m_tileIndices.push_back(tileIndex);
+}
+
+void TileIndexSet::Remove(int tileIndex)
+{
+	std::unordered_map<int, int>::iterator found = m_positionsByTileIndex.find(tileIndex);
+	if (found == m_positionsByTileIndex.end())
+		return;
+
+	int position = found->second;
+	m_positionsByTileIndex.erase(found);
+
+	int lastTileIndex = m_tileIndices.back();
+	m_tileIndices.pop_back();
+	if (lastTileIndex != tileIndex)
+	{
+		m_tileIndices[position] = lastTileIndex;
+		m_positionsByTileIndex[lastTileIndex] = position;
+	}
+}
+
+bool TileIndexSet::Contains(int tileIndex) const
+{
+	return m_positionsByTileIndex.find(tileIndex) != m_positionsByTileIndex.end();
+}
+
+bool TileIndexSet::IsEmpty() const
+{
+	return m_tileIndices.empty();
+}
+
+int TileIndexSet::GetSize() const
+{
+	return (int)m_tileIndices.size();
+}
+
+int TileIndexSet::GetTileIndexAt(int position) const
+{
+	return m_tileIndices[position];
+}
+
+int TileIndexSet::GetRandomTileIndex(RandomStream& random) const
+{
+	return m_tileIndices[random.GetRandomIntLessThan(m_tileIndices.size())];
+}
+
+const std::vector<int>& TileIndexSet::GetTileIndices() const
+{
+	return m_tileIndices;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include "Game/RandomStream.hpp"
+
+
+//Set of tile indices with O(1) add, remove, contains and uniform random selection.
+//Positions are only stored for members, so a set costs memory in proportion to its size rather than the map's.
+class TileIndexSet
+{
+public:
+	TileIndexSet();
+	~TileIndexSet();
+
+	void Reset();
+	void Add(int tileIndex);
+	void Remove(int tileIndex);
+	bool Contains(int tileIndex) const;
+
+	bool IsEmpty() const;
+	int GetSize() const;
+	int GetTileIndexAt(int position) const;
+	int GetRandomTileIndex(RandomStream& random) const;
+
+	const std::vector<int>& GetTileIndices() const;
+
+private:
+	std::vector<int> m_tileIndices;
+	std::unordered_map<int, int> m_positionsByTileIndex;
+};
@@ -0,0 +1,69 @@
+#include "Game/TurnScheduler.hpp"
+#include <algorithm>
+#include <functional>
+
+
+bool ScheduledTurn::operator>(const ScheduledTurn& other) const
+{
+	if (m_tick != other.m_tick)
+		return m_tick > other.m_tick;
+
+	return m_order > other.m_order;
+}
+
+TurnScheduler::TurnScheduler()
+	: m_heap()
+	, m_nextOrder(0)
+{
+
+}
+
+TurnScheduler::~TurnScheduler()
+{
+
+}
+
+void TurnScheduler::Clear()
+{
+	m_heap.clear();
+	m_nextOrder = 0;
+}
+
+void TurnScheduler::Schedule(const EntityHandle& character, int tick)
+{
+	ScheduledTurn turn;
+	turn.m_tick = tick;
+	turn.m_order = m_nextOrder++;
+	turn.m_character = character;
+
+	m_heap.push_back(turn);
+	std::push_heap(m_heap.begin(), m_heap.end(), std::greater<ScheduledTurn>());
+}
+
+bool TurnScheduler::PopDue(int currentTick, ScheduledTurn& out_turn)
+{
+	if (m_heap.empty() || m_heap.front().m_tick > currentTick)
+		return false;
+
+	std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<ScheduledTurn>());
+	out_turn = m_heap.back();
+	m_heap.pop_back();
+	return true;
+}
+
+bool TurnScheduler::PopAllDueOnNextTick(int currentTick, std::vector<ScheduledTurn>& out_turns)
+{
+	out_turns.clear();
+	if (m_heap.empty() || m_heap.front().m_tick > currentTick)
+		return false;
+
+	int nextTick = m_heap.front().m_tick;
+	ScheduledTurn dueTurn;
+	while (!m_heap.empty() && m_heap.front().m_tick == nextTick)
+	{
+		PopDue(currentTick, dueTurn);
+		out_turns.push_back(dueTurn);
+	}
+
+	return true;
+}
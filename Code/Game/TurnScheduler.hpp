@@ -0,0 +1,35 @@
+#pragma once
+#include <vector>
+#include "Game/EntityHandle.hpp"
+
+
+struct ScheduledTurn
+{
+	int m_tick;
+	unsigned int m_order;
+	EntityHandle m_character;
+
+	bool operator>(const ScheduledTurn& other) const;
+};
+
+//Min-heap of characters keyed by the tick of their next action. Only characters that are due are ever touched, so a map
+//full of idle entities costs nothing per turn. Handles are not removed when a character dies or leaves; the map simply
+//skips entries whose handle no longer resolves. Characters due on the same tick act in the order they were scheduled.
+class TurnScheduler
+{
+public:
+	TurnScheduler();
+	~TurnScheduler();
+
+	void Clear();
+	void Schedule(const EntityHandle& character, int tick);
+	bool PopDue(int currentTick, ScheduledTurn& out_turn);
+	bool PopAllDueOnNextTick(int currentTick, std::vector<ScheduledTurn>& out_turns);
+
+	bool IsEmpty() const { return m_heap.empty(); }
+	int GetSize() const { return (int)m_heap.size(); }
+
+private:
+	std::vector<ScheduledTurn> m_heap;
+	unsigned int m_nextOrder;
+};
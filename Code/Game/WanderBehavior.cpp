@@ -17,9 +17,9 @@ WanderBehavior::~WanderBehavior()
 
 }
 
-void WanderBehavior::Act(Character* actingCharacter)
+void WanderBehavior::Plan(Character* actingCharacter, PlannedAction& out_action)
 {
-	if (actingCharacter->m_target == nullptr)
+	if (actingCharacter->GetTarget() == nullptr)
 	{
 		std::vector<Character*> potentialTargets = actingCharacter->m_currentMap->FindAllCharactersNotOfFaction(actingCharacter->m_faction);
 		for (Character* character : potentialTargets)
@@ -28,7 +28,7 @@ void WanderBehavior::Act(Character* actingCharacter)
 			RaycastResult result = actingCharacter->m_currentMap->RaycastForOpaque(Vector2(actingCharacter->m_currentTile->m_tileCoords) + Vector2(0.5f, 0.5f), displacementToPotentialTarget.GetNormalized(), displacementToPotentialTarget.CalcLength());
 			if (!result.m_didImpact)
 			{
-				actingCharacter->m_target = character;
+				actingCharacter->SetTarget(character);
 				return;
 			}
 		}
@@ -37,19 +37,28 @@ void WanderBehavior::Act(Character* actingCharacter)
 	if (!m_wanderTarget || actingCharacter->m_currentTile == m_wanderTarget)
 	{
 		//generate new target
-		m_wanderTarget = actingCharacter->m_currentMap->GetRandomTraversableTile();
-		m_wanderPath = actingCharacter->m_currentMap->GeneratePath(actingCharacter->m_currentTile->m_tileCoords, m_wanderTarget->m_tileCoords, actingCharacter);
+		m_wanderTarget = actingCharacter->m_currentMap->GetRandomTraversableTile(actingCharacter->m_tags, actingCharacter->m_random);
+		if (m_wanderTarget)
+			m_wanderPath = actingCharacter->m_currentMap->GeneratePath(actingCharacter->m_currentTile->m_tileCoords, m_wanderTarget->m_tileCoords, actingCharacter);
+		else
+			m_wanderPath.clear();
 	}
 
 	if(!m_wanderPath.empty())
-	{
-		Tile* nextTile = *(m_wanderPath.end() - 1);
-		bool successfullyMoved = actingCharacter->m_currentMap->TryToMoveCharacterToTile(actingCharacter, nextTile);
-		if (successfullyMoved)
-			m_wanderPath.pop_back();
-	}
+		PlanMoveToTile(*(m_wanderPath.end() - 1), out_action);
+}
+
+void WanderBehavior::OnActionResolved(Character* actingCharacter, const PlannedAction& action, bool wasSuccessful)
+{
+	UNUSED(actingCharacter);
+	if (wasSuccessful && action.m_type == PLANNED_ACTION_MOVE && !m_wanderPath.empty())
+		m_wanderPath.pop_back();
+}
 
-	actingCharacter->m_turnsUntilAction = 1;
+void WanderBehavior::InvalidatePath()
+{
+	m_wanderTarget = nullptr;
+	m_wanderPath.clear();
 }
 
 float WanderBehavior::CalcUtility(Character* actingCharacter) const
@@ -66,6 +75,7 @@ std::string WanderBehavior::GetName() const
 void WanderBehavior::DebugRender(const Character* actingCharacter) const
 {
 	UNUSED(actingCharacter);
+#ifndef ROGUELIKE_HEADLESS
 	for (size_t tileIndex = 1; tileIndex < m_wanderPath.size(); tileIndex++)
 	{
 		Tile* tile = m_wanderPath[tileIndex];
@@ -73,6 +83,7 @@ void WanderBehavior::DebugRender(const Character* actingCharacter) const
 	}
 	if(m_wanderTarget)
 		g_theRenderer->DrawCenteredText2D((Vector2)m_wanderTarget->m_tileCoords + Vector2(0.5f, 0.5f), g_theRenderer->m_defaultFont, "T", Rgba::RED, 0.5f);
+#endif
 }
 
 Behavior* WanderBehavior::Clone()
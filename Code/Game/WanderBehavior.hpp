@@ -14,8 +14,10 @@ public:
 	Path m_wanderPath;
 	float m_baseUtility = 0.3f;
 
-	virtual void Act(Character* actingCharacter) override;
+	virtual void Plan(Character* actingCharacter, PlannedAction& out_action) override;
+	virtual void OnActionResolved(Character* actingCharacter, const PlannedAction& action, bool wasSuccessful) override;
 	virtual float CalcUtility(Character* actingCharacter) const override;
+	virtual void InvalidatePath() override;
 	virtual std::string GetName() const override;
 	virtual void DebugRender(const Character* actingCharacter) const override;
 
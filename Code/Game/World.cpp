@@ -6,27 +6,55 @@
 #include "Game/CharacterBuilder.hpp"
 #include "LootTable.hpp"
 #include "Game/GameCommon.hpp"
+#ifndef ROGUELIKE_HEADLESS
 #include "Game/App.hpp"
+#endif
 #include "Engine/Core/XMLUtils.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Game/MapDefinition.hpp"
 #include "Adventure.hpp"
+#include "Game/MapCache.hpp"
+#include "Game/SessionRecording.hpp"
+#include "Game/BinaryBuffer.hpp"
+#include <algorithm>
 
 
-World::World()
-	: m_maps()
+World::World(unsigned int worldSeed)
+	: m_worldSeed(worldSeed)
+	, m_maps()
 	, m_currentMap(nullptr)
 	, m_thePlayer(nullptr)
 	, m_cursorPosition(Vector2(ORTHO_X_DIMENSION * 0.5f, ORTHO_Y_DIMENSION * 0.5f))
 	, m_currentlyGeneratingMapDefinition(nullptr)
 	, m_currentlyGeneratingMap(nullptr)
+	, m_adventureMapSlots()
 {
 
 }
 
 World::~World()
 {
+	delete m_sessionRecording;
+	m_sessionRecording = nullptr;
 
+	for (BackgroundMap* backgroundMap : m_backgroundMaps)
+	{
+		if (g_theJobSystem)
+			g_theJobSystem->WaitForCounter(backgroundMap->m_simulationCounter);
+
+		delete backgroundMap;
+	}
+
+	for (std::map<std::string, AdventureMapSlot*>::iterator slotIter = m_adventureMapSlots.begin(); slotIter != m_adventureMapSlots.end(); slotIter++)
+	{
+		AdventureMapSlot* slot = slotIter->second;
+		if (g_theJobSystem)
+			g_theJobSystem->WaitForCounter(slot->m_generationCounter);
+
+		if (!slot->m_isPopulated)
+			delete slot->m_map;
+		delete slot;
+	}
 }
 
 void World::Initialize()
@@ -37,8 +65,8 @@ void World::Initialize()
 Map* World::GenerateMap(std::string mapDefinitionName)
 {
 	StartSteppedGeneration(mapDefinitionName);
-	
-	FinishGeneratingMap();
+
+	MapCache::GenerateMap(m_currentlyGeneratingMap);
 
 	return m_currentlyGeneratingMap;
 }
@@ -49,7 +77,8 @@ void World::StartSteppedGeneration(std::string mapDefinitionName)
 	m_currentlyGeneratingMap = nullptr;
 
 	m_currentlyGeneratingMapDefinition = MapDefinition::GetDefinition(mapDefinitionName);
-	Map* newMap = new Map(mapDefinitionName);
+	Map* newMap = new Map(mapDefinitionName, RandomStream::DeriveSeed(m_worldSeed, RandomStream::HashString(mapDefinitionName)));
+	newMap->m_world = this;
 	m_currentlyGeneratingMap = newMap;
 }
 
@@ -62,6 +91,7 @@ bool World::StepGeneration()
 
 void World::Update(float deltaSeconds)
 {
+#ifndef ROGUELIKE_HEADLESS
 	if (g_theApp->HasFocus())
 	{
 		IntVector2 mouseScreenPos = g_theInput->GetCursorScreenPos();
@@ -80,70 +110,144 @@ void World::Update(float deltaSeconds)
 			m_cursorPosition.y = 0.f;
 	}
 
-	bool didPlayerAct = false;
-	if(m_thePlayer && g_theApp->m_game->m_currentState == STATE_PLAYING)
+	if (g_theApp->m_game->m_currentState == STATE_PLAYING)
+		ExecutePlayerCommand(GetPlayerCommandFromInput());
+#endif
+
+	if(m_thePlayer)
+		UpdateFogOfWar();
+
+	m_currentMap->Update(deltaSeconds);
+}
+
+#ifndef ROGUELIKE_HEADLESS
+PlayerCommand World::GetPlayerCommandFromInput() const
+{
+	if (g_theInput->WasKeyJustPressed(KEYCODE_UP))
+		return PLAYER_COMMAND_MOVE_NORTH;
+	if (g_theInput->WasKeyJustPressed(KEYCODE_DOWN))
+		return PLAYER_COMMAND_MOVE_SOUTH;
+	if (g_theInput->WasKeyJustPressed(KEYCODE_LEFT))
+		return PLAYER_COMMAND_MOVE_WEST;
+	if (g_theInput->WasKeyJustPressed(KEYCODE_RIGHT))
+		return PLAYER_COMMAND_MOVE_EAST;
+	if (g_theInput->WasKeyJustPressed(KEYCODE_SPACE))
+		return PLAYER_COMMAND_REST;
+
+	return PLAYER_COMMAND_NONE;
+}
+#endif
+
+//Everything one player turn does, whether the command came from the keyboard or from a headless policy
+bool World::ExecutePlayerCommand(PlayerCommand command)
+{
+	if (!m_thePlayer || command == PLAYER_COMMAND_NONE)
+		return false;
+
+	switch (command)
+	{
+	case PLAYER_COMMAND_MOVE_NORTH:
+		m_thePlayer->MoveNorth();
+		break;
+	case PLAYER_COMMAND_MOVE_SOUTH:
+		m_thePlayer->MoveSouth();
+		break;
+	case PLAYER_COMMAND_MOVE_EAST:
+		m_thePlayer->MoveEast();
+		break;
+	case PLAYER_COMMAND_MOVE_WEST:
+		m_thePlayer->MoveWest();
+		break;
+	case PLAYER_COMMAND_REST:
+		m_thePlayer->Rest();
+		break;
+	default:
+		break;
+	}
+
+	//The rest of the map catches up to the moment the player's next action comes around
+	int elapsedTicks = m_thePlayer->CalculateActionTicks();
+	m_currentMap->AdvanceTurns(elapsedTicks);
+	UpdateBackgroundMaps(elapsedTicks);
+
+	m_numTurnsExecuted++;
+	if (m_sessionRecording)
 	{
-		if (g_theInput->WasKeyJustPressed(KEYCODE_UP))
-		{
-			m_thePlayer->MoveNorth();
-			m_currentMap->AdvanceTurns();
-			m_thePlayer->m_turnsUntilAction = 1;
-			didPlayerAct = true;
-		}
-		else if (g_theInput->WasKeyJustPressed(KEYCODE_DOWN))
-		{
-			m_thePlayer->MoveSouth();
-			m_currentMap->AdvanceTurns();
-			m_thePlayer->m_turnsUntilAction = 1;
-			didPlayerAct = true;
-		}
-		else if (g_theInput->WasKeyJustPressed(KEYCODE_LEFT))
-		{
-			m_thePlayer->MoveWest();
-			m_currentMap->AdvanceTurns();
-			m_thePlayer->m_turnsUntilAction = 1;
-			didPlayerAct = true;
-		}
-		else if (g_theInput->WasKeyJustPressed(KEYCODE_RIGHT))
+		m_sessionRecording->AddTurn(command);
+		if (m_sessionRecording->IsCheckpointDue(m_numTurnsExecuted))
+			m_sessionRecording->AddCheckpoint(CalculateStateHash());
+	}
+
+	if(m_currentAdventure)
+	{
+		if (!m_hasPlayerLost && m_thePlayer == nullptr)
 		{
-			m_thePlayer->MoveEast();
-			m_currentMap->AdvanceTurns();
-			m_thePlayer->m_turnsUntilAction = 1;
-			didPlayerAct = true;
+			m_hasPlayerLost = true;
+			m_currentMap->m_damageNumbers.push_back(DamageNumber(m_currentAdventure->m_defeatText, Vector2(ORTHO_X_DIMENSION * 0.5f, ORTHO_Y_DIMENSION * 0.5f), Rgba::WHITE, 4.f));
+			return true;
 		}
-		else if (g_theInput->WasKeyJustPressed(KEYCODE_SPACE))
+
+		if (m_thePlayer && !m_hasPlayerWon)
 		{
-			m_thePlayer->Rest();
-			m_currentMap->AdvanceTurns();
-			m_thePlayer->m_turnsUntilAction = 1;
-			didPlayerAct = true;
+			CheckForVictory();
+			if (m_hasPlayerWon)
+				m_currentMap->m_damageNumbers.push_back(DamageNumber(m_currentAdventure->m_victoryText, Vector2(ORTHO_X_DIMENSION * 0.5f, ORTHO_Y_DIMENSION * 0.5f), Rgba::WHITE, 4.f));
 		}
 	}
+	UpdateVisibilities();
 
-	if(m_thePlayer)
-		UpdateFogOfWar();
+	return true;
+}
 
-	m_currentMap->Update(deltaSeconds);
-	if (didPlayerAct)
+bool World::ExecuteInventoryCommand(InventoryCommand command, int itemIndex)
+{
+	if (!m_thePlayer || itemIndex < 0 || itemIndex >= (int)m_thePlayer->m_entityInventory.m_items.size())
+		return false;
+
+	Item* item = m_thePlayer->m_entityInventory.m_items[itemIndex];
+	Equipment& equipment = m_thePlayer->m_equipment;
+	switch (command)
 	{
-		if(m_currentAdventure)
+	case INVENTORY_COMMAND_TOGGLE_EQUIPPED:
+		if (equipment.IsItemEquipped(item))
+			equipment.m_equippedItems[item->m_definition->m_slot] = nullptr;
+		else
+			equipment.m_equippedItems[item->m_definition->m_slot] = item;
+		break;
+	case INVENTORY_COMMAND_DROP:
+		if (equipment.IsItemEquipped(item))
+			equipment.m_equippedItems[item->m_definition->m_slot] = nullptr;
+		m_thePlayer->m_entityInventory.TransferSingleItemToOtherInventory(itemIndex, m_thePlayer->m_currentTile->m_tileInventory);
+		break;
+	default:
+		return false;
+	}
+
+	if (m_sessionRecording)
+		m_sessionRecording->AddInventoryCommand(command, itemIndex);
+
+	return true;
+}
+
+//Only the current map goes in: maps in the background may be mid-update on a worker, and they are settled again when entered
+unsigned long long World::CalculateStateHash() const
+{
+	unsigned long long stateHash = HASH_BYTES_START;
+	stateHash = HashBytes(stateHash, m_currentMap->m_name.data(), m_currentMap->m_name.size());
+	stateHash = HashBytes(stateHash, &m_numTurnsExecuted, sizeof(m_numTurnsExecuted));
+	stateHash = m_currentMap->CalculateStateHash(stateHash);
+
+	if (m_thePlayer)
+	{
+		for (const Item* equippedItem : m_thePlayer->m_equipment.m_equippedItems)
 		{
-			if (!m_hasPlayerLost && m_thePlayer == nullptr)
-			{
-				m_hasPlayerLost = true;
-				m_currentMap->m_damageNumbers.push_back(DamageNumber(m_currentAdventure->m_defeatText, Vector2(ORTHO_X_DIMENSION * 0.5f, ORTHO_Y_DIMENSION * 0.5f), Rgba::WHITE, 4.f));
-				return;
-			}
-
-			if (m_thePlayer && !m_hasPlayerWon)
-			{
-				CheckForVictory();
-				if (m_hasPlayerWon)
-					m_currentMap->m_damageNumbers.push_back(DamageNumber(m_currentAdventure->m_victoryText, Vector2(ORTHO_X_DIMENSION * 0.5f, ORTHO_Y_DIMENSION * 0.5f), Rgba::WHITE, 4.f));
-			}
+			const std::vector<Item*>& items = m_thePlayer->m_entityInventory.m_items;
+			int equippedIndex = (int)(std::find(items.begin(), items.end(), equippedItem) - items.begin());
+			stateHash = HashBytes(stateHash, &equippedIndex, sizeof(equippedIndex));
 		}
-		UpdateVisibilities();
 	}
+
+	return stateHash;
 }
 
 void World::Render() const
@@ -153,12 +257,15 @@ void World::Render() const
 
 void World::DrawCursor() const
 {
+#ifndef ROGUELIKE_HEADLESS
 	g_theRenderer->SetTexture(nullptr);
 	g_theRenderer->DrawBorderedDisc2D(m_cursorPosition, 0.1f, 0.025f, 64, Rgba(255, 255, 255, 0));
+#endif
 }
 
 void World::DrawTooltip() const
 {
+#ifndef ROGUELIKE_HEADLESS
 	std::vector<Message> tooltipInfo = m_currentMap->GetTooltipInfoForMapCoords(m_cursorPosition);
 	if (tooltipInfo.empty())
 		return;
@@ -215,10 +322,12 @@ void World::DrawTooltip() const
 		linePosition.y -= g_theRenderer->m_defaultFont->CalculateTextHeight(tooltipInfo[tooltipInfoIndex].m_text, tooltipInfo[tooltipInfoIndex].m_size);
 		linePosition.y -= lineSpacer;
 	}
+#endif
 }
 
 void World::DrawUI() const
 {
+#ifndef ROGUELIKE_HEADLESS
 	g_theRenderer->SetTexture(nullptr);
 
 	float orthoWidth = ORTHO_X_DIMENSION;
@@ -233,99 +342,68 @@ void World::DrawUI() const
 	if(m_thePlayer)
 		g_theRenderer->DrawText2D(Vector2(0.5f, ORTHO_Y_DIMENSION - 1.f), g_theRenderer->m_defaultFont, "HP: " + std::to_string(m_thePlayer->m_currentHP) + "/" + std::to_string(m_thePlayer->m_stats[STAT_MAX_HP]), Rgba::WHITE, 0.75f);
 	DrawTooltip();
+#endif
 }
 
 void World::GenerateAdventure(std::string adventureName)
+{
+	StartGeneratingAdventure(adventureName);
+	FinishGeneratingAdventure();
+}
+
+//Only the starting map is generated up front. Every other map is generated the first time an exit to it is used,
+//or earlier in the background once the map it is reachable from has been entered.
+void World::StartGeneratingAdventure(std::string adventureName)
 {
 	m_currentAdventure = Adventure::GetDefinition(adventureName);
+	ASSERT_OR_DIE(m_currentAdventure, "Unknown adventure name.");
 
-	//Generate maps
 	for (std::map<std::string, AdventureMap>::iterator mapIter = m_currentAdventure->m_maps.begin(); mapIter != m_currentAdventure->m_maps.end(); mapIter++)
 	{
-		Map* tempMap = GenerateMap(mapIter->second.m_definition->m_name);
-		tempMap->m_name = mapIter->second.m_name;
-
-		std::vector<AdventureItem> itemsToSpawn = mapIter->second.m_itemsToSpawn;
-		for (AdventureItem item : itemsToSpawn)
-		{
-			Item* newItem = new Item(item.m_definition);
-			tempMap->PlaceItemInMap(newItem, tempMap->GetRandomTileOfType(item.m_tileTypeToSpawnOn));
-		}
+		AdventureMapSlot* newSlot = new AdventureMapSlot();
+		newSlot->m_adventureMap = &mapIter->second;
+		newSlot->m_seed = RandomStream::DeriveSeed(m_worldSeed, RandomStream::HashString(mapIter->first));
+		m_adventureMapSlots[mapIter->first] = newSlot;
+	}
 
-		std::vector<AdventureCharacter> charactersToSpawn = mapIter->second.m_charactersToSpawn;
-		for (AdventureCharacter character : charactersToSpawn)
-		{
-			Character* newCharacter = CharacterBuilder::BuildNewCharacter(character.m_builderName);
-			tempMap->PlaceCharacterInMap(newCharacter, tempMap->GetRandomTileOfType(character.m_tileTypeToSpawnOn));
-		}
+	AdventureMapSlot* startingSlot = GetAdventureMapSlot(m_currentAdventure->m_startingConditions.m_startingMap);
+	ASSERT_OR_DIE(startingSlot, "No map in adventure matches starting map name.");
+	QueueAdventureMapGeneration(startingSlot);
+}
 
-		m_maps.push_back(tempMap);
-	}
+bool World::IsStartingMapGenerated() const
+{
+	AdventureMapSlot* startingSlot = GetAdventureMapSlot(m_currentAdventure->m_startingConditions.m_startingMap);
+	return startingSlot->m_generationCounter.m_numJobsRemaining == 0;
+}
 
-	//Place exits
-	for (size_t mapIndex = 0; mapIndex < m_maps.size(); mapIndex++)
+int World::GetNumAdventureMapsGenerated() const
+{
+	int numMapsGenerated = 0;
+	for (std::map<std::string, AdventureMapSlot*>::const_iterator slotIter = m_adventureMapSlots.begin(); slotIter != m_adventureMapSlots.end(); slotIter++)
 	{
-		AdventureMap currentAdventureMap = m_currentAdventure->m_maps[m_maps[mapIndex]->m_name];
-		for (size_t exitIndex = 0; exitIndex < currentAdventureMap.m_exitsToSpawn.size(); exitIndex++)
-		{
-			Feature* newExit = new Feature(currentAdventureMap.m_exitsToSpawn[exitIndex].m_exitType);
-
-			//Get destination map
-			Map* destinationMap = nullptr;
-			for (size_t findMapIndex = 0; findMapIndex < m_maps.size(); findMapIndex++)
-			{
-				if (m_maps[findMapIndex]->m_name == currentAdventureMap.m_exitsToSpawn[exitIndex].m_destinationMapName)
-				{
-					destinationMap = m_maps[findMapIndex];
-					break;
-				}
-			}
-			ASSERT_OR_DIE(destinationMap != nullptr, "Invalid destination map name in exit.");
-
-
-			Tile* destinationTile;
-			if (currentAdventureMap.m_exitsToSpawn[exitIndex].m_destinationTileType.empty())
-				destinationTile = destinationMap->GetRandomTraversableTile();
-			else
-				destinationTile = destinationMap->GetRandomTileOfType(currentAdventureMap.m_exitsToSpawn[exitIndex].m_destinationTileType);
-
-			ASSERT_OR_DIE(destinationTile != nullptr, "Attempted to place destination of exit in impossible place.");
-			newExit->m_exitData.m_destinationTile = destinationTile;
-
-			Tile* tileToSpawnOn;
-			if (currentAdventureMap.m_exitsToSpawn[exitIndex].m_tileTypeToSpawnOn.empty())
-				tileToSpawnOn = m_maps[mapIndex]->GetRandomTraversableTile();
-			else
-				tileToSpawnOn = m_maps[mapIndex]->GetRandomTileOfType(currentAdventureMap.m_exitsToSpawn[exitIndex].m_tileTypeToSpawnOn);
-			ASSERT_OR_DIE(tileToSpawnOn != nullptr, "Attempted to spawn exit in impossible place.");
-
-			m_maps[mapIndex]->PlaceFeatureInMap(newExit, tileToSpawnOn);
-
-			//Place reciprocal exit
-			if (!currentAdventureMap.m_exitsToSpawn[exitIndex].m_featureTypeToPlace.empty())
-			{
-				Feature* newFeature = new Feature(currentAdventureMap.m_exitsToSpawn[exitIndex].m_featureTypeToPlace);
-				destinationMap->PlaceFeatureInMap(newFeature, destinationTile);
-
-				if (newExit->m_exitData.m_isTwoWay)
-				{
-					newFeature->m_exitData.m_destinationTile = tileToSpawnOn;
-				}
-			}
-		}
+		if (slotIter->second->m_isGenerationQueued && slotIter->second->m_generationCounter.m_numJobsRemaining == 0)
+			numMapsGenerated++;
 	}
 
-	//Sets starting map
-	for (size_t mapIndex = 0; mapIndex < m_maps.size(); mapIndex++)
+	return numMapsGenerated;
+}
+
+int World::GetNumAdventureMapsToGenerate() const
+{
+	int numMapsToGenerate = 0;
+	for (std::map<std::string, AdventureMapSlot*>::const_iterator slotIter = m_adventureMapSlots.begin(); slotIter != m_adventureMapSlots.end(); slotIter++)
 	{
-		if (m_maps[mapIndex]->m_name == m_currentAdventure->m_startingConditions.m_startingMap)
-		{
-			m_currentMap = m_maps[mapIndex];
-			break;
-		}
+		if (slotIter->second->m_isGenerationQueued)
+			numMapsToGenerate++;
 	}
-	
-	ASSERT_OR_DIE(m_currentMap, "No map in adventure matches starting map name.");
+
+	return numMapsToGenerate;
+}
+
+void World::FinishGeneratingAdventure()
+{
+	m_currentMap = GetAdventureMap(m_currentAdventure->m_startingConditions.m_startingMap);
 
 	//Places player and actors in current map
 	Tile* startingTile;
@@ -334,18 +412,176 @@ void World::GenerateAdventure(std::string adventureName)
 	else
 		startingTile = m_currentMap->GetRandomTileOfType(m_currentAdventure->m_startingConditions.m_tileTypeToStartOn);
 
-	m_thePlayer = CharacterBuilder::BuildNewCharacter("player");
+	m_thePlayer = CharacterBuilder::BuildNewCharacter("player", m_currentMap->m_random);
 	m_currentMap->PlaceCharacterInMap(m_thePlayer, startingTile);
 	m_currentMap->m_damageNumbers.push_back(DamageNumber(m_currentAdventure->m_startingText, Vector2(ORTHO_X_DIMENSION * 0.5f, ORTHO_Y_DIMENSION * 0.5f), Rgba::WHITE, 3.f));
 }
 
+Map* World::GetAdventureMap(const std::string& adventureMapName)
+{
+	AdventureMapSlot* slot = GetAdventureMapSlot(adventureMapName);
+	if (!slot)
+		return nullptr;
+
+	if (!slot->m_isPopulated)
+	{
+		QueueAdventureMapGeneration(slot);
+		if (g_theJobSystem)
+			g_theJobSystem->WaitForCounter(slot->m_generationCounter);
+
+		PopulateAdventureMap(slot);
+	}
+
+	return slot->m_map;
+}
+
+Tile* World::ResolveExit(Feature* exitFeature)
+{
+	ExitData& exitData = exitFeature->m_exitData;
+	if (exitData.m_destinationTile || exitData.m_destinationMapName.empty())
+	{
+		if (exitData.m_destinationTile)
+			CatchUpBackgroundMap(exitData.m_destinationTile->m_containingMap);
+		return exitData.m_destinationTile;
+	}
+
+	Map* destinationMap = GetAdventureMap(exitData.m_destinationMapName);
+	ASSERT_OR_DIE(destinationMap != nullptr, "Invalid destination map name in exit.");
+
+	//The destination has to be settled before a tile is picked on it
+	CatchUpBackgroundMap(destinationMap);
+
+	Tile* destinationTile;
+	if (exitData.m_destinationTileType.empty())
+		destinationTile = destinationMap->GetRandomTraversableTile();
+	else
+		destinationTile = destinationMap->GetRandomTileOfType(exitData.m_destinationTileType);
+	ASSERT_OR_DIE(destinationTile != nullptr, "Attempted to place destination of exit in impossible place.");
+	exitData.m_destinationTile = destinationTile;
+
+	//Place reciprocal exit
+	if (!exitData.m_featureTypeToPlace.empty())
+	{
+		Feature* newFeature = new Feature(exitData.m_featureTypeToPlace);
+		destinationMap->PlaceFeatureInMap(newFeature, destinationTile);
+
+		if (exitData.m_isTwoWay)
+			newFeature->m_exitData.m_destinationTile = exitFeature->m_currentTile;
+	}
+
+	return destinationTile;
+}
+
+void World::ChangeCurrentMap(Map* newMap)
+{
+	if (newMap == m_currentMap)
+		return;
+
+	BackgroundMap* returningMap = FindBackgroundMap(newMap);
+	if (returningMap)
+	{
+		CatchUpBackgroundMap(newMap);
+		m_backgroundMaps.erase(std::find(m_backgroundMaps.begin(), m_backgroundMaps.end(), returningMap));
+		delete returningMap;
+		newMap->m_isInBackground = false;
+
+		//Hits landed while the player was away happened out of sight
+		newMap->m_damageNumbers.clear();
+	}
+
+	if (m_currentMap && BACKGROUND_SIMULATION_MODE != BACKGROUND_SIMULATION_OFF)
+		SendMapToBackground(m_currentMap);
+
+	m_currentMap = newMap;
+}
+
+World::AdventureMapSlot* World::GetAdventureMapSlot(const std::string& adventureMapName) const
+{
+	std::map<std::string, AdventureMapSlot*>::const_iterator found = m_adventureMapSlots.find(adventureMapName);
+	if (found != m_adventureMapSlots.end())
+		return found->second;
+	else
+		return nullptr;
+}
+
+void World::QueueAdventureMapGeneration(AdventureMapSlot* slot)
+{
+	if (slot->m_isGenerationQueued)
+		return;
+
+	slot->m_isGenerationQueued = true;
+	if (g_theJobSystem)
+		g_theJobSystem->QueueJob([slot]() { GenerateAdventureMap(slot); }, &slot->m_generationCounter);
+	else
+		GenerateAdventureMap(slot);
+}
+
+void World::GenerateAdventureMap(AdventureMapSlot* slot)
+{
+	MapDefinition* mapDefinition = slot->m_adventureMap->m_definition;
+	Map* newMap = new Map(mapDefinition->m_name, slot->m_seed);
+	MapCache::GenerateMap(newMap);
+	slot->m_map = newMap;
+}
+
+//Runs on the main thread once a map has been generated: spawns its items, characters and exits, and starts generating the maps its exits lead to
+void World::PopulateAdventureMap(AdventureMapSlot* slot)
+{
+	const AdventureMap* adventureMap = slot->m_adventureMap;
+	Map* tempMap = slot->m_map;
+	tempMap->m_name = adventureMap->m_name;
+	tempMap->m_world = this;
+
+	std::vector<AdventureItem> itemsToSpawn = adventureMap->m_itemsToSpawn;
+	for (AdventureItem item : itemsToSpawn)
+	{
+		Item* newItem = new Item(item.m_definition, tempMap->m_random);
+		tempMap->PlaceItemInMap(newItem, tempMap->GetRandomTileOfType(item.m_tileTypeToSpawnOn));
+	}
+
+	std::vector<AdventureCharacter> charactersToSpawn = adventureMap->m_charactersToSpawn;
+	for (AdventureCharacter character : charactersToSpawn)
+	{
+		Character* newCharacter = CharacterBuilder::BuildNewCharacter(character.m_builderName, tempMap->m_random);
+		tempMap->PlaceCharacterInMap(newCharacter, tempMap->GetRandomTileOfType(character.m_tileTypeToSpawnOn));
+	}
+
+	//Place exits. Their destinations are only resolved when they are first used.
+	for (const AdventureExit& exitToSpawn : adventureMap->m_exitsToSpawn)
+	{
+		AdventureMapSlot* destinationSlot = GetAdventureMapSlot(exitToSpawn.m_destinationMapName);
+		ASSERT_OR_DIE(destinationSlot != nullptr, "Invalid destination map name in exit.");
+
+		Feature* newExit = new Feature(exitToSpawn.m_exitType);
+		newExit->m_exitData.m_destinationMapName = exitToSpawn.m_destinationMapName;
+		newExit->m_exitData.m_destinationTileType = exitToSpawn.m_destinationTileType;
+		newExit->m_exitData.m_featureTypeToPlace = exitToSpawn.m_featureTypeToPlace;
+		newExit->m_exitData.m_destinationTile = nullptr;
+
+		Tile* tileToSpawnOn;
+		if (exitToSpawn.m_tileTypeToSpawnOn.empty())
+			tileToSpawnOn = tempMap->GetRandomTraversableTile();
+		else
+			tileToSpawnOn = tempMap->GetRandomTileOfType(exitToSpawn.m_tileTypeToSpawnOn);
+		ASSERT_OR_DIE(tileToSpawnOn != nullptr, "Attempted to spawn exit in impossible place.");
+
+		tempMap->PlaceFeatureInMap(newExit, tileToSpawnOn);
+
+		//The player can reach this map next, so get a head start on it
+		QueueAdventureMapGeneration(destinationSlot);
+	}
+
+	m_maps.push_back(tempMap);
+	slot->m_isPopulated = true;
+}
+
 void World::PlaceCorridor(Map*& mapToPlaceCorridorIn, const IntVector2& startCoords, const IntVector2& endCoords, std::string corridorTile, std::string roomFloorTile)
 {
 	IntVector2 distanceDebts = endCoords - startCoords;
 	IntVector2 currentCoords = startCoords;
 
 	if (mapToPlaceCorridorIn->GetTileAtTileCoords(currentCoords)->m_tileDefinition->m_name != roomFloorTile)
-		mapToPlaceCorridorIn->GetTileAtTileCoords(currentCoords)->ChangeType(corridorTile);
+		mapToPlaceCorridorIn->GetTileAtTileCoords(currentCoords)->ChangeType(corridorTile, mapToPlaceCorridorIn->m_random);
 
 	while (distanceDebts.x != 0 || distanceDebts.y != 0)
 	{
@@ -361,12 +597,12 @@ void World::PlaceCorridor(Map*& mapToPlaceCorridorIn, const IntVector2& startCoo
 		else if (distanceDebts.y < 0)
 			possibleDirections.push_back(IntVector2(0, -1));
 
-		IntVector2 nextDirection = possibleDirections[GetRandomIntLessThan(possibleDirections.size())];
+		IntVector2 nextDirection = possibleDirections[mapToPlaceCorridorIn->m_random.GetRandomIntLessThan(possibleDirections.size())];
 		distanceDebts = distanceDebts - nextDirection;
 		currentCoords = currentCoords + nextDirection;
 
 		if (mapToPlaceCorridorIn->GetTileAtTileCoords(currentCoords)->m_tileDefinition->m_name != roomFloorTile)
-			mapToPlaceCorridorIn->GetTileAtTileCoords(currentCoords)->ChangeType(corridorTile);
+			mapToPlaceCorridorIn->GetTileAtTileCoords(currentCoords)->ChangeType(corridorTile, mapToPlaceCorridorIn->m_random);
 	}
 }
 
@@ -412,3 +648,73 @@ void World::FinishGeneratingMap()
 		isCompleted = StepGeneration();
 	}
 }
+
+World::BackgroundMap* World::FindBackgroundMap(Map* map) const
+{
+	for (BackgroundMap* backgroundMap : m_backgroundMaps)
+	{
+		if (backgroundMap->m_map == map)
+			return backgroundMap;
+	}
+
+	return nullptr;
+}
+
+void World::SendMapToBackground(Map* map)
+{
+	//Set here rather than in the jobs, so it never changes while a job could be reading it
+	map->m_isInBackground = true;
+
+	BackgroundMap* backgroundMap = new BackgroundMap();
+	backgroundMap->m_map = map;
+	backgroundMap->m_tickWhenLeft = map->m_currentTick;
+	m_backgroundMaps.push_back(backgroundMap);
+}
+
+//Waits out any update already queued or running on the map, then replays whatever it is still owed. The main thread waits
+//on a map's own update only here and at shutdown, and BACKGROUND_SIMULATION_MAX_TURNS and the budget bound both. Waits
+//elsewhere never run background updates (see JobSystem).
+void World::CatchUpBackgroundMap(Map* map)
+{
+	BackgroundMap* backgroundMap = FindBackgroundMap(map);
+	if (!backgroundMap)
+		return;
+
+	if (g_theJobSystem)
+		g_theJobSystem->WaitForCounter(backgroundMap->m_simulationCounter);
+
+	map->AdvanceToTick(backgroundMap->m_tickWhenLeft + backgroundMap->m_ticksSinceLeft);
+}
+
+void World::UpdateBackgroundMaps(int elapsedTicks)
+{
+	int maxTicksSinceLeft = BACKGROUND_SIMULATION_MAX_TURNS * TICKS_PER_TURN;
+	for (BackgroundMap* backgroundMap : m_backgroundMaps)
+	{
+		backgroundMap->m_ticksSinceLeft += elapsedTicks;
+		if (maxTicksSinceLeft > 0 && backgroundMap->m_ticksSinceLeft > maxTicksSinceLeft)
+			backgroundMap->m_ticksSinceLeft = maxTicksSinceLeft;
+
+		if (BACKGROUND_SIMULATION_MODE != BACKGROUND_SIMULATION_WORKER || !g_theJobSystem)
+			continue;
+
+		//An update still running from an earlier turn is left to finish rather than waited on
+		backgroundMap->m_numTurnsSinceUpdate++;
+		if (backgroundMap->m_numTurnsSinceUpdate < BACKGROUND_SIMULATION_INTERVAL || backgroundMap->m_simulationCounter.m_numJobsRemaining > 0)
+			continue;
+
+		Map* map = backgroundMap->m_map;
+		int targetTick = backgroundMap->m_tickWhenLeft + backgroundMap->m_ticksSinceLeft;
+		if (map->m_currentTick >= targetTick)
+			continue;
+
+		backgroundMap->m_numTurnsSinceUpdate = 0;
+		g_theJobSystem->QueueJob([map, targetTick]() { SimulateBackgroundMap(map, targetTick); }, &backgroundMap->m_simulationCounter, JOB_QUEUE_BACKGROUND);
+	}
+}
+
+//Runs on a worker. Whatever the budget cuts off is picked up by the next update or by the catch-up when the player returns.
+void World::SimulateBackgroundMap(Map* map, int targetTick)
+{
+	map->AdvanceToTick(targetTick, BACKGROUND_SIMULATION_BUDGET_MS / 1000.0);
+}
@@ -2,12 +2,35 @@
 #include "Game/Map.hpp"
 #include <vector>
 #include "Adventure.hpp"
+#include "Game/JobSystem.hpp"
+#include <map>
 
 
+enum PlayerCommand
+{
+	PLAYER_COMMAND_NONE,
+	PLAYER_COMMAND_MOVE_NORTH,
+	PLAYER_COMMAND_MOVE_SOUTH,
+	PLAYER_COMMAND_MOVE_EAST,
+	PLAYER_COMMAND_MOVE_WEST,
+	PLAYER_COMMAND_REST,
+	NUM_PLAYER_COMMANDS
+};
+
+//Changes to the player's gear. They take no time, but they change what happens on the turns after them.
+enum InventoryCommand
+{
+	INVENTORY_COMMAND_TOGGLE_EQUIPPED,
+	INVENTORY_COMMAND_DROP,
+	NUM_INVENTORY_COMMANDS
+};
+
+class SessionRecording;
+
 class World
 {
 public:
-	World();
+	World(unsigned int worldSeed);
 	~World();
 
 	void Initialize();
@@ -16,6 +39,8 @@ public:
 	bool StepGeneration();
 	void FinishGeneratingMap();
 
+	//Every map seed is derived from this, so the same world seed always builds the same adventure
+	unsigned int m_worldSeed;
 	Vector2 m_cursorPosition;
 	Character* m_thePlayer;
 
@@ -26,17 +51,71 @@ public:
 	bool m_hasPlayerWon = false;
 	bool m_hasPlayerLost = false;
 
+	//Everything the player does is appended here while it is set. The world owns it.
+	SessionRecording* m_sessionRecording = nullptr;
+	int m_numTurnsExecuted = 0;
+
 	MapDefinition* m_currentlyGeneratingMapDefinition;
 	Map* m_currentlyGeneratingMap;
 
 	void Update(float deltaSeconds);
+	bool ExecutePlayerCommand(PlayerCommand command);
+	bool ExecuteInventoryCommand(InventoryCommand command, int itemIndex);
+	unsigned long long CalculateStateHash() const;
 	void Render() const;
 	void DrawCursor() const;
 	void DrawUI() const;
 
 
 	void GenerateAdventure(std::string adventureName);
+	void StartGeneratingAdventure(std::string adventureName);
+	bool IsStartingMapGenerated() const;
+	void FinishGeneratingAdventure();
+	int GetNumAdventureMapsGenerated() const;
+	int GetNumAdventureMapsToGenerate() const;
+
+	Map* GetAdventureMap(const std::string& adventureMapName);
+	Tile* ResolveExit(Feature* exitFeature);
+	void ChangeCurrentMap(Map* newMap);
 private:
+	struct AdventureMapSlot
+	{
+		const AdventureMap* m_adventureMap = nullptr;
+		Map* m_map = nullptr;
+		unsigned int m_seed = 0;
+		JobCounter m_generationCounter;
+		bool m_isGenerationQueued = false;
+		bool m_isPopulated = false;
+	};
+
+	AdventureMapSlot* GetAdventureMapSlot(const std::string& adventureMapName) const;
+	void QueueAdventureMapGeneration(AdventureMapSlot* slot);
+	static void GenerateAdventureMap(AdventureMapSlot* slot);
+	void PopulateAdventureMap(AdventureMapSlot* slot);
+
+	//Maps are generated on the job system and populated on the main thread the first time they are needed
+	std::map<std::string, AdventureMapSlot*> m_adventureMapSlots;
+
+	struct BackgroundMap
+	{
+		Map* m_map = nullptr;
+		JobCounter m_simulationCounter;
+		int m_tickWhenLeft = 0;
+		int m_ticksSinceLeft = 0;
+		int m_numTurnsSinceUpdate = 0;
+	};
+
+	BackgroundMap* FindBackgroundMap(Map* map) const;
+	void SendMapToBackground(Map* map);
+	void CatchUpBackgroundMap(Map* map);
+	void UpdateBackgroundMaps(int elapsedTicks);
+	static void SimulateBackgroundMap(Map* map, int targetTick);
+
+	//Maps the player has left. The ticks they are owed are counted here on the main thread, so a map always ends up in the
+	//same state when the player returns, however much of it a worker managed beforehand.
+	std::vector<BackgroundMap*> m_backgroundMaps;
+
+	PlayerCommand GetPlayerCommandFromInput() const;
 	void DrawTooltip() const;
 	void PlaceCorridor(Map*& mapToPlaceCorridorIn, const IntVector2& startCoords, const IntVector2& endCoords, std::string corridorTile, std::string roomFloorTile);
 	void UpdateFogOfWar();
@@ -0,0 +1,253 @@
+#include "Headless/HeadlessSimulation.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Game/Map.hpp"
+#include "Engine/Core/ConfigSystem.hpp"
+#include <fstream>
+#include <stdio.h>
+
+
+HeadlessSimulation::HeadlessSimulation(const HeadlessOptions& options)
+	: m_options(options)
+	, m_world(nullptr)
+	, m_policyRandom(RandomStream::DeriveSeed(options.m_seed, RandomStream::HashString("HeadlessPolicy")))
+	, m_numTurnsRun(0)
+	, m_generationSeconds(0.0)
+	, m_simulationSeconds(0.0)
+	, m_slowestTurnSeconds(0.0)
+	, m_slowestTurn(-1)
+	, m_replay()
+	, m_nextReplayEvent(0)
+	, m_numCheckpointsMatched(0)
+	, m_divergedTurn(-1)
+{
+
+}
+
+HeadlessSimulation::~HeadlessSimulation()
+{
+	delete m_world;
+	m_world = nullptr;
+}
+
+bool HeadlessSimulation::Run()
+{
+	if (IsReplaying())
+	{
+		if (!m_replay.LoadFromFile(m_options.m_replayFileName))
+			return false;
+
+		m_options.m_seed = m_replay.m_worldSeed;
+		m_options.m_adventureName = m_replay.m_adventureName;
+		m_options.m_numTurns = m_replay.CountTurns();
+	}
+
+	double generationStartSeconds = GetCurrentTimeSeconds();
+	m_world = new World(m_options.m_seed);
+	m_world->GenerateAdventure(m_options.m_adventureName);
+	m_generationSeconds = GetCurrentTimeSeconds() - generationStartSeconds;
+
+	if (!m_options.m_recordFileName.empty())
+	{
+		m_world->m_sessionRecording = new SessionRecording();
+		m_world->m_sessionRecording->m_worldSeed = m_options.m_seed;
+		m_world->m_sessionRecording->m_adventureName = m_options.m_adventureName;
+		g_theConfig->GetConfigInt(m_world->m_sessionRecording->m_checkpointInterval, "SessionCheckpointInterval");
+	}
+
+	double simulationStartSeconds = GetCurrentTimeSeconds();
+	for (m_numTurnsRun = 0; m_numTurnsRun < m_options.m_numTurns; m_numTurnsRun++)
+	{
+		if (!m_world->m_thePlayer)
+			break;
+
+		PlayerCommand command = IsReplaying() ? ReplayUpToNextTurn() : ChoosePlayerCommand();
+
+		double turnStartSeconds = GetCurrentTimeSeconds();
+		m_world->ExecutePlayerCommand(command);
+		double turnSeconds = GetCurrentTimeSeconds() - turnStartSeconds;
+		RecordTurn(turnSeconds);
+
+		if (turnSeconds > m_slowestTurnSeconds)
+		{
+			m_slowestTurnSeconds = turnSeconds;
+			m_slowestTurn = m_numTurnsRun;
+		}
+
+		//Timings past the first mismatch describe some other session, so the replay stops there
+		if (IsReplaying() && !VerifyReplayCheckpoints())
+		{
+			m_divergedTurn = m_numTurnsRun;
+			m_numTurnsRun++;
+			break;
+		}
+	}
+	m_simulationSeconds = GetCurrentTimeSeconds() - simulationStartSeconds;
+
+	return true;
+}
+
+void HeadlessSimulation::PrintReport() const
+{
+	const char* outcome = "running";
+	if (m_world->m_hasPlayerLost)
+		outcome = "player died";
+	else if (m_world->m_hasPlayerWon)
+		outcome = "player won";
+
+	double turnsPerSecond = m_simulationSeconds > 0.0 ? m_numTurnsRun / m_simulationSeconds : 0.0;
+	double meanTurnMilliseconds = m_numTurnsRun > 0 ? (m_simulationSeconds * 1000.0) / m_numTurnsRun : 0.0;
+
+	std::string policyName = IsReplaying() ? "replayed" : GetPolicyName(m_options.m_policy);
+	printf("Adventure:         %s (seed %u, %s policy)\n", m_options.m_adventureName.c_str(), m_options.m_seed, policyName.c_str());
+	printf("Generation:        %.1f ms\n", m_generationSeconds * 1000.0);
+	printf("Turns:             %d of %d (%s)\n", m_numTurnsRun, m_options.m_numTurns, outcome);
+	printf("Simulation:        %.1f ms\n", m_simulationSeconds * 1000.0);
+	printf("Turns per second:  %.0f\n", turnsPerSecond);
+	printf("Mean turn:         %.4f ms\n", meanTurnMilliseconds);
+	printf("Slowest turn:      %.4f ms (turn %d)\n", m_slowestTurnSeconds * 1000.0, m_slowestTurn);
+	printf("Current map:       %s, %d characters, %d maps loaded\n", m_world->m_currentMap->m_name.c_str(), CountCharactersOnCurrentMap(), (int)m_world->m_maps.size());
+
+	double totalActive = 0.0;
+	double totalDormant = 0.0;
+	int peakDormant = 0;
+	for (const HeadlessTurnRecord& record : m_turnRecords)
+	{
+		totalActive += record.m_numActive;
+		totalDormant += record.m_numDormant;
+		if (record.m_numDormant > peakDormant)
+			peakDormant = record.m_numDormant;
+	}
+
+	double numRecords = m_turnRecords.empty() ? 1.0 : (double)m_turnRecords.size();
+	printf("Population:        %.1f active, %.1f dormant on average (peak %d dormant, radius %d)\n", totalActive / numRecords, totalDormant / numRecords, peakDormant, SIMULATION_ACTIVE_RADIUS);
+
+	if (!IsReplaying())
+		return;
+
+	if (m_divergedTurn >= 0)
+		printf("Replay:            DIVERGED by turn %d, after %d matching checkpoints\n", m_divergedTurn + 1, m_numCheckpointsMatched);
+	else
+		printf("Replay:            %d checkpoints matched\n", m_numCheckpointsMatched);
+}
+
+bool HeadlessSimulation::WriteTurnLog(const std::string& filePath) const
+{
+	std::ofstream csvFile(filePath.c_str(), std::ios::trunc);
+	if (!csvFile.is_open())
+		return false;
+
+	csvFile << "turn,turn_ms,active,dormant,woken,put_to_sleep,actions\n";
+	for (const HeadlessTurnRecord& record : m_turnRecords)
+	{
+		char line[256];
+		snprintf(line, sizeof(line), "%d,%.4f,%d,%d,%d,%d,%d\n", record.m_turn, record.m_seconds * 1000.0, record.m_numActive, record.m_numDormant,
+			record.m_numWoken, record.m_numPutToSleep, record.m_numActions);
+		csvFile << line;
+	}
+
+	return !csvFile.fail();
+}
+
+bool HeadlessSimulation::WriteSessionRecording(const std::string& filePath) const
+{
+	if (!m_world || !m_world->m_sessionRecording)
+		return false;
+
+	return m_world->m_sessionRecording->SaveToFile(filePath);
+}
+
+bool HeadlessSimulation::ParsePolicy(const std::string& policyName, HeadlessPolicy& out_policy)
+{
+	for (int policyIndex = 0; policyIndex < NUM_HEADLESS_POLICIES; policyIndex++)
+	{
+		if (GetPolicyName((HeadlessPolicy)policyIndex) == policyName)
+		{
+			out_policy = (HeadlessPolicy)policyIndex;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+std::string HeadlessSimulation::GetPolicyName(HeadlessPolicy policy)
+{
+	switch (policy)
+	{
+	case HEADLESS_POLICY_RANDOM:
+		return "random";
+	case HEADLESS_POLICY_REST:
+		return "rest";
+	default:
+		return "unknown";
+	}
+}
+
+PlayerCommand HeadlessSimulation::ChoosePlayerCommand()
+{
+	switch (m_options.m_policy)
+	{
+	case HEADLESS_POLICY_RANDOM:
+		return (PlayerCommand)m_policyRandom.GetRandomIntInRange(PLAYER_COMMAND_MOVE_NORTH, PLAYER_COMMAND_REST);
+	case HEADLESS_POLICY_REST:
+	default:
+		return PLAYER_COMMAND_REST;
+	}
+}
+
+//Inventory changes the player made before the turn take no time, so they are applied here rather than timed with it
+PlayerCommand HeadlessSimulation::ReplayUpToNextTurn()
+{
+	while (m_nextReplayEvent < m_replay.m_events.size())
+	{
+		const SessionEvent& replayedEvent = m_replay.m_events[m_nextReplayEvent];
+		m_nextReplayEvent++;
+
+		if (replayedEvent.m_type == SESSION_EVENT_TURN)
+			return replayedEvent.m_playerCommand;
+		else if (replayedEvent.m_type == SESSION_EVENT_INVENTORY)
+			m_world->ExecuteInventoryCommand(replayedEvent.m_inventoryCommand, replayedEvent.m_itemIndex);
+	}
+
+	return PLAYER_COMMAND_NONE;
+}
+
+bool HeadlessSimulation::VerifyReplayCheckpoints()
+{
+	while (m_nextReplayEvent < m_replay.m_events.size() && m_replay.m_events[m_nextReplayEvent].m_type == SESSION_EVENT_CHECKPOINT)
+	{
+		unsigned long long recordedHash = m_replay.m_events[m_nextReplayEvent].m_stateHash;
+		m_nextReplayEvent++;
+
+		if (m_world->CalculateStateHash() != recordedHash)
+			return false;
+
+		m_numCheckpointsMatched++;
+	}
+
+	return true;
+}
+
+int HeadlessSimulation::CountCharactersOnCurrentMap() const
+{
+	return (int)m_world->m_currentMap->FindAllCharacters().size();
+}
+
+void HeadlessSimulation::RecordTurn(double turnSeconds)
+{
+	//Counted after the turn is timed, since finding every character walks the whole map
+	const Map* currentMap = m_world->m_currentMap;
+	int numNonPlayerCharacters = CountCharactersOnCurrentMap();
+	if (m_world->m_thePlayer && m_world->m_thePlayer->m_currentMap == currentMap)
+		numNonPlayerCharacters--;
+
+	HeadlessTurnRecord record;
+	record.m_turn = m_numTurnsRun;
+	record.m_seconds = turnSeconds;
+	record.m_numDormant = currentMap->m_lodStats.m_numDormant;
+	record.m_numActive = numNonPlayerCharacters - record.m_numDormant;
+	record.m_numWoken = currentMap->m_lodStats.m_numWoken;
+	record.m_numPutToSleep = currentMap->m_lodStats.m_numPutToSleep;
+	record.m_numActions = currentMap->m_lodStats.m_numActions;
+	m_turnRecords.push_back(record);
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Game/World.hpp"
+#include "Game/RandomStream.hpp"
+#include "Game/SessionRecording.hpp"
+
+
+enum HeadlessPolicy
+{
+	HEADLESS_POLICY_RANDOM,			//Uniformly random move or rest every turn
+	HEADLESS_POLICY_REST,			//Never moves; only the rest of the map does anything
+	NUM_HEADLESS_POLICIES
+};
+
+struct HeadlessOptions
+{
+	unsigned int m_seed = 1;
+	std::string m_adventureName = "Test";
+	int m_numTurns = 10000;
+	HeadlessPolicy m_policy = HEADLESS_POLICY_RANDOM;
+	int m_numWorkerThreads = -1;						//-1 leaves one core for the simulation thread
+	std::string m_turnLogFileName;						//Per-turn CSV of turn time and simulated population, empty for none
+	std::string m_recordFileName;						//Session recording of the run, empty for none
+	std::string m_replayFileName;						//Session recording to play instead of the policy; overrides seed, adventure and turns
+};
+
+struct HeadlessTurnRecord
+{
+	int m_turn = 0;
+	double m_seconds = 0.0;
+	int m_numActive = 0;
+	int m_numDormant = 0;
+	int m_numWoken = 0;
+	int m_numPutToSleep = 0;
+	int m_numActions = 0;
+};
+
+//Builds a World from the gameplay definitions and plays it with a scripted player as fast as it will go. Nothing here
+//needs a window, renderer or input, so it builds with ROGUELIKE_HEADLESS on any platform the Engine core builds on.
+class HeadlessSimulation
+{
+public:
+	HeadlessSimulation(const HeadlessOptions& options);
+	~HeadlessSimulation();
+
+	bool Run();
+	void PrintReport() const;
+	bool WriteTurnLog(const std::string& filePath) const;
+	bool WriteSessionRecording(const std::string& filePath) const;
+
+	static bool ParsePolicy(const std::string& policyName, HeadlessPolicy& out_policy);
+	static std::string GetPolicyName(HeadlessPolicy policy);
+
+private:
+	PlayerCommand ChoosePlayerCommand();
+	bool IsReplaying() const { return !m_options.m_replayFileName.empty(); }
+	PlayerCommand ReplayUpToNextTurn();
+	bool VerifyReplayCheckpoints();
+	int CountCharactersOnCurrentMap() const;
+	void RecordTurn(double turnSeconds);
+
+	HeadlessOptions m_options;
+	World* m_world;
+	RandomStream m_policyRandom;
+
+	int m_numTurnsRun;
+	double m_generationSeconds;
+	double m_simulationSeconds;
+	double m_slowestTurnSeconds;
+	int m_slowestTurn;
+	std::vector<HeadlessTurnRecord> m_turnRecords;
+
+	SessionRecording m_replay;
+	size_t m_nextReplayEvent;
+	int m_numCheckpointsMatched;
+	int m_divergedTurn;
+};
@@ -0,0 +1,110 @@
+#include "Headless/HeadlessSimulation.hpp"
+#include "Game/GameplayDefinitions.hpp"
+#include "Game/JobSystem.hpp"
+#include "Game/MapCache.hpp"
+#include "Engine/Core/ConfigSystem.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+
+
+//-----------------------------------------------------------------------------------------------
+void PrintUsage()
+{
+	printf("Headless [options]\n");
+	printf("  -seed=N                 World seed (default: 1)\n");
+	printf("  -adventure=name         Adventure to play (default: Test)\n");
+	printf("  -turns=N                Player turns to simulate (default: 10000)\n");
+	printf("  -policy=random|rest     How the player picks its commands (default: random)\n");
+	printf("  -threads=N              Worker threads for map generation and AI planning, -1 for one per spare core (default: -1)\n");
+	printf("  -turnLog=file.csv       Write each turn's time and active/dormant population\n");
+	printf("  -record=file            Save the run as a session recording\n");
+	printf("  -replay=file            Play a session recording instead of a policy, checking its checkpoints\n");
+}
+
+//-----------------------------------------------------------------------------------------------
+bool ParseArguments(int argc, char* argv[], HeadlessOptions& out_options)
+{
+	for (int argIndex = 1; argIndex < argc; argIndex++)
+	{
+		std::string argument = argv[argIndex];
+		size_t equalsIndex = argument.find('=');
+		if (argument.empty() || argument[0] != '-' || equalsIndex == std::string::npos)
+			return false;
+
+		std::string key = argument.substr(1, equalsIndex - 1);
+		std::string value = argument.substr(equalsIndex + 1);
+
+		if (key == "seed")
+			out_options.m_seed = (unsigned int)strtoul(value.c_str(), nullptr, 10);
+		else if (key == "adventure")
+			out_options.m_adventureName = value;
+		else if (key == "turns")
+			out_options.m_numTurns = atoi(value.c_str());
+		else if (key == "policy")
+		{
+			if (!HeadlessSimulation::ParsePolicy(value, out_options.m_policy))
+				return false;
+		}
+		else if (key == "threads")
+			out_options.m_numWorkerThreads = atoi(value.c_str());
+		else if (key == "turnLog")
+			out_options.m_turnLogFileName = value;
+		else if (key == "record")
+			out_options.m_recordFileName = value;
+		else if (key == "replay")
+			out_options.m_replayFileName = value;
+		else
+			return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	HeadlessOptions options;
+	if (!ParseArguments(argc, argv, options))
+	{
+		PrintUsage();
+		return 2;
+	}
+
+	g_theConfig = new ConfigSystem();
+	g_theConfig->Initialize("Roguelike.config");
+
+	std::string mapCacheDirectory;
+	g_theConfig->GetConfigString(mapCacheDirectory, "MapCacheDirectory");
+	MapCache::Initialize(mapCacheDirectory);
+
+	GameplayDefinitions::LoadAll();
+
+	if (options.m_numWorkerThreads != 0)
+		g_theJobSystem = new JobSystem(options.m_numWorkerThreads);
+
+	int exitCode = 0;
+	{
+		HeadlessSimulation simulation(options);
+		if (!simulation.Run())
+		{
+			printf("Could not read session recording %s\n", options.m_replayFileName.c_str());
+			exitCode = 1;
+		}
+		else
+		{
+			simulation.PrintReport();
+
+			if (!options.m_turnLogFileName.empty() && !simulation.WriteTurnLog(options.m_turnLogFileName))
+				printf("Could not write %s\n", options.m_turnLogFileName.c_str());
+			if (!options.m_recordFileName.empty() && !simulation.WriteSessionRecording(options.m_recordFileName))
+				printf("Could not write %s\n", options.m_recordFileName.c_str());
+		}
+	}
+
+	delete g_theJobSystem;
+	g_theJobSystem = nullptr;
+	delete g_theConfig;
+	g_theConfig = nullptr;
+
+	return exitCode;
+}
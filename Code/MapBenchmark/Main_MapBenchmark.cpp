@@ -0,0 +1,107 @@
+#include "MapBenchmark/MapBenchmark.hpp"
+#include "Game/GameplayDefinitions.hpp"
+#include "Engine/Core/ConfigSystem.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+
+
+//-----------------------------------------------------------------------------------------------
+void PrintUsage()
+{
+	printf("MapBenchmark [options]\n");
+	printf("  -maps=name,name         Map definitions to run (default: all)\n");
+	printf("  -sizes=native,64x64     Dimensions to sweep, 'native' uses the definition's own (default: native)\n");
+	printf("  -seeds=N                Seeds per map and size (default: 5)\n");
+	printf("  -baseSeed=N             Seed the sweep derives its seeds from (default: 1)\n");
+	printf("  -neighborReps=N         Repetitions of the neighbor access microbenchmark (default: 50)\n");
+	printf("  -out=path               Output prefix, writes path.csv and path.json (default: MapBenchmark)\n");
+	printf("  -baseline=file.csv      Compare against a previous run's CSV\n");
+	printf("  -threshold=percent      Slowdown that counts as a regression (default: 10)\n");
+}
+
+//-----------------------------------------------------------------------------------------------
+bool ParseArguments(int argc, char* argv[], MapBenchmarkOptions& out_options)
+{
+	for (int argIndex = 1; argIndex < argc; argIndex++)
+	{
+		std::string argument = argv[argIndex];
+		size_t equalsIndex = argument.find('=');
+		if (argument.empty() || argument[0] != '-' || equalsIndex == std::string::npos)
+			return false;
+
+		std::string key = argument.substr(1, equalsIndex - 1);
+		std::string value = argument.substr(equalsIndex + 1);
+
+		if (key == "maps")
+			out_options.m_mapNames = Split(value, ',');
+		else if (key == "sizes")
+		{
+			for (const std::string& size : Split(value, ','))
+			{
+				if (size == "native")
+				{
+					out_options.m_dimensions.push_back(IntVector2(0, 0));
+					continue;
+				}
+
+				IntVector2 dimensions;
+				if (sscanf(size.c_str(), "%dx%d", &dimensions.x, &dimensions.y) != 2 || dimensions.x <= 0 || dimensions.y <= 0)
+					return false;
+				out_options.m_dimensions.push_back(dimensions);
+			}
+		}
+		else if (key == "seeds")
+			out_options.m_numSeeds = atoi(value.c_str());
+		else if (key == "baseSeed")
+			out_options.m_baseSeed = (unsigned int)strtoul(value.c_str(), nullptr, 10);
+		else if (key == "neighborReps")
+			out_options.m_numNeighborRepetitions = atoi(value.c_str());
+		else if (key == "out")
+			out_options.m_outputPath = value;
+		else if (key == "baseline")
+			out_options.m_baselinePath = value;
+		else if (key == "threshold")
+			out_options.m_regressionThreshold = (float)atof(value.c_str()) * 0.01f;
+		else
+			return false;
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	MapBenchmarkOptions options;
+	if (!ParseArguments(argc, argv, options))
+	{
+		PrintUsage();
+		return 2;
+	}
+
+	g_theConfig = new ConfigSystem();
+	g_theConfig->Initialize("Roguelike.config");
+
+	//Only the definition loading is needed; nothing here touches the renderer or the world
+	GameplayDefinitions::LoadAll();
+
+	MapBenchmark benchmark(options);
+	benchmark.Run();
+
+	std::string csvPath = options.m_outputPath + ".csv";
+	std::string jsonPath = options.m_outputPath + ".json";
+	if (!benchmark.WriteCSV(csvPath) || !benchmark.WriteJSON(jsonPath))
+		printf("Failed to write results to %s\n", options.m_outputPath.c_str());
+	else
+		printf("Wrote %s and %s\n", csvPath.c_str(), jsonPath.c_str());
+
+	int numRegressions = 0;
+	if (!options.m_baselinePath.empty())
+		numRegressions = benchmark.CompareAgainstBaseline(options.m_baselinePath);
+
+	delete g_theConfig;
+	g_theConfig = nullptr;
+
+	return numRegressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,364 @@
+#include "MapBenchmark/MapBenchmark.hpp"
+#include "Game/MemoryTracking.hpp"
+#include "Game/Map.hpp"
+#include "Game/MapDefinition.hpp"
+#include "Game/MapGenerator.hpp"
+#include "Game/RandomStream.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include <fstream>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+const std::string MapBenchmark::CONSTRUCTION_STEP_NAME = "(construct)";
+
+static const IntVector2 NEIGHBOR_DIRECTIONS[NUM_TILE_NEIGHBORS] =
+{
+	IntVector2(0, 1),
+	IntVector2(0, -1),
+	IntVector2(1, 0),
+	IntVector2(-1, 0),
+	IntVector2(1, 1),
+	IntVector2(-1, 1),
+	IntVector2(1, -1),
+	IntVector2(-1, -1),
+};
+
+//CSV columns are split on commas, so names must not contain any
+static std::string MakeCSVSafe(const std::string& text)
+{
+	std::string safeText = text;
+	for (char& character : safeText)
+	{
+		if (character == ',' || character == '\n' || character == '\r')
+			character = ' ';
+	}
+	return safeText;
+}
+
+static std::string MakeJSONString(const std::string& text)
+{
+	std::string jsonString = "\"";
+	for (char character : text)
+	{
+		if (character == '"' || character == '\\')
+			jsonString += '\\';
+		if ((unsigned char)character < 0x20)
+			continue;
+		jsonString += character;
+	}
+	return jsonString + "\"";
+}
+
+
+std::string GeneratorBenchmarkResult::GetKey() const
+{
+	return m_mapName + "/" + std::to_string(m_generatorIndex) + ":" + m_generatorName + "@" + std::to_string(m_dimensions.x) + "x" + std::to_string(m_dimensions.y);
+}
+
+
+MapBenchmark::MapBenchmark(const MapBenchmarkOptions& options)
+	: m_options(options)
+{
+	if (m_options.m_dimensions.empty())
+		m_options.m_dimensions.push_back(IntVector2(0, 0));
+	if (m_options.m_numSeeds < 1)
+		m_options.m_numSeeds = 1;
+}
+
+void MapBenchmark::Run()
+{
+	std::vector<MapDefinition*> definitionsToRun;
+	if (m_options.m_mapNames.empty())
+	{
+		for (std::map<std::string, MapDefinition*>::iterator definitionIter = MapDefinition::s_registry.begin(); definitionIter != MapDefinition::s_registry.end(); ++definitionIter)
+		{
+			definitionsToRun.push_back(definitionIter->second);
+		}
+	}
+	else
+	{
+		for (const std::string& mapName : m_options.m_mapNames)
+		{
+			MapDefinition* definition = MapDefinition::GetDefinition(mapName);
+			if (definition)
+				definitionsToRun.push_back(definition);
+			else
+				printf("Skipping unknown map definition %s\n", mapName.c_str());
+		}
+	}
+
+	for (MapDefinition* definition : definitionsToRun)
+	{
+		for (const IntVector2& requestedDimensions : m_options.m_dimensions)
+		{
+			IntVector2 dimensions = requestedDimensions;
+			if (dimensions == IntVector2(0, 0))
+				dimensions = definition->m_dimensions;
+
+			printf("Benchmarking %s at %dx%d over %d seeds\n", definition->m_name.c_str(), dimensions.x, dimensions.y, m_options.m_numSeeds);
+			BenchmarkDefinition(definition, dimensions);
+			BenchmarkNeighborAccess(definition, dimensions);
+		}
+	}
+
+	m_processPeakResidentBytes = GetProcessPeakResidentBytes();
+}
+
+bool MapBenchmark::WriteCSV(const std::string& filePath) const
+{
+	std::ofstream csvFile(filePath.c_str(), std::ios::trunc);
+	if (!csvFile.is_open())
+		return false;
+
+	csvFile << "map,generator_index,generator,width,height,samples,mean_ms,min_ms,max_ms,mean_allocations,mean_bytes_allocated,peak_bytes\n";
+	for (const GeneratorBenchmarkResult& result : m_results)
+	{
+		char line[512];
+		snprintf(line, sizeof(line), "%s,%d,%s,%d,%d,%d,%.4f,%.4f,%.4f,%.1f,%.1f,%llu\n", MakeCSVSafe(result.m_mapName).c_str(), result.m_generatorIndex, MakeCSVSafe(result.m_generatorName).c_str(),
+			result.m_dimensions.x, result.m_dimensions.y, result.m_numSamples, result.GetMeanMilliseconds(), result.m_minMilliseconds, result.m_maxMilliseconds,
+			result.GetMeanAllocations(), result.GetMeanBytesAllocated(), result.m_peakBytes);
+		csvFile << line;
+	}
+
+	return !csvFile.fail();
+}
+
+bool MapBenchmark::WriteJSON(const std::string& filePath) const
+{
+	std::ofstream jsonFile(filePath.c_str(), std::ios::trunc);
+	if (!jsonFile.is_open())
+		return false;
+
+	jsonFile << "{\n";
+	jsonFile << "\t\"numSeeds\": " << m_options.m_numSeeds << ",\n";
+	jsonFile << "\t\"baseSeed\": " << m_options.m_baseSeed << ",\n";
+	jsonFile << "\t\"processPeakResidentBytes\": " << m_processPeakResidentBytes << ",\n";
+
+	jsonFile << "\t\"generators\": [\n";
+	for (size_t resultIndex = 0; resultIndex < m_results.size(); resultIndex++)
+	{
+		const GeneratorBenchmarkResult& result = m_results[resultIndex];
+		char entry[1024];
+		snprintf(entry, sizeof(entry), "\t\t{ \"map\": %s, \"generatorIndex\": %d, \"generator\": %s, \"width\": %d, \"height\": %d, \"samples\": %d, "
+			"\"meanMilliseconds\": %.4f, \"minMilliseconds\": %.4f, \"maxMilliseconds\": %.4f, \"meanAllocations\": %.1f, \"meanBytesAllocated\": %.1f, \"peakBytes\": %llu }%s\n",
+			MakeJSONString(result.m_mapName).c_str(), result.m_generatorIndex, MakeJSONString(result.m_generatorName).c_str(), result.m_dimensions.x, result.m_dimensions.y, result.m_numSamples,
+			result.GetMeanMilliseconds(), result.m_minMilliseconds, result.m_maxMilliseconds, result.GetMeanAllocations(), result.GetMeanBytesAllocated(), result.m_peakBytes,
+			(resultIndex + 1 < m_results.size()) ? "," : "");
+		jsonFile << entry;
+	}
+	jsonFile << "\t],\n";
+
+	jsonFile << "\t\"neighborAccess\": [\n";
+	for (size_t resultIndex = 0; resultIndex < m_neighborResults.size(); resultIndex++)
+	{
+		const NeighborAccessBenchmarkResult& result = m_neighborResults[resultIndex];
+		char entry[512];
+		snprintf(entry, sizeof(entry), "\t\t{ \"map\": %s, \"width\": %d, \"height\": %d, \"coordinateLookupNanosecondsPerTile\": %.3f, \"strideOffsetNanosecondsPerTile\": %.3f }%s\n",
+			MakeJSONString(result.m_mapName).c_str(), result.m_dimensions.x, result.m_dimensions.y, result.m_coordinateLookupNanosecondsPerTile, result.m_strideOffsetNanosecondsPerTile,
+			(resultIndex + 1 < m_neighborResults.size()) ? "," : "");
+		jsonFile << entry;
+	}
+	jsonFile << "\t]\n";
+	jsonFile << "}\n";
+
+	return !jsonFile.fail();
+}
+
+int MapBenchmark::CompareAgainstBaseline(const std::string& baselineCSVPath) const
+{
+	std::ifstream baselineFile(baselineCSVPath.c_str());
+	if (!baselineFile.is_open())
+	{
+		printf("Could not open baseline %s\n", baselineCSVPath.c_str());
+		return 0;
+	}
+
+	//Keyed the same way as GeneratorBenchmarkResult::GetKey
+	std::map<std::string, double> baselineMeanMilliseconds;
+	std::string line;
+	std::getline(baselineFile, line);
+	while (std::getline(baselineFile, line))
+	{
+		std::vector<std::string> columns = Split(line, ',');
+		if (columns.size() < 7)
+			continue;
+
+		std::string key = columns[0] + "/" + columns[1] + ":" + columns[2] + "@" + columns[3] + "x" + columns[4];
+		baselineMeanMilliseconds[key] = atof(columns[6].c_str());
+	}
+
+	//Sub-0.05ms steps are mostly timer noise, so they never count as regressions on their own
+	const double minimumMillisecondsDifference = 0.05;
+	int numRegressions = 0;
+	printf("\n%-60s %12s %12s %9s\n", "step", "baseline ms", "current ms", "change");
+	for (const GeneratorBenchmarkResult& result : m_results)
+	{
+		std::map<std::string, double>::const_iterator found = baselineMeanMilliseconds.find(result.GetKey());
+		if (found == baselineMeanMilliseconds.end())
+		{
+			printf("%-60s %12s %12.3f %9s\n", result.GetKey().c_str(), "-", result.GetMeanMilliseconds(), "new");
+			continue;
+		}
+
+		double baselineMilliseconds = found->second;
+		double currentMilliseconds = result.GetMeanMilliseconds();
+		double fractionChange = baselineMilliseconds > 0.0 ? (currentMilliseconds - baselineMilliseconds) / baselineMilliseconds : 0.0;
+		bool isRegression = fractionChange > m_options.m_regressionThreshold && (currentMilliseconds - baselineMilliseconds) > minimumMillisecondsDifference;
+		if (isRegression)
+			numRegressions++;
+
+		printf("%-60s %12.3f %12.3f %+8.1f%%%s\n", result.GetKey().c_str(), baselineMilliseconds, currentMilliseconds, fractionChange * 100.0, isRegression ? "  REGRESSION" : "");
+	}
+
+	printf("\n%d regression(s) beyond %.0f%% against %s\n", numRegressions, m_options.m_regressionThreshold * 100.f, baselineCSVPath.c_str());
+	return numRegressions;
+}
+
+//Maps size themselves from their definition, so the sweep temporarily resizes the definition itself
+void MapBenchmark::BenchmarkDefinition(MapDefinition* definition, const IntVector2& dimensions)
+{
+	IntVector2 definitionDimensions = definition->m_dimensions;
+	definition->m_dimensions = dimensions;
+
+	for (int seedIndex = 0; seedIndex < m_options.m_numSeeds; seedIndex++)
+	{
+		unsigned int seed = RandomStream::DeriveSeed(m_options.m_baseSeed, seedIndex);
+
+		ResetPeakLiveBytes();
+		MemorySnapshot memoryBefore = GetMemorySnapshot();
+		double startSeconds = GetCurrentTimeSeconds();
+		Map* benchmarkMap = new Map(definition->m_name, seed);
+		double elapsedSeconds = GetCurrentTimeSeconds() - startSeconds;
+		RecordSample(GetResult(definition->m_name, CONSTRUCTION_STEP_NAME, -1, dimensions), elapsedSeconds, memoryBefore, GetMemorySnapshot());
+
+		//Same per-generator seeding as MapDefinition::GenerateMap, so each step sees exactly what it would in game
+		for (size_t generatorIndex = 0; generatorIndex < definition->m_generators.size(); generatorIndex++)
+		{
+			MapGenerator* generator = definition->m_generators[generatorIndex];
+			RandomStream generatorRandom(definition->GetGeneratorSeed(benchmarkMap, (unsigned int)generatorIndex));
+
+			ResetPeakLiveBytes();
+			memoryBefore = GetMemorySnapshot();
+			startSeconds = GetCurrentTimeSeconds();
+			generator->GenerateMap(benchmarkMap, generatorRandom);
+			elapsedSeconds = GetCurrentTimeSeconds() - startSeconds;
+			RecordSample(GetResult(definition->m_name, generator->m_name, (int)generatorIndex, dimensions), elapsedSeconds, memoryBefore, GetMemorySnapshot());
+		}
+
+		delete benchmarkMap;
+	}
+
+	definition->m_dimensions = definitionDimensions;
+}
+
+//Compares the bounds-checked coordinate lookups maps used before the sentinel border against the stride offsets used now
+void MapBenchmark::BenchmarkNeighborAccess(MapDefinition* definition, const IntVector2& dimensions)
+{
+	IntVector2 definitionDimensions = definition->m_dimensions;
+	definition->m_dimensions = dimensions;
+
+	Map* benchmarkMap = new Map(definition->m_name, m_options.m_baseSeed);
+	definition->GenerateMap(benchmarkMap);
+
+	int numTiles = dimensions.x * dimensions.y;
+	int numRepetitions = m_options.m_numNeighborRepetitions > 0 ? m_options.m_numNeighborRepetitions : 1;
+
+	unsigned long long coordinateMatches = 0;
+	double startSeconds = GetCurrentTimeSeconds();
+	for (int repetitionIndex = 0; repetitionIndex < numRepetitions; repetitionIndex++)
+	{
+		for (int yIndex = 0; yIndex < dimensions.y; yIndex++)
+		{
+			for (int xIndex = 0; xIndex < dimensions.x; xIndex++)
+			{
+				IntVector2 tileCoords(xIndex, yIndex);
+				const Tile* centerTile = benchmarkMap->GetTileAtTileCoords(tileCoords);
+				for (int neighborIndex = 0; neighborIndex < NUM_TILE_NEIGHBORS; neighborIndex++)
+				{
+					const Tile* neighborTile = benchmarkMap->GetTileAtTileCoords(tileCoords + NEIGHBOR_DIRECTIONS[neighborIndex]);
+					if (neighborTile && neighborTile->m_tileDefinition == centerTile->m_tileDefinition)
+						coordinateMatches++;
+				}
+			}
+		}
+	}
+	double coordinateSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	unsigned long long strideMatches = 0;
+	startSeconds = GetCurrentTimeSeconds();
+	for (int repetitionIndex = 0; repetitionIndex < numRepetitions; repetitionIndex++)
+	{
+		for (int yIndex = 0; yIndex < dimensions.y; yIndex++)
+		{
+			int tileIndex = ((yIndex + 1) * benchmarkMap->m_tileStride) + 1;
+			for (int xIndex = 0; xIndex < dimensions.x; xIndex++, tileIndex++)
+			{
+				const Tile* centerTile = &benchmarkMap->m_tiles[tileIndex];
+				for (int neighborIndex = 0; neighborIndex < NUM_TILE_NEIGHBORS; neighborIndex++)
+				{
+					if (centerTile[benchmarkMap->m_neighborOffsets[neighborIndex]].m_tileDefinition == centerTile->m_tileDefinition)
+						strideMatches++;
+				}
+			}
+		}
+	}
+	double strideSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	if (coordinateMatches != strideMatches)
+		printf("Neighbor access mismatch on %s: %llu coordinate matches, %llu stride matches\n", definition->m_name.c_str(), coordinateMatches, strideMatches);
+
+	NeighborAccessBenchmarkResult result;
+	result.m_mapName = definition->m_name;
+	result.m_dimensions = dimensions;
+	double numTileVisits = (double)numTiles * (double)numRepetitions;
+	if (numTileVisits > 0.0)
+	{
+		result.m_coordinateLookupNanosecondsPerTile = (coordinateSeconds * 1000000000.0) / numTileVisits;
+		result.m_strideOffsetNanosecondsPerTile = (strideSeconds * 1000000000.0) / numTileVisits;
+	}
+	m_neighborResults.push_back(result);
+
+	delete benchmarkMap;
+	definition->m_dimensions = definitionDimensions;
+}
+
+void MapBenchmark::RecordSample(GeneratorBenchmarkResult& out_result, double elapsedSeconds, const MemorySnapshot& memoryBefore, const MemorySnapshot& memoryAfter)
+{
+	double elapsedMilliseconds = elapsedSeconds * 1000.0;
+	if (out_result.m_numSamples == 0 || elapsedMilliseconds < out_result.m_minMilliseconds)
+		out_result.m_minMilliseconds = elapsedMilliseconds;
+	if (out_result.m_numSamples == 0 || elapsedMilliseconds > out_result.m_maxMilliseconds)
+		out_result.m_maxMilliseconds = elapsedMilliseconds;
+
+	out_result.m_numSamples++;
+	out_result.m_totalMilliseconds += elapsedMilliseconds;
+	out_result.m_totalAllocations += memoryAfter.m_numAllocations - memoryBefore.m_numAllocations;
+	out_result.m_totalBytesAllocated += memoryAfter.m_totalBytesAllocated - memoryBefore.m_totalBytesAllocated;
+
+	//Peak is measured above whatever was already live when the step started
+	unsigned long long peakBytes = 0;
+	if (memoryAfter.m_peakLiveBytes > memoryBefore.m_liveBytes)
+		peakBytes = memoryAfter.m_peakLiveBytes - memoryBefore.m_liveBytes;
+	if (peakBytes > out_result.m_peakBytes)
+		out_result.m_peakBytes = peakBytes;
+}
+
+GeneratorBenchmarkResult& MapBenchmark::GetResult(const std::string& mapName, const std::string& generatorName, int generatorIndex, const IntVector2& dimensions)
+{
+	GeneratorBenchmarkResult newResult;
+	newResult.m_mapName = MakeCSVSafe(mapName);
+	newResult.m_generatorName = MakeCSVSafe(generatorName);
+	newResult.m_generatorIndex = generatorIndex;
+	newResult.m_dimensions = dimensions;
+
+	std::string key = newResult.GetKey();
+	std::map<std::string, size_t>::iterator found = m_resultIndicesByKey.find(key);
+	if (found != m_resultIndicesByKey.end())
+		return m_results[found->second];
+
+	m_resultIndicesByKey[key] = m_results.size();
+	m_results.push_back(newResult);
+	return m_results.back();
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include "Engine/Math/IntVector2.hpp"
+#include "Game/MemoryTracking.hpp"
+
+
+class MapDefinition;
+
+struct MapBenchmarkOptions
+{
+	std::vector<std::string> m_mapNames;				//Empty runs every MapDefinition
+	std::vector<IntVector2> m_dimensions;				//(0,0) means the definition's own dimensions
+	int m_numSeeds = 5;
+	unsigned int m_baseSeed = 1;
+	int m_numNeighborRepetitions = 50;
+	std::string m_outputPath = "MapBenchmark";
+	std::string m_baselinePath;
+	float m_regressionThreshold = 0.1f;
+};
+
+//One generator step of one map at one size, averaged over every seed in the sweep
+struct GeneratorBenchmarkResult
+{
+	std::string m_mapName;
+	std::string m_generatorName;
+	int m_generatorIndex;
+	IntVector2 m_dimensions;
+	int m_numSamples = 0;
+	double m_totalMilliseconds = 0.0;
+	double m_minMilliseconds = 0.0;
+	double m_maxMilliseconds = 0.0;
+	unsigned long long m_totalAllocations = 0;
+	unsigned long long m_totalBytesAllocated = 0;
+	unsigned long long m_peakBytes = 0;
+
+	std::string GetKey() const;
+	double GetMeanMilliseconds() const { return m_numSamples > 0 ? m_totalMilliseconds / m_numSamples : 0.0; }
+	double GetMeanAllocations() const { return m_numSamples > 0 ? (double)m_totalAllocations / m_numSamples : 0.0; }
+	double GetMeanBytesAllocated() const { return m_numSamples > 0 ? (double)m_totalBytesAllocated / m_numSamples : 0.0; }
+};
+
+struct NeighborAccessBenchmarkResult
+{
+	std::string m_mapName;
+	IntVector2 m_dimensions;
+	double m_coordinateLookupNanosecondsPerTile = 0.0;
+	double m_strideOffsetNanosecondsPerTile = 0.0;
+};
+
+//Headless timing of every MapDefinition's generator stack across a sweep of map sizes and seeds
+class MapBenchmark
+{
+public:
+	MapBenchmark(const MapBenchmarkOptions& options);
+
+	void Run();
+	bool WriteCSV(const std::string& filePath) const;
+	bool WriteJSON(const std::string& filePath) const;
+
+	//Returns the number of results whose mean time grew past the regression threshold
+	int CompareAgainstBaseline(const std::string& baselineCSVPath) const;
+
+	static const std::string CONSTRUCTION_STEP_NAME;
+
+private:
+	void BenchmarkDefinition(MapDefinition* definition, const IntVector2& dimensions);
+	void BenchmarkNeighborAccess(MapDefinition* definition, const IntVector2& dimensions);
+	static void RecordSample(GeneratorBenchmarkResult& out_result, double elapsedSeconds, const MemorySnapshot& memoryBefore, const MemorySnapshot& memoryAfter);
+	GeneratorBenchmarkResult& GetResult(const std::string& mapName, const std::string& generatorName, int generatorIndex, const IntVector2& dimensions);
+
+	MapBenchmarkOptions m_options;
+	std::vector<GeneratorBenchmarkResult> m_results;
+	std::map<std::string, size_t> m_resultIndicesByKey;
+	std::vector<NeighborAccessBenchmarkResult> m_neighborResults;
+	unsigned long long m_processPeakResidentBytes = 0;
+};